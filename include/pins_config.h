@@ -15,6 +15,11 @@
 #define I2C_SDA I2C_SDA_EXT
 #define I2C_SCL I2C_SCL_EXT
 
+// Optional INA226 ALERT line (open-drain, active low). Wire it to a free GPIO
+// and set the pin here to sample on conversion-ready interrupts; -1 keeps the
+// timer-driven sampling.
+#define INA226_ALERT_PIN -1
+
 // SPI pins for display (Tab5, per M5Unified mapping)
 #define TFT_SPI_SCLK 43
 #define TFT_SPI_MOSI 44
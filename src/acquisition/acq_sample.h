@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// Flags carried with every acquisition sample.
+enum : uint8_t {
+  ACQ_SAMPLE_POWER_VALID = (1u << 0),  // voltage/current came from a good INA226 read
+  ACQ_SAMPLE_FINE_RANGE = (1u << 1)    // auto-range picked the INA226-1A for this sample
+};
+
+// One timestamped reading produced by the acquisition task.
+typedef struct {
+  uint32_t sequence;
+  uint64_t timestamp_us;  // esp_timer time the INA226 read started
+  float voltage_v;
+  float current_a;
+  uint8_t flags;
+  uint8_t channel;        // monitor channel; only the INA3221 produces more than channel 0
+  uint8_t profile_step;   // load-profile step active at the read; 0xFF when no profile is playing
+} acq_sample_t;
+
+// Latest thermocouple reading. The thermocouple runs on its own, slower
+// schedule, so consumers judge freshness from the timestamp.
+typedef struct {
+  float temp_c;           // NAN when there is no thermocouple
+  uint64_t timestamp_us;  // esp_timer time of the reading
+} acq_temp_reading_t;
+
+// INA228 on-chip accumulator totals since the start of the test.
+typedef struct {
+  double energy_wh;
+  double charge_ah;
+  uint32_t overflows;     // 40-bit register wraps folded in so far
+  uint64_t timestamp_us;  // esp_timer time of the read; 0 when none yet
+} acq_energy_totals_t;
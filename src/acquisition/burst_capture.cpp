@@ -0,0 +1,66 @@
+#include "burst_capture.h"
+
+void BurstCapture::attach(uint32_t *offsetsUs, float *voltageV, float *currentA, uint32_t capacity)
+{
+  bool valid = offsetsUs != nullptr && voltageV != nullptr && currentA != nullptr;
+  offsetsUs_ = offsetsUs;
+  voltageV_ = voltageV;
+  currentA_ = currentA;
+  capacity_ = valid ? capacity : 0;
+  state_ = State::Idle;
+  count_ = 0;
+}
+
+void BurstCapture::arm(uint32_t windowUs)
+{
+  if (capacity_ == 0) {
+    return;
+  }
+
+  state_ = State::Capturing;
+  windowUs_ = windowUs;
+  startUs_ = 0;
+  count_ = 0;
+  summary_ = {};
+}
+
+bool BurstCapture::add(uint64_t timestampUs, float voltageV, float currentA)
+{
+  if (state_ != State::Capturing) {
+    return false;
+  }
+
+  if (count_ == 0) {
+    startUs_ = timestampUs;
+  }
+
+  uint32_t offsetUs = (uint32_t)(timestampUs - startUs_);
+  if (offsetUs > windowUs_) {
+    complete();
+    return false;
+  }
+
+  offsetsUs_[count_] = offsetUs;
+  voltageV_[count_] = voltageV;
+  currentA_[count_] = currentA;
+  count_++;
+
+  if (count_ >= capacity_) {
+    complete();
+    return false;
+  }
+  return true;
+}
+
+void BurstCapture::finish()
+{
+  if (state_ == State::Capturing) {
+    complete();
+  }
+}
+
+void BurstCapture::complete()
+{
+  state_ = State::Complete;
+  summary_ = summarizeCapture(offsetsUs_, voltageV_, currentA_, count_);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "capture_summary.h"
+
+// Fixed-window, as-fast-as-possible capture into caller-provided buffers
+// (PSRAM on the device). Samples are stored structure-of-arrays so the UI
+// can chart voltage and current directly.
+class BurstCapture {
+public:
+  enum class State : uint8_t {
+    Idle,
+    Capturing,
+    Complete
+  };
+
+  void attach(uint32_t *offsetsUs, float *voltageV, float *currentA, uint32_t capacity);
+  bool attached() const { return capacity_ > 0; }
+  uint32_t capacity() const { return capacity_; }
+
+  // Start a new window; the first add() defines t = 0.
+  void arm(uint32_t windowUs);
+
+  // Store one sample. Returns false once the window has elapsed or the
+  // buffer is full (the capture is then Complete).
+  bool add(uint64_t timestampUs, float voltageV, float currentA);
+
+  // End the capture early (e.g. on a bus error).
+  void finish();
+
+  State state() const { return state_; }
+  bool capturing() const { return state_ == State::Capturing; }
+  uint32_t count() const { return count_; }
+  const uint32_t *offsetsUs() const { return offsetsUs_; }
+  const float *voltageV() const { return voltageV_; }
+  const float *currentA() const { return currentA_; }
+  const capture_summary_t &summary() const { return summary_; }
+
+private:
+  void complete();
+
+  uint32_t *offsetsUs_ = nullptr;
+  float *voltageV_ = nullptr;
+  float *currentA_ = nullptr;
+  uint32_t capacity_ = 0;
+
+  State state_ = State::Idle;
+  uint32_t windowUs_ = 0;
+  uint64_t startUs_ = 0;
+  uint32_t count_ = 0;
+  capture_summary_t summary_ = {};
+};
@@ -0,0 +1,99 @@
+#include "capacity_evaluator.h"
+
+#include <math.h>
+
+CapacityEvaluator::CapacityEvaluator(float passFraction, float stepFraction)
+    : passFraction_(passFraction), stepFraction_(stepFraction)
+{
+}
+
+void CapacityEvaluator::reset()
+{
+  verdict_ = CapacityVerdict::Idle;
+  deliveredAh_ = 0.0;
+  deliveredWh_ = 0.0;
+  stepStartAh_ = 0.0;
+  stepVoltageSum_ = 0.0;
+  stepSamples_ = 0;
+  hasPrevious_ = false;
+  hasSlope_ = false;
+}
+
+void CapacityEvaluator::start(float ratedAh, float cutoffV)
+{
+  reset();
+  ratedAh_ = ratedAh;
+  cutoffV_ = cutoffV;
+  verdict_ = CapacityVerdict::Running;
+}
+
+void CapacityEvaluator::update(double chargeAh, double energyWh, float voltageV)
+{
+  if (verdict_ != CapacityVerdict::Running) {
+    return;
+  }
+
+  deliveredAh_ = chargeAh;
+  deliveredWh_ = energyWh;
+
+  stepVoltageSum_ += (double)voltageV;
+  stepSamples_++;
+
+  double stepAh = (double)ratedAh_ * (double)stepFraction_;
+  if (stepAh <= 0.0 || chargeAh - stepStartAh_ < stepAh) {
+    return;
+  }
+
+  // Step complete: compare its mean voltage with the previous step's
+  double midAh = 0.5 * (stepStartAh_ + chargeAh);
+  double meanV = stepVoltageSum_ / (double)stepSamples_;
+  if (hasPrevious_ && midAh > previousMidAh_) {
+    slopeVPerAh_ = (meanV - previousMeanV_) / (midAh - previousMidAh_);
+    anchorAh_ = midAh;
+    anchorV_ = meanV;
+    hasSlope_ = true;
+  }
+  hasPrevious_ = true;
+  previousMidAh_ = midAh;
+  previousMeanV_ = meanV;
+
+  stepStartAh_ = chargeAh;
+  stepVoltageSum_ = 0.0;
+  stepSamples_ = 0;
+}
+
+void CapacityEvaluator::finish(bool cutoffReached)
+{
+  if (verdict_ != CapacityVerdict::Running) {
+    return;
+  }
+  if (!cutoffReached) {
+    verdict_ = CapacityVerdict::Incomplete;
+  } else if (deliveredAh_ >= (double)ratedAh_ * (double)passFraction_) {
+    verdict_ = CapacityVerdict::Pass;
+  } else {
+    verdict_ = CapacityVerdict::Fail;
+  }
+}
+
+float CapacityEvaluator::ratedPercent() const
+{
+  if (ratedAh_ <= 0.0f) {
+    return NAN;
+  }
+  return (float)(deliveredAh_ / (double)ratedAh_ * 100.0);
+}
+
+float CapacityEvaluator::projectedAh() const
+{
+  if (verdict_ != CapacityVerdict::Running) {
+    return (float)deliveredAh_;
+  }
+  if (!hasSlope_ || slopeVPerAh_ >= 0.0) {
+    return NAN;
+  }
+
+  double remainingAh = (anchorV_ - (double)cutoffV_) / -slopeVPerAh_;
+  double projected = anchorAh_ + (remainingAh > 0.0 ? remainingAh : 0.0);
+  return (float)(projected > deliveredAh_ ? projected : deliveredAh_);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class CapacityVerdict : uint8_t {
+  Idle,        // no test since the last reset
+  Running,
+  Pass,        // reached cutoff having delivered at least the pass fraction
+  Fail,        // reached cutoff short of it
+  Incomplete   // stopped (by the user or overtemp) before cutoff
+};
+
+// Grades a discharge against the battery's rated capacity. Fed the running
+// totals once per sample, so it costs the same on hour forty as on second
+// one: no history is kept beyond the last two voltage checkpoints.
+//
+// The live projection extrapolates the voltage sag to the cutoff voltage.
+// Every stepFraction of rated capacity the mean voltage over that step is
+// compared with the previous step's, and the resulting slope (V per Ah) is
+// extended to cutoff. It runs high while the curve is flat and settles as
+// the knee approaches, so it is a guide, not part of the verdict.
+class CapacityEvaluator {
+public:
+  CapacityEvaluator(float passFraction, float stepFraction);
+
+  void reset();
+  void start(float ratedAh, float cutoffV);
+  void update(double chargeAh, double energyWh, float voltageV);
+  void finish(bool cutoffReached);
+
+  CapacityVerdict verdict() const { return verdict_; }
+  double deliveredAh() const { return deliveredAh_; }
+  double deliveredWh() const { return deliveredWh_; }
+  float ratedAh() const { return ratedAh_; }
+  float ratedPercent() const;
+  // NAN until two full steps have been seen with the voltage falling.
+  float projectedAh() const;
+
+private:
+  float passFraction_;
+  float stepFraction_;
+  CapacityVerdict verdict_ = CapacityVerdict::Idle;
+  float ratedAh_ = 0.0f;
+  float cutoffV_ = 0.0f;
+  double deliveredAh_ = 0.0;
+  double deliveredWh_ = 0.0;
+
+  // Current step: mean voltage accumulated over charge [stepStartAh_, +stepAh)
+  double stepStartAh_ = 0.0;
+  double stepVoltageSum_ = 0.0;
+  uint32_t stepSamples_ = 0;
+  // Previous completed step
+  bool hasPrevious_ = false;
+  double previousMidAh_ = 0.0;
+  double previousMeanV_ = 0.0;
+  // Latest slope estimate, anchored at the last completed step
+  bool hasSlope_ = false;
+  double slopeVPerAh_ = 0.0;
+  double anchorAh_ = 0.0;
+  double anchorV_ = 0.0;
+};
@@ -0,0 +1,47 @@
+#include "capture_summary.h"
+
+capture_summary_t summarizeCapture(const uint32_t *offsetsUs, const float *voltageV, const float *currentA, uint32_t count)
+{
+  capture_summary_t summary = {};
+  summary.sample_count = count;
+  if (count == 0) {
+    return summary;
+  }
+
+  summary.voltage_min_v = voltageV[0];
+  summary.voltage_max_v = voltageV[0];
+  summary.current_min_a = currentA[0];
+  summary.current_max_a = currentA[0];
+  summary.peak_power_w = voltageV[0] * currentA[0];
+
+  double voltageSum = 0.0;
+  double currentSum = 0.0;
+  for (uint32_t i = 0; i < count; i++) {
+    float voltage = voltageV[i];
+    float current = currentA[i];
+    float power = voltage * current;
+    if (voltage < summary.voltage_min_v) {
+      summary.voltage_min_v = voltage;
+    }
+    if (voltage > summary.voltage_max_v) {
+      summary.voltage_max_v = voltage;
+    }
+    if (current < summary.current_min_a) {
+      summary.current_min_a = current;
+    }
+    if (current > summary.current_max_a) {
+      summary.current_max_a = current;
+    }
+    if (power > summary.peak_power_w) {
+      summary.peak_power_w = power;
+    }
+    voltageSum += voltage;
+    currentSum += current;
+  }
+
+  summary.duration_us = offsetsUs[count - 1] - offsetsUs[0];
+  summary.mean_period_us = (count > 1) ? (float)summary.duration_us / (float)(count - 1) : 0.0f;
+  summary.voltage_mean_v = (float)(voltageSum / count);
+  summary.current_mean_a = (float)(currentSum / count);
+  return summary;
+}
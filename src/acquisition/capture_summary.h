@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t sample_count;
+  uint32_t duration_us;
+  float mean_period_us;
+  float voltage_min_v;
+  float voltage_max_v;
+  float voltage_mean_v;
+  float current_min_a;
+  float current_max_a;
+  float current_mean_a;
+  float peak_power_w;
+} capture_summary_t;
+
+// Statistics over a finished capture held as parallel arrays, offsets in
+// microseconds from the first sample.
+capture_summary_t summarizeCapture(const uint32_t *offsetsUs, const float *voltageV, const float *currentA, uint32_t count);
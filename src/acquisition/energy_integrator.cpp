@@ -0,0 +1,41 @@
+#include "energy_integrator.h"
+
+static constexpr double US_PER_HOUR = 3600000000.0;
+
+void EnergyIntegrator::reset()
+{
+  energyWh_.reset();
+  chargeAh_.reset();
+  lastUs_ = 0;
+  hasLast_ = false;
+  lastValid_ = false;
+  lastPowerW_ = 0.0;
+  lastCurrentA_ = 0.0;
+}
+
+void EnergyIntegrator::add(uint64_t timestampUs, float voltageV, float currentA, bool integrate)
+{
+  double currentAd = (double)currentA;
+  double powerW = (double)voltageV * currentAd;
+
+  if (integrate && hasLast_ && timestampUs > lastUs_) {
+    double hours = (double)(timestampUs - lastUs_) / US_PER_HOUR;
+    double leftPowerW = lastValid_ ? lastPowerW_ : powerW;
+    double leftCurrentA = lastValid_ ? lastCurrentA_ : currentAd;
+    energyWh_.add(0.5 * (leftPowerW + powerW) * hours);
+    chargeAh_.add(0.5 * (leftCurrentA + currentAd) * hours);
+  }
+
+  lastUs_ = timestampUs;
+  hasLast_ = true;
+  lastValid_ = true;
+  lastPowerW_ = powerW;
+  lastCurrentA_ = currentAd;
+}
+
+void EnergyIntegrator::skip(uint64_t timestampUs)
+{
+  lastUs_ = timestampUs;
+  hasLast_ = true;
+  lastValid_ = false;
+}
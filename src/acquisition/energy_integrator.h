@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+// Double accumulator with Neumaier (improved Kahan) compensation. A multi-day
+// discharge adds millions of increments many orders of magnitude below the
+// running total; the compensation term keeps the bits a plain sum drops.
+class CompensatedSum {
+public:
+  void reset()
+  {
+    sum_ = 0.0;
+    compensation_ = 0.0;
+  }
+
+  void add(double value)
+  {
+    double total = sum_ + value;
+    if ((sum_ >= 0.0 ? sum_ : -sum_) >= (value >= 0.0 ? value : -value)) {
+      compensation_ += (sum_ - total) + value;
+    } else {
+      compensation_ += (value - total) + sum_;
+    }
+    sum_ = total;
+  }
+
+  double value() const { return sum_ + compensation_; }
+
+private:
+  double sum_ = 0.0;
+  double compensation_ = 0.0;
+};
+
+// Energy (Wh) and charge (Ah) for one channel, integrated with the
+// trapezoidal rule over the samples' own acquisition timestamps. Current is
+// signed, so charge counts down again while a cell is being charged.
+class EnergyIntegrator {
+public:
+  void reset();
+
+  // A valid reading. The interval since the previous sample is integrated
+  // only when integrate is true; either way the sample becomes the new
+  // left edge, so pausing the test never bridges the pause.
+  void add(uint64_t timestampUs, float voltageV, float currentA, bool integrate);
+
+  // An invalid reading: nothing is known about the level, so the next valid
+  // sample integrates its interval as a rectangle on its own value.
+  void skip(uint64_t timestampUs);
+
+  // Keep the totals but forget the previous sample, e.g. after switching
+  // sensors, so the next interval starts fresh.
+  void restart()
+  {
+    hasLast_ = false;
+    lastValid_ = false;
+  }
+
+  double energyWh() const { return energyWh_.value(); }
+  double chargeAh() const { return chargeAh_.value(); }
+
+private:
+  CompensatedSum energyWh_;
+  CompensatedSum chargeAh_;
+  uint64_t lastUs_ = 0;
+  bool hasLast_ = false;
+  bool lastValid_ = false;
+  double lastPowerW_ = 0.0;
+  double lastCurrentA_ = 0.0;
+};
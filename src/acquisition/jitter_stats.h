@@ -0,0 +1,88 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// Running statistics for the real sampling period, fed with the microsecond
+// timestamp of every sample. Used to prove the configured sample interval is
+// actually met rather than just requested.
+class JitterStats {
+public:
+  void reset(uint32_t nominalPeriodUs)
+  {
+    nominalUs_ = nominalPeriodUs;
+    lastUs_ = 0;
+    hasLast_ = false;
+    periods_ = 0;
+    missedTicks_ = 0;
+    minPeriodUs_ = 0;
+    maxPeriodUs_ = 0;
+    sumPeriodUs_ = 0.0;
+    sumSqErrorUs_ = 0.0;
+    maxAbsErrorUs_ = 0;
+  }
+
+  void record(uint64_t timestampUs)
+  {
+    if (!hasLast_) {
+      lastUs_ = timestampUs;
+      hasLast_ = true;
+      return;
+    }
+
+    uint32_t periodUs = (uint32_t)(timestampUs - lastUs_);
+    lastUs_ = timestampUs;
+
+    if (periods_ == 0 || periodUs < minPeriodUs_) {
+      minPeriodUs_ = periodUs;
+    }
+    if (periodUs > maxPeriodUs_) {
+      maxPeriodUs_ = periodUs;
+    }
+
+    int32_t errorUs = (int32_t)(periodUs - nominalUs_);
+    uint32_t absErrorUs = (uint32_t)(errorUs < 0 ? -errorUs : errorUs);
+    if (absErrorUs > maxAbsErrorUs_) {
+      maxAbsErrorUs_ = absErrorUs;
+    }
+
+    sumPeriodUs_ += (double)periodUs;
+    sumSqErrorUs_ += (double)errorUs * (double)errorUs;
+    periods_++;
+  }
+
+  // Timer ticks that fired while the previous sample was still being read.
+  void recordMissedTicks(uint32_t count)
+  {
+    missedTicks_ += count;
+  }
+
+  uint32_t nominalUs() const { return nominalUs_; }
+  uint32_t periods() const { return periods_; }
+  uint32_t missedTicks() const { return missedTicks_; }
+  uint32_t minPeriodUs() const { return minPeriodUs_; }
+  uint32_t maxPeriodUs() const { return maxPeriodUs_; }
+  uint32_t maxAbsErrorUs() const { return maxAbsErrorUs_; }
+
+  double meanPeriodUs() const
+  {
+    return periods_ == 0 ? 0.0 : sumPeriodUs_ / (double)periods_;
+  }
+
+  double rmsErrorUs() const
+  {
+    return periods_ == 0 ? 0.0 : sqrt(sumSqErrorUs_ / (double)periods_);
+  }
+
+private:
+  uint32_t nominalUs_ = 0;
+  uint64_t lastUs_ = 0;
+  bool hasLast_ = false;
+  uint32_t periods_ = 0;
+  uint32_t missedTicks_ = 0;
+  uint32_t minPeriodUs_ = 0;
+  uint32_t maxPeriodUs_ = 0;
+  double sumPeriodUs_ = 0.0;
+  double sumSqErrorUs_ = 0.0;
+  uint32_t maxAbsErrorUs_ = 0;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Welford running statistics: min, max, mean, RMS and standard deviation in
+// O(1) per value and without storing the values. Unlike the chart history,
+// which is averaged down as a test grows, nothing here loses peaks.
+class RunningStats {
+public:
+  void reset()
+  {
+    count_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+    min_ = 0.0f;
+    max_ = 0.0f;
+  }
+
+  void add(float value)
+  {
+    if (count_ == 0 || value < min_) {
+      min_ = value;
+    }
+    if (count_ == 0 || value > max_) {
+      max_ = value;
+    }
+    count_++;
+    double delta = (double)value - mean_;
+    mean_ += delta / (double)count_;
+    m2_ += delta * ((double)value - mean_);
+  }
+
+  // Chan et al.'s pairwise update, for folding window buckets together.
+  void merge(const RunningStats &other)
+  {
+    if (other.count_ == 0) {
+      return;
+    }
+    if (count_ == 0) {
+      *this = other;
+      return;
+    }
+    double total = (double)count_ + (double)other.count_;
+    double delta = other.mean_ - mean_;
+    mean_ += delta * (double)other.count_ / total;
+    m2_ += other.m2_ + delta * delta * (double)count_ * (double)other.count_ / total;
+    count_ += other.count_;
+    min_ = other.min_ < min_ ? other.min_ : min_;
+    max_ = other.max_ > max_ ? other.max_ : max_;
+  }
+
+  uint32_t count() const { return count_; }
+  float min() const { return count_ == 0 ? NAN : min_; }
+  float max() const { return count_ == 0 ? NAN : max_; }
+  double mean() const { return count_ == 0 ? NAN : mean_; }
+
+  // Population standard deviation; the samples are the whole signal, not a
+  // draw from it.
+  double stddev() const
+  {
+    return count_ == 0 ? NAN : sqrt(m2_ / (double)count_);
+  }
+
+  double rms() const
+  {
+    return count_ == 0 ? NAN : sqrt(mean_ * mean_ + m2_ / (double)count_);
+  }
+
+private:
+  uint32_t count_ = 0;
+  double mean_ = 0.0;
+  double m2_ = 0.0;
+  float min_ = 0.0f;
+  float max_ = 0.0f;
+};
+
+// RunningStats over a sliding time window, kept as a ring of fixed-length
+// buckets. Adding stays O(1); reading merges the buckets, which is cheap at
+// the rate the UI asks. The window edge moves a bucket at a time, so the
+// covered span is between (Buckets - 1) and Buckets bucket lengths.
+template <size_t Buckets, uint32_t BucketUs>
+class WindowedStats {
+  static_assert(Buckets >= 2, "WindowedStats needs at least two buckets");
+  static_assert(BucketUs > 0, "WindowedStats bucket length must be non-zero");
+
+public:
+  void reset()
+  {
+    for (size_t i = 0; i < Buckets; i++) {
+      buckets_[i].reset();
+    }
+    currentBucket_ = 0;
+    hasBucket_ = false;
+  }
+
+  void add(uint64_t timestampUs, float value)
+  {
+    advance(timestampUs / BucketUs);
+    buckets_[currentBucket_ % Buckets].add(value);
+  }
+
+  // The window as of nowUs; buckets that have aged out are skipped.
+  RunningStats summary(uint64_t nowUs) const
+  {
+    RunningStats total;
+    uint64_t nowBucket = nowUs / BucketUs;
+    if (!hasBucket_ || nowBucket >= currentBucket_ + Buckets) {
+      return total;
+    }
+    uint64_t first = (nowBucket >= Buckets - 1) ? nowBucket - (Buckets - 1) : 0;
+    for (uint64_t b = first; b <= currentBucket_; b++) {
+      total.merge(buckets_[b % Buckets]);
+    }
+    return total;
+  }
+
+  static constexpr uint32_t spanMs() { return (uint32_t)(((uint64_t)BucketUs * Buckets) / 1000ULL); }
+
+private:
+  void advance(uint64_t bucket)
+  {
+    if (!hasBucket_) {
+      currentBucket_ = bucket;
+      hasBucket_ = true;
+      buckets_[bucket % Buckets].reset();
+      return;
+    }
+    if (bucket <= currentBucket_) {
+      return;
+    }
+    // Clear every bucket the clock skipped over, at most a full ring
+    uint64_t stale = bucket - currentBucket_;
+    if (stale > Buckets) {
+      stale = Buckets;
+    }
+    for (uint64_t i = 1; i <= stale; i++) {
+      buckets_[(bucket - stale + i) % Buckets].reset();
+    }
+    currentBucket_ = bucket;
+  }
+
+  RunningStats buckets_[Buckets];
+  uint64_t currentBucket_ = 0;
+  bool hasBucket_ = false;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-producer / single-consumer lock-free ring buffer.
+//
+// The producer only ever writes head_ and the consumer only ever writes
+// tail_, so one acquisition task and one UI task can share it without a
+// mutex. Indices run freely and are masked on access, which lets every slot
+// be used and makes "full" simply head - tail == Capacity.
+template <typename T, size_t Capacity>
+class SampleRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SampleRing capacity must be a power of two");
+
+public:
+  // Producer side. Returns false (and counts a drop) when the consumer has
+  // fallen a full ring behind; the oldest data is never overwritten.
+  bool push(const T &item)
+  {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    if ((uint32_t)(head - tail) >= Capacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    slots_[head & (Capacity - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool pop(T *item)
+  {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (tail == head || item == nullptr) {
+      return false;
+    }
+
+    *item = slots_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const
+  {
+    return (size_t)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  uint32_t dropped() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  static constexpr size_t capacity()
+  {
+    return Capacity;
+  }
+
+private:
+  T slots_[Capacity];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
@@ -0,0 +1,115 @@
+#include "trigger_capture.h"
+
+#include <algorithm>
+
+void TriggerCapture::attach(uint32_t *offsetsUs, float *voltageV, float *currentA, uint32_t capacity)
+{
+  bool valid = offsetsUs != nullptr && voltageV != nullptr && currentA != nullptr;
+  offsetsUs_ = offsetsUs;
+  voltageV_ = voltageV;
+  currentA_ = currentA;
+  capacity_ = valid ? capacity : 0;
+  state_ = State::Idle;
+}
+
+bool TriggerCapture::arm(const trigger_config_t &config)
+{
+  uint32_t length = config.pre_samples + config.post_samples;
+  if (config.post_samples == 0 || length > capacity_) {
+    return false;
+  }
+
+  config_ = config;
+  length_ = length;
+  head_ = 0;
+  stored_ = 0;
+  startUs_ = 0;
+  triggered_ = false;
+  triggerSlot_ = 0;
+  postStored_ = 0;
+  summary_ = {};
+  state_ = State::Armed;
+  return true;
+}
+
+bool TriggerCapture::fires(float value) const
+{
+  switch (config_.mode) {
+    case TriggerMode::RisingEdge:
+      return previous_ < config_.level && value >= config_.level;
+    case TriggerMode::FallingEdge:
+      return previous_ > config_.level && value <= config_.level;
+    case TriggerMode::Above:
+      return value >= config_.level;
+    case TriggerMode::Below:
+    default:
+      return value <= config_.level;
+  }
+}
+
+bool TriggerCapture::add(uint64_t timestampUs, float voltageV, float currentA)
+{
+  if (state_ != State::Armed) {
+    return false;
+  }
+
+  if (stored_ == 0) {
+    startUs_ = timestampUs;
+  }
+
+  uint32_t slot = head_;
+  offsetsUs_[slot] = (uint32_t)(timestampUs - startUs_);
+  voltageV_[slot] = voltageV;
+  currentA_[slot] = currentA;
+  head_ = (head_ + 1 == length_) ? 0 : head_ + 1;
+
+  if (!triggered_) {
+    float value = (config_.source == TriggerSource::Current) ? currentA : voltageV;
+    // Edges compare against the previous sample, so they cannot fire on
+    // the very first one.
+    bool edge = config_.mode == TriggerMode::RisingEdge || config_.mode == TriggerMode::FallingEdge;
+    bool ready = stored_ >= config_.pre_samples && (stored_ > 0 || !edge);
+    if (ready && fires(value)) {
+      triggered_ = true;
+      triggerSlot_ = slot;
+    }
+    previous_ = value;
+    if (stored_ < length_) {
+      stored_++;
+    }
+  }
+
+  if (triggered_) {
+    postStored_++;
+    if (postStored_ >= config_.post_samples) {
+      complete();
+      return false;
+    }
+  }
+  return true;
+}
+
+void TriggerCapture::cancel()
+{
+  if (state_ == State::Armed) {
+    state_ = State::Idle;
+  }
+}
+
+void TriggerCapture::complete()
+{
+  // Rotate the ring so the oldest pre-trigger sample lands at index 0 and
+  // the trigger sample at index pre_samples.
+  uint32_t oldest = (triggerSlot_ + length_ - config_.pre_samples) % length_;
+  std::rotate(offsetsUs_, offsetsUs_ + oldest, offsetsUs_ + length_);
+  std::rotate(voltageV_, voltageV_ + oldest, voltageV_ + length_);
+  std::rotate(currentA_, currentA_ + oldest, currentA_ + length_);
+
+  uint32_t baseUs = offsetsUs_[0];
+  for (uint32_t i = 0; i < length_; i++) {
+    offsetsUs_[i] -= baseUs;
+  }
+
+  state_ = State::Complete;
+  summary_ = summarizeCapture(offsetsUs_, voltageV_, currentA_, length_);
+}
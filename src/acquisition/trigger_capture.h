@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "capture_summary.h"
+
+enum class TriggerSource : uint8_t {
+  Current,
+  Voltage
+};
+
+enum class TriggerMode : uint8_t {
+  RisingEdge,
+  FallingEdge,
+  Above,
+  Below
+};
+
+typedef struct {
+  TriggerSource source;
+  TriggerMode mode;
+  float level;            // amps or volts, matching source
+  uint32_t pre_samples;   // kept from before the trigger sample
+  uint32_t post_samples;  // from the trigger sample on
+} trigger_config_t;
+
+// Single-shot triggered capture. While armed, samples run through a circular
+// buffer of pre + post entries; once at least pre samples are held, the
+// first sample meeting the trigger condition freezes the history and the
+// next post samples complete the frame. The finished frame is rotated in
+// place so the arrays read oldest-first, like a BurstCapture.
+class TriggerCapture {
+public:
+  enum class State : uint8_t {
+    Idle,
+    Armed,
+    Complete
+  };
+
+  void attach(uint32_t *offsetsUs, float *voltageV, float *currentA, uint32_t capacity);
+  bool attached() const { return capacity_ > 0; }
+
+  // Returns false if the frame does not fit the attached buffers.
+  bool arm(const trigger_config_t &config);
+
+  // Feed one sample. Returns false once the frame is complete.
+  bool add(uint64_t timestampUs, float voltageV, float currentA);
+
+  void cancel();
+
+  State state() const { return state_; }
+  bool armed() const { return state_ == State::Armed; }
+  bool triggered() const { return triggered_; }
+
+  // Valid once Complete
+  uint32_t count() const { return (state_ == State::Complete) ? length_ : 0; }
+  uint32_t triggerIndex() const { return config_.pre_samples; }
+  const uint32_t *offsetsUs() const { return offsetsUs_; }
+  const float *voltageV() const { return voltageV_; }
+  const float *currentA() const { return currentA_; }
+  const capture_summary_t &summary() const { return summary_; }
+
+private:
+  bool fires(float value) const;
+  void complete();
+
+  uint32_t *offsetsUs_ = nullptr;
+  float *voltageV_ = nullptr;
+  float *currentA_ = nullptr;
+  uint32_t capacity_ = 0;
+
+  State state_ = State::Idle;
+  trigger_config_t config_ = {};
+  uint32_t length_ = 0;
+  uint32_t head_ = 0;
+  uint32_t stored_ = 0;
+  uint64_t startUs_ = 0;
+  bool triggered_ = false;
+  uint32_t triggerSlot_ = 0;
+  uint32_t postStored_ = 0;
+  float previous_ = 0.0f;
+  capture_summary_t summary_ = {};
+};
@@ -0,0 +1,142 @@
+#include "battery_chemistry.h"
+
+#include <stddef.h>
+#include "ui/ui.h"
+
+namespace {
+
+constexpr size_t OCV_MAX_POINTS = 21;
+
+struct OcvPoint {
+  float voltageV;
+  float soc;
+};
+
+struct Chemistry {
+  battery_chemistry_t cell;
+  uint8_t pointCount;
+  OcvPoint curve[OCV_MAX_POINTS];  // resting cell voltage, rising with SoC
+};
+
+// Typical resting-voltage curves at room temperature. They are good enough to
+// show a live SoC and a runtime estimate, not to grade a battery; the capacity
+// test does that by counting charge.
+constexpr Chemistry CHEMISTRIES[] = {
+  // UI_BATTERY_ALKALINE
+  {{1.5f, 0.9f, 1.6f}, 7,
+   {{1.00f, 0.00f}, {1.15f, 0.10f}, {1.25f, 0.25f}, {1.35f, 0.50f}, {1.45f, 0.75f}, {1.52f, 0.90f}, {1.60f, 1.00f}}},
+  // UI_BATTERY_DRY_CELL (zinc-carbon)
+  {{1.5f, 0.9f, 1.6f}, 7,
+   {{0.95f, 0.00f}, {1.10f, 0.10f}, {1.20f, 0.25f}, {1.30f, 0.50f}, {1.40f, 0.75f}, {1.48f, 0.90f}, {1.58f, 1.00f}}},
+  // UI_BATTERY_LEAD_ACID (flooded)
+  {{2.0f, 1.93f, 2.45f}, 11,
+   {{1.750f, 0.00f}, {1.885f, 0.10f}, {1.930f, 0.20f}, {1.958f, 0.30f}, {1.983f, 0.40f}, {2.010f, 0.50f},
+    {2.033f, 0.60f}, {2.053f, 0.70f}, {2.070f, 0.80f}, {2.083f, 0.90f}, {2.117f, 1.00f}}},
+  // UI_BATTERY_SLA
+  {{2.0f, 1.93f, 2.45f}, 11,
+   {{1.750f, 0.00f}, {1.885f, 0.10f}, {1.930f, 0.20f}, {1.958f, 0.30f}, {1.983f, 0.40f}, {2.010f, 0.50f},
+    {2.033f, 0.60f}, {2.053f, 0.70f}, {2.070f, 0.80f}, {2.083f, 0.90f}, {2.117f, 1.00f}}},
+  // UI_BATTERY_AGM
+  {{2.0f, 1.75f, 2.40f}, 11,
+   {{1.750f, 0.00f}, {1.930f, 0.10f}, {1.970f, 0.20f}, {2.000f, 0.30f}, {2.020f, 0.40f}, {2.040f, 0.50f},
+    {2.060f, 0.60f}, {2.080f, 0.70f}, {2.100f, 0.80f}, {2.120f, 0.90f}, {2.140f, 1.00f}}},
+  // UI_BATTERY_NICD
+  {{1.2f, 1.2f, 1.45f}, 8,
+   {{1.10f, 0.00f}, {1.20f, 0.10f}, {1.24f, 0.20f}, {1.26f, 0.40f}, {1.28f, 0.60f}, {1.31f, 0.80f}, {1.34f, 0.90f},
+    {1.38f, 1.00f}}},
+  // UI_BATTERY_NIMH
+  {{1.2f, 1.2f, 1.45f}, 8,
+   {{1.10f, 0.00f}, {1.22f, 0.10f}, {1.25f, 0.20f}, {1.27f, 0.40f}, {1.29f, 0.60f}, {1.32f, 0.80f}, {1.35f, 0.90f},
+    {1.40f, 1.00f}}},
+  // UI_BATTERY_LITHIUM_PRIMARY (Li-MnO2)
+  {{3.0f, 2.0f, 3.3f}, 7,
+   {{2.00f, 0.00f}, {2.60f, 0.10f}, {2.80f, 0.25f}, {2.90f, 0.50f}, {3.00f, 0.75f}, {3.10f, 0.90f}, {3.30f, 1.00f}}},
+  // UI_BATTERY_LITHIUM_ION
+  {{3.6f, 3.5f, 4.2f}, 21,
+   {{3.27f, 0.00f}, {3.61f, 0.05f}, {3.69f, 0.10f}, {3.71f, 0.15f}, {3.73f, 0.20f}, {3.75f, 0.25f}, {3.77f, 0.30f},
+    {3.79f, 0.35f}, {3.80f, 0.40f}, {3.82f, 0.45f}, {3.84f, 0.50f}, {3.85f, 0.55f}, {3.87f, 0.60f}, {3.91f, 0.65f},
+    {3.95f, 0.70f}, {3.98f, 0.75f}, {4.02f, 0.80f}, {4.08f, 0.85f}, {4.11f, 0.90f}, {4.15f, 0.95f}, {4.20f, 1.00f}}},
+  // UI_BATTERY_LIPO
+  {{3.7f, 3.5f, 4.2f}, 21,
+   {{3.27f, 0.00f}, {3.61f, 0.05f}, {3.69f, 0.10f}, {3.71f, 0.15f}, {3.73f, 0.20f}, {3.75f, 0.25f}, {3.77f, 0.30f},
+    {3.79f, 0.35f}, {3.80f, 0.40f}, {3.82f, 0.45f}, {3.84f, 0.50f}, {3.85f, 0.55f}, {3.87f, 0.60f}, {3.91f, 0.65f},
+    {3.95f, 0.70f}, {3.98f, 0.75f}, {4.02f, 0.80f}, {4.08f, 0.85f}, {4.11f, 0.90f}, {4.15f, 0.95f}, {4.20f, 1.00f}}},
+  // UI_BATTERY_LIFEPO4
+  {{3.2f, 2.5f, 3.65f}, 11,
+   {{2.50f, 0.00f}, {3.00f, 0.10f}, {3.20f, 0.20f}, {3.22f, 0.30f}, {3.25f, 0.40f}, {3.26f, 0.50f}, {3.27f, 0.60f},
+    {3.30f, 0.70f}, {3.32f, 0.80f}, {3.35f, 0.90f}, {3.40f, 1.00f}}},
+};
+
+constexpr size_t CHEMISTRY_COUNT = sizeof(CHEMISTRIES) / sizeof(CHEMISTRIES[0]);
+static_assert(CHEMISTRY_COUNT == (size_t)UI_BATTERY_LIFEPO4 + 1, "one chemistry per ui_battery_type_t");
+
+// The lookup relies on every curve rising strictly in voltage and SoC and
+// spanning 0..1; a typo in the table fails the build instead.
+constexpr bool curveValid(const Chemistry &chemistry)
+{
+  if (chemistry.pointCount < 2 || chemistry.pointCount > OCV_MAX_POINTS) {
+    return false;
+  }
+  if (chemistry.curve[0].soc != 0.0f || chemistry.curve[chemistry.pointCount - 1].soc != 1.0f) {
+    return false;
+  }
+  for (size_t i = 1; i < chemistry.pointCount; i++) {
+    if (chemistry.curve[i].voltageV <= chemistry.curve[i - 1].voltageV ||
+        chemistry.curve[i].soc <= chemistry.curve[i - 1].soc) {
+      return false;
+    }
+  }
+  return chemistry.cell.cutoff_v < chemistry.cell.full_charge_v;
+}
+
+constexpr bool allCurvesValid()
+{
+  for (size_t i = 0; i < CHEMISTRY_COUNT; i++) {
+    if (!curveValid(CHEMISTRIES[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(allCurvesValid(), "every OCV curve must rise strictly from SoC 0 to 1");
+
+const Chemistry &chemistryFor(uint8_t batteryType)
+{
+  return CHEMISTRIES[batteryType < CHEMISTRY_COUNT ? batteryType : (size_t)UI_BATTERY_LIFEPO4];
+}
+
+}  // namespace
+
+extern "C" const battery_chemistry_t *battery_chemistry(uint8_t battery_type)
+{
+  return &chemistryFor(battery_type).cell;
+}
+
+extern "C" float battery_soc_from_cell_voltage(uint8_t battery_type, float cell_voltage_v)
+{
+  const Chemistry &chemistry = chemistryFor(battery_type);
+  const OcvPoint *curve = chemistry.curve;
+  size_t count = chemistry.pointCount;
+
+  if (!(cell_voltage_v > curve[0].voltageV)) {
+    return 0.0f;  // also catches NAN
+  }
+  if (cell_voltage_v >= curve[count - 1].voltageV) {
+    return 1.0f;
+  }
+
+  // Branch-light lower bound: halve the span each step, moving the base with
+  // a select rather than a taken branch. Ends with curve[base] <= v < curve[base + 1].
+  size_t base = 0;
+  size_t span = count - 1;
+  while (span > 1) {
+    size_t half = span / 2;
+    base = (curve[base + half].voltageV <= cell_voltage_v) ? base + half : base;
+    span -= half;
+  }
+
+  const OcvPoint &lo = curve[base];
+  const OcvPoint &hi = curve[base + 1];
+  return lo.soc + (hi.soc - lo.soc) * (cell_voltage_v - lo.voltageV) / (hi.voltageV - lo.voltageV);
+}
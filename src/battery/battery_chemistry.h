@@ -0,0 +1,29 @@
+#pragma once
+
+// Per-chemistry cell voltages and open-circuit-voltage to state-of-charge
+// curves, indexed by ui_battery_type_t. The tables are constexpr in
+// battery_chemistry.cpp and checked at compile time; this is the plain C view
+// of them so the UI can share the same numbers.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef struct {
+    float nominal_v;      // per cell
+    float cutoff_v;       // end-of-discharge
+    float full_charge_v;  // charger termination (fresh OCV for primaries)
+} battery_chemistry_t;
+
+// Unknown types fall back to LiFePO4, matching the config default.
+const battery_chemistry_t *battery_chemistry(uint8_t battery_type);
+
+// State of charge (0..1) of a resting cell at cell_voltage_v, by linear
+// interpolation over the chemistry's OCV curve; clamped at both ends.
+float battery_soc_from_cell_voltage(uint8_t battery_type, float cell_voltage_v);
+
+#ifdef __cplusplus
+}
+#endif
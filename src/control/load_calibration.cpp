@@ -0,0 +1,177 @@
+#include "load_calibration.h"
+
+#include <math.h>
+
+namespace {
+
+// Below this fraction of the span the stage counts as off: knot 0 goes at
+// the last level that still drew no more than this, the gate threshold.
+constexpr float THRESHOLD_FRACTION = 0.01f;
+
+}  // namespace
+
+bool validateLoadCalibration(const load_calibration_t &calibration)
+{
+  if (calibration.version != LOAD_CALIBRATION_VERSION || calibration.count < 2 ||
+      calibration.count > LOAD_CALIBRATION_POINTS || !isfinite(calibration.max_current_a) ||
+      !(calibration.max_current_a > 0.0f)) {
+    return false;
+  }
+  for (uint8_t k = 0; k < calibration.count; k++) {
+    if (!isfinite(calibration.volts[k]) || calibration.volts[k] < 0.0f) {
+      return false;
+    }
+    if (k > 0 && calibration.volts[k] < calibration.volts[k - 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+float loadCalibrationVolts(const load_calibration_t &calibration, float currentA)
+{
+  if (calibration.count < 2) {
+    return NAN;
+  }
+  if (!(currentA > 0.0f)) {
+    return 0.0f;
+  }
+
+  float position = currentA / calibration.max_current_a * (float)(calibration.count - 1);
+  size_t segment = (size_t)position;
+  if (segment > (size_t)(calibration.count - 2)) {
+    segment = calibration.count - 2;
+  }
+  float fraction = position - (float)segment;
+  float volts = calibration.volts[segment] + fraction * (calibration.volts[segment + 1] - calibration.volts[segment]);
+  return fmaxf(volts, 0.0f);
+}
+
+bool refineLoadCalibration(load_calibration_t *calibration, float outputV, float measuredA, float gain)
+{
+  // Below the threshold a wide range of volts all read as no current, so
+  // such a reading says nothing about where knot 0 belongs
+  if (calibration->count < 2 || !isfinite(outputV) || !isfinite(measuredA) ||
+      measuredA <= calibration->max_current_a * THRESHOLD_FRACTION || measuredA > calibration->max_current_a) {
+    return false;
+  }
+
+  float position = measuredA / calibration->max_current_a * (float)(calibration->count - 1);
+  size_t segment = (size_t)position;
+  if (segment > (size_t)(calibration->count - 2)) {
+    segment = calibration->count - 2;
+  }
+  float fraction = position - (float)segment;
+  float *volts = calibration->volts;
+  float error = outputV - (volts[segment] + fraction * (volts[segment + 1] - volts[segment]));
+  volts[segment] = fmaxf(volts[segment] + gain * (1.0f - fraction) * error, 0.0f);
+  volts[segment + 1] += gain * fraction * error;
+
+  // A nudge may cross a neighbour; the map must stay monotonic to invert
+  for (uint8_t k = 1; k < calibration->count; k++) {
+    if (volts[k] < volts[k - 1]) {
+      volts[k] = volts[k - 1];
+    }
+  }
+  return true;
+}
+
+LoadCalibrationSweep::LoadCalibrationSweep(uint8_t settleReadings, uint8_t averageReadings)
+    : settleReadings_(settleReadings), averageReadings_(averageReadings > 0 ? averageReadings : 1)
+{
+}
+
+float LoadCalibrationSweep::begin(float outputMaxV, float maxCurrentA, float maxPowerW)
+{
+  outputMaxV_ = outputMaxV;
+  maxCurrentA_ = maxCurrentA;
+  maxPowerW_ = maxPowerW;
+  step_ = 0;
+  readings_ = 0;
+  sumA_ = 0.0f;
+  count_ = 0;
+  active_ = outputMaxV > 0.0f;
+  return 0.0f;
+}
+
+float LoadCalibrationSweep::update(float volts, float currentA)
+{
+  if (!active_) {
+    return 0.0f;
+  }
+  if (isnan(currentA)) {
+    return (float)step_ * outputMaxV_ / (float)LOAD_CALIBRATION_SWEEP_STEPS;
+  }
+  // Checked on every reading, settling ones included: the sweep must not
+  // hold an over-limit level for a whole average
+  bool overLimit = currentA >= maxCurrentA_ || (!isnan(volts) && volts * currentA >= maxPowerW_);
+
+  readings_++;
+  if (readings_ > settleReadings_) {
+    sumA_ += currentA;
+  }
+  if (readings_ >= settleReadings_ + averageReadings_ || overLimit) {
+    float stepV = (float)step_ * outputMaxV_ / (float)LOAD_CALIBRATION_SWEEP_STEPS;
+    uint8_t kept = (readings_ > settleReadings_) ? (uint8_t)(readings_ - settleReadings_) : 0;
+    if (kept > 0 && count_ < LOAD_CALIBRATION_SWEEP_STEPS + 1) {
+      volts_[count_] = stepV;
+      currentA_[count_] = sumA_ / (float)kept;
+      count_++;
+    }
+    readings_ = 0;
+    sumA_ = 0.0f;
+    step_++;
+    if (overLimit || step_ > LOAD_CALIBRATION_SWEEP_STEPS) {
+      active_ = false;
+      return 0.0f;
+    }
+  }
+  return (float)step_ * outputMaxV_ / (float)LOAD_CALIBRATION_SWEEP_STEPS;
+}
+
+bool LoadCalibrationSweep::finish(float minSpanA, load_calibration_t *calibration) const
+{
+  if (count_ < 2) {
+    return false;
+  }
+
+  // Readings are noisy; the stage itself never draws less for more volts
+  float monotonic[LOAD_CALIBRATION_SWEEP_STEPS + 1];
+  monotonic[0] = currentA_[0];
+  for (size_t j = 1; j < count_; j++) {
+    monotonic[j] = fmaxf(currentA_[j], monotonic[j - 1]);
+  }
+  float spanA = monotonic[count_ - 1];
+  if (!(spanA > minSpanA)) {
+    return false;
+  }
+
+  load_calibration_t result = {};
+  result.version = LOAD_CALIBRATION_VERSION;
+  result.count = (uint8_t)LOAD_CALIBRATION_POINTS;
+  result.max_current_a = spanA;
+
+  float thresholdA = spanA * THRESHOLD_FRACTION;
+  size_t off = 0;
+  while (off + 1 < count_ && monotonic[off + 1] <= thresholdA) {
+    off++;
+  }
+  result.volts[0] = volts_[off];
+
+  size_t j = off;
+  for (size_t k = 1; k < LOAD_CALIBRATION_POINTS; k++) {
+    float targetA = spanA * (float)k / (float)(LOAD_CALIBRATION_POINTS - 1);
+    while (j + 1 < count_ && monotonic[j] < targetA) {
+      j++;
+    }
+    float volts = volts_[j];
+    if (j > off && monotonic[j] > monotonic[j - 1]) {
+      float fraction = (targetA - monotonic[j - 1]) / (monotonic[j] - monotonic[j - 1]);
+      volts = volts_[j - 1] + fraction * (volts_[j] - volts_[j - 1]);
+    }
+    result.volts[k] = fmaxf(volts, result.volts[k - 1]);
+  }
+
+  *calibration = result;
+  return true;
+}
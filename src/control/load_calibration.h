@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t LOAD_CALIBRATION_POINTS = 16;
+static constexpr uint8_t LOAD_CALIBRATION_VERSION = 1;
+static constexpr size_t LOAD_CALIBRATION_SWEEP_STEPS = 64;
+
+// Inverse map of the load stage: the DAC voltage that draws a given current.
+// Knot k is at k * max_current_a / (count - 1), so a lookup is one divide
+// and the knots are dense where the stage is steep in current, not in volts.
+// Stored in NVS as is; version guards the layout.
+typedef struct {
+  uint8_t version;
+  uint8_t count;        // knots in use; 0 when uncalibrated
+  float max_current_a;  // current at the last knot
+  float volts[LOAD_CALIBRATION_POINTS];
+} load_calibration_t;
+
+bool validateLoadCalibration(const load_calibration_t &calibration);
+
+// DAC volts for currentA, linear between knots and along the last segment
+// beyond them; 0 at or below zero current. NAN when uncalibrated.
+float loadCalibrationVolts(const load_calibration_t &calibration, float currentA);
+
+// Online linearization: moves the two knots around measuredA toward a
+// reading taken with the output held at outputV, weighted by how close each
+// knot is. Returns false for readings outside the calibrated span or below
+// the stage's threshold.
+bool refineLoadCalibration(load_calibration_t *calibration, float outputV, float measuredA, float gain);
+
+// Open-loop sweep that builds the table: steps the output up from zero and
+// records the settled current at each level, stopping early at the current
+// or power limit. The first settleReadings readings after each step are
+// dropped (one may predate the DAC write), the next averageReadings kept.
+//
+// Pure logic fed one fresh reading at a time, so it runs on the host.
+class LoadCalibrationSweep {
+public:
+  LoadCalibrationSweep(uint8_t settleReadings, uint8_t averageReadings);
+
+  // Returns the first output to apply.
+  float begin(float outputMaxV, float maxCurrentA, float maxPowerW);
+  // A reading taken under the last output returned; returns the next one,
+  // or 0 once the sweep is over.
+  float update(float volts, float currentA);
+  void abort() { active_ = false; }
+
+  bool active() const { return active_; }
+  size_t points() const { return count_; }
+  // Fits the table to the recorded points. False when the sweep never drew
+  // more than minSpanA, i.e. nothing was connected.
+  bool finish(float minSpanA, load_calibration_t *calibration) const;
+
+private:
+  uint8_t settleReadings_;
+  uint8_t averageReadings_;
+  bool active_ = false;
+  float outputMaxV_ = 0.0f;
+  float maxCurrentA_ = 0.0f;
+  float maxPowerW_ = 0.0f;
+  size_t step_ = 0;
+  uint8_t readings_ = 0;
+  float sumA_ = 0.0f;
+  size_t count_ = 0;
+  float volts_[LOAD_CALIBRATION_SWEEP_STEPS + 1] = {};
+  float currentA_[LOAD_CALIBRATION_SWEEP_STEPS + 1] = {};
+};
@@ -0,0 +1,292 @@
+#include "load_profile.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+
+namespace {
+
+const char *skipSpaces(const char *p)
+{
+  while (*p != '\0' && isspace((unsigned char)*p)) {
+    p++;
+  }
+  return p;
+}
+
+// Reads a number followed by a unit, matched case-insensitively against
+// units[] with their scale factors. Returns nullptr when either is missing.
+const char *parseQuantity(const char *p, const char *const units[], const double scales[], size_t unitCount,
+                          double *value)
+{
+  char *end = nullptr;
+  double number = strtod(p, &end);
+  if (end == p || !isfinite(number)) {
+    return nullptr;
+  }
+  p = skipSpaces(end);
+
+  const char *unitStart = p;
+  while (isalpha((unsigned char)*p)) {
+    p++;
+  }
+  size_t unitLength = (size_t)(p - unitStart);
+  for (size_t u = 0; u < unitCount; u++) {
+    size_t i = 0;
+    while (i < unitLength && units[u][i] != '\0' && tolower((unsigned char)unitStart[i]) == units[u][i]) {
+      i++;
+    }
+    if (i == unitLength && units[u][i] == '\0') {
+      *value = number * scales[u];
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+const char *const DURATION_UNITS[] = {"us", "ms", "s"};
+const double DURATION_SCALES_US[] = {1.0, 1000.0, 1000000.0};
+const char *const CURRENT_UNITS[] = {"ma", "a"};
+const double CURRENT_SCALES_A[] = {0.001, 1.0};
+
+}  // namespace
+
+LoadProfileError validateLoadProfile(const load_profile_t &profile, float maxCurrentA, size_t *errorStep)
+{
+  if (profile.count == 0) {
+    return LoadProfileError::Empty;
+  }
+  if (profile.count > LOAD_PROFILE_MAX_STEPS) {
+    if (errorStep != nullptr) {
+      *errorStep = LOAD_PROFILE_MAX_STEPS;
+    }
+    return LoadProfileError::TooManySteps;
+  }
+
+  for (size_t i = 0; i < profile.count; i++) {
+    const load_profile_step_t &step = profile.steps[i];
+    LoadProfileError error = LoadProfileError::None;
+    if (step.duration_us < LOAD_PROFILE_MIN_STEP_US) {
+      error = LoadProfileError::StepTooShort;
+    } else if (step.duration_us > LOAD_PROFILE_MAX_STEP_US) {
+      error = LoadProfileError::StepTooLong;
+    } else if (!(step.current_a >= 0.0f && step.current_a <= maxCurrentA)) {
+      error = LoadProfileError::CurrentOutOfRange;
+    }
+    if (error != LoadProfileError::None) {
+      if (errorStep != nullptr) {
+        *errorStep = i;
+      }
+      return error;
+    }
+  }
+  return LoadProfileError::None;
+}
+
+LoadProfileError parseLoadProfile(const char *text, float maxCurrentA, load_profile_t *profile, size_t *errorStep)
+{
+  if (text == nullptr || profile == nullptr) {
+    return LoadProfileError::Empty;
+  }
+
+  load_profile_t parsed = {};
+  const char *p = skipSpaces(text);
+  if (*p == '\0') {
+    return LoadProfileError::Empty;
+  }
+
+  for (;;) {
+    if (parsed.count == LOAD_PROFILE_MAX_STEPS) {
+      if (errorStep != nullptr) {
+        *errorStep = parsed.count;
+      }
+      return LoadProfileError::TooManySteps;
+    }
+
+    double durationUs = 0.0;
+    double currentA = 0.0;
+    p = parseQuantity(skipSpaces(p), DURATION_UNITS, DURATION_SCALES_US, 3, &durationUs);
+    if (p != nullptr) {
+      p = parseQuantity(skipSpaces(p), CURRENT_UNITS, CURRENT_SCALES_A, 2, &currentA);
+    }
+    if (p == nullptr) {
+      if (errorStep != nullptr) {
+        *errorStep = parsed.count;
+      }
+      return LoadProfileError::Syntax;
+    }
+
+    // Out-of-range durations are clamped to just past the limit so
+    // validation reports them rather than the cast wrapping
+    load_profile_step_t &step = parsed.steps[parsed.count++];
+    if (durationUs < 0.0) {
+      step.duration_us = 0;
+    } else if (durationUs > (double)LOAD_PROFILE_MAX_STEP_US) {
+      step.duration_us = LOAD_PROFILE_MAX_STEP_US + 1;
+    } else {
+      step.duration_us = (uint32_t)llround(durationUs);
+    }
+    step.current_a = (float)currentA;
+
+    p = skipSpaces(p);
+    if (*p == '\0') {
+      break;
+    }
+    if (*p != ',') {
+      if (errorStep != nullptr) {
+        *errorStep = parsed.count - 1;
+      }
+      return LoadProfileError::Syntax;
+    }
+    p++;
+  }
+
+  LoadProfileError error = validateLoadProfile(parsed, maxCurrentA, errorStep);
+  if (error == LoadProfileError::None) {
+    *profile = parsed;
+  }
+  return error;
+}
+
+const char *loadProfileErrorText(LoadProfileError error)
+{
+  switch (error) {
+    case LoadProfileError::None:
+      return "ok";
+    case LoadProfileError::Empty:
+      return "no steps";
+    case LoadProfileError::Syntax:
+      return "expected <duration us|ms|s> <current A|mA>";
+    case LoadProfileError::TooManySteps:
+      return "too many steps";
+    case LoadProfileError::StepTooShort:
+      return "step shorter than 2 ms";
+    case LoadProfileError::StepTooLong:
+      return "step longer than 1 h";
+    case LoadProfileError::CurrentOutOfRange:
+      return "current outside the load's range";
+  }
+  return "unknown error";
+}
+
+uint64_t loadProfilePeriodUs(const load_profile_t &profile)
+{
+  uint64_t total = 0;
+  for (size_t i = 0; i < profile.count && i < LOAD_PROFILE_MAX_STEPS; i++) {
+    total += profile.steps[i].duration_us;
+  }
+  return total;
+}
+
+LoadProfilePlayer::LoadProfilePlayer(float learnGainVPerA, float outputMaxV, uint32_t settleUs)
+    : learnGain_(learnGainVPerA), outputMax_(outputMaxV), settleUs_(settleUs)
+{
+  for (size_t i = 0; i < LOAD_PROFILE_MAX_STEPS; i++) {
+    outputV_[i].store(0.0f);
+    recordedA_[i].store(NAN);
+  }
+}
+
+void LoadProfilePlayer::start(const load_profile_t &profile, uint64_t startUs, float seedVPerA)
+{
+  profile_ = profile;
+  if (profile_.count > LOAD_PROFILE_MAX_STEPS) {
+    profile_.count = LOAD_PROFILE_MAX_STEPS;
+  }
+  if (profile_.count == 0) {
+    stop();
+    return;
+  }
+
+  for (uint8_t i = 0; i < profile_.count; i++) {
+    outputV_[i].store(fminf(fmaxf(profile_.steps[i].current_a * seedVPerA, 0.0f), outputMax_));
+    recordedA_[i].store(NAN);
+  }
+  loops_ = 0;
+  nextEdgeUs_ = startUs + profile_.steps[0].duration_us;
+  active_.store(startUs & START_MASK);
+}
+
+void LoadProfilePlayer::seedOutput(uint8_t step, float outputV)
+{
+  if (step < profile_.count && isfinite(outputV)) {
+    outputV_[step].store(fminf(fmaxf(outputV, 0.0f), outputMax_));
+  }
+}
+
+void LoadProfilePlayer::stop()
+{
+  active_.store(IDLE);
+}
+
+uint64_t LoadProfilePlayer::advance()
+{
+  uint8_t step = this->step();
+  if (step == LOAD_PROFILE_NO_STEP) {
+    return 0;
+  }
+
+  step++;
+  if (step >= profile_.count) {
+    step = 0;
+    loops_++;
+  }
+  uint64_t startUs = nextEdgeUs_;
+  nextEdgeUs_ += profile_.steps[step].duration_us;
+  active_.store(((uint64_t)step << STEP_SHIFT) | (startUs & START_MASK));
+  return nextEdgeUs_;
+}
+
+bool LoadProfilePlayer::record(uint8_t step, uint32_t offsetUs, float measuredA)
+{
+  if (step >= profile_.count || offsetUs < learnDelayUs() || isnan(measuredA)) {
+    return false;
+  }
+  recordedA_[step].store(measuredA);
+  return true;
+}
+
+bool LoadProfilePlayer::learn(uint8_t step)
+{
+  if (step >= profile_.count) {
+    return false;
+  }
+  float measuredA = recordedA_[step].exchange(NAN);
+  if (isnan(measuredA)) {
+    return false;
+  }
+  float error = profile_.steps[step].current_a - measuredA;
+  outputV_[step].store(fminf(fmaxf(outputV_[step].load() + learnGain_ * error, 0.0f), outputMax_));
+  return true;
+}
+
+bool LoadProfilePlayer::activeStep(uint8_t *step, uint64_t *startUs) const
+{
+  uint64_t active = active_.load();
+  uint8_t index = (uint8_t)(active >> STEP_SHIFT);
+  if (index == LOAD_PROFILE_NO_STEP) {
+    return false;
+  }
+  if (step != nullptr) {
+    *step = index;
+  }
+  if (startUs != nullptr) {
+    *startUs = active & START_MASK;
+  }
+  return true;
+}
+
+bool LoadProfilePlayer::learnable(uint8_t step) const
+{
+  return step < profile_.count && profile_.steps[step].duration_us > learnDelayUs();
+}
+
+float LoadProfilePlayer::targetA(uint8_t step) const
+{
+  return step < profile_.count ? profile_.steps[step].current_a : 0.0f;
+}
+
+float LoadProfilePlayer::outputV(uint8_t step) const
+{
+  return step < profile_.count ? outputV_[step].load() : 0.0f;
+}
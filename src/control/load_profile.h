@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t LOAD_PROFILE_MAX_STEPS = 32;
+static constexpr uint8_t LOAD_PROFILE_NO_STEP = 0xFF;
+// A step must leave room for its DAC write and at least one sample read.
+static constexpr uint32_t LOAD_PROFILE_MIN_STEP_US = 2000;
+static constexpr uint32_t LOAD_PROFILE_MAX_STEP_US = 3600000000UL;
+
+typedef struct {
+  uint32_t duration_us;
+  float current_a;
+} load_profile_step_t;
+
+typedef struct {
+  load_profile_step_t steps[LOAD_PROFILE_MAX_STEPS];
+  uint8_t count;
+} load_profile_t;
+
+enum class LoadProfileError : uint8_t {
+  None = 0,
+  Empty,
+  Syntax,
+  TooManySteps,
+  StepTooShort,
+  StepTooLong,
+  CurrentOutOfRange
+};
+
+// Parses the text form, e.g. "10ms 2A, 990ms 5mA": comma-separated steps,
+// each a duration (us, ms or s) then a current (A or mA). The result is
+// validated before it is returned; on error *profile is left untouched and
+// errorStep, if given, gets the 0-based index of the offending step.
+LoadProfileError parseLoadProfile(const char *text, float maxCurrentA, load_profile_t *profile,
+                                  size_t *errorStep = nullptr);
+LoadProfileError validateLoadProfile(const load_profile_t &profile, float maxCurrentA, size_t *errorStep = nullptr);
+const char *loadProfileErrorText(LoadProfileError error);
+uint64_t loadProfilePeriodUs(const load_profile_t &profile);
+
+// Replays a profile in a loop. An external one-shot timer calls advance()
+// at each edge; edges are scheduled from the previous edge rather than from
+// when the callback ran, so callback latency never accumulates into drift.
+//
+// Each step keeps its own DAC output, corrected from the currents measured
+// while that step was active (iterative learning). A step too short for the
+// current loop to settle in still converges over repeats of the profile.
+//
+// A reading is the sensor's last finished conversion, so it can span up to
+// two conversion windows before the moment it was read. It is learned from
+// only when all of that lies settleUs or more past the edge: learnDelayUs()
+// into the step. Steps shorter than that keep their seeded output. Each
+// step keeps its own latest usable reading until it is learned from, so a
+// short step's reading is not lost behind the next step's.
+//
+// start() and stop() run while the edge timer is stopped; advance() runs on
+// the timer, record() with the other writers excluded, and learn() on the
+// control task. step(), outputV() and the conversion window may be used
+// from any task.
+class LoadProfilePlayer {
+public:
+  LoadProfilePlayer(float learnGainVPerA, float outputMaxV, uint32_t settleUs);
+
+  // Seeds every step's output from a plant estimate of seedVPerA volts per
+  // amp and makes step 0 active from startUs.
+  void start(const load_profile_t &profile, uint64_t startUs, float seedVPerA);
+  void stop();
+  // Between start() and the first edge: replace a step's seeded output with
+  // a better estimate, e.g. from the load calibration.
+  void seedOutput(uint8_t step, float outputV);
+  // Only while stopped; follows the range of the DAC in use.
+  void setOutputMax(float outputMaxV) { outputMax_ = outputMaxV; }
+  // The sensor's conversion period: how long one reading averages over.
+  void setConversionWindow(uint32_t windowUs) { conversionWindowUs_.store(windowUs); }
+
+  // How far into a step a reading must be taken to be learned from, and
+  // whether the step is long enough to hold such a reading.
+  uint32_t learnDelayUs() const { return settleUs_ + 2 * conversionWindowUs_.load(); }
+  bool learnable(uint8_t step) const;
+
+  // Timer: make the next step active and return when it ends.
+  uint64_t advance();
+
+  // Keep a current measured offsetUs into the step for learn(). Returns
+  // false when the reading was too early to use.
+  bool record(uint8_t step, uint32_t offsetUs, float measuredA);
+  // Control task: nudge the step's output toward its target from its latest
+  // recorded reading. Returns false when none was recorded since the last
+  // call.
+  bool learn(uint8_t step);
+
+  // The active step and when it began, read together; false when stopped.
+  bool activeStep(uint8_t *step, uint64_t *startUs) const;
+
+  bool running() const { return step() != LOAD_PROFILE_NO_STEP; }
+  uint8_t step() const { return (uint8_t)(active_.load() >> STEP_SHIFT); }
+  uint64_t nextEdgeUs() const { return nextEdgeUs_; }
+  uint32_t loops() const { return loops_; }
+  uint8_t stepCount() const { return profile_.count; }
+  float targetA(uint8_t step) const;
+  float outputV(uint8_t step) const;
+
+private:
+  // Step index in the top byte, its start time in the rest, so readers on
+  // other tasks never pair one step with another's start
+  static constexpr unsigned STEP_SHIFT = 56;
+  static constexpr uint64_t START_MASK = (1ULL << STEP_SHIFT) - 1;
+  static constexpr uint64_t IDLE = (uint64_t)LOAD_PROFILE_NO_STEP << STEP_SHIFT;
+
+  float learnGain_;
+  float outputMax_;
+  uint32_t settleUs_;
+  std::atomic<uint32_t> conversionWindowUs_{0};
+  load_profile_t profile_ = {};
+  std::atomic<float> outputV_[LOAD_PROFILE_MAX_STEPS];
+  std::atomic<float> recordedA_[LOAD_PROFILE_MAX_STEPS];  // NAN when none
+  std::atomic<uint64_t> active_{IDLE};
+  uint64_t nextEdgeUs_ = 0;
+  uint32_t loops_ = 0;
+};
@@ -0,0 +1,107 @@
+#include "pi_controller.h"
+
+#include <math.h>
+
+PiController::PiController(const pi_controller_config_t &config) : config_(config)
+{
+}
+
+void PiController::configure(const pi_controller_config_t &config)
+{
+  config_ = config;
+}
+
+void PiController::reset(float output, float feedforward)
+{
+  output_ = fminf(fmaxf(output, config_.outputMin), config_.outputMax);
+  feedforward_ = feedforward;
+  integral_ = output_ - feedforward;
+  saturated_ = false;
+}
+
+float PiController::step(float setpoint, float measured, float dtS, float feedforward)
+{
+  if (!(dtS > 0.0f) || isnan(measured) || isnan(setpoint)) {
+    return output_;
+  }
+  if (!isfinite(feedforward)) {
+    feedforward = 0.0f;
+  }
+
+  float error = setpoint - measured;
+  float proportional = config_.kp * error;
+  float candidateIntegral = integral_ + config_.ki * error * dtS;
+
+  float target = feedforward + proportional + candidateIntegral;
+  float limited = fminf(fmaxf(target, config_.outputMin), config_.outputMax);
+  if (config_.slewPerSecond > 0.0f) {
+    float maxStep = config_.slewPerSecond * dtS;
+    float base = output_ + (feedforward - feedforward_);
+    limited = fminf(fmaxf(limited, base - maxStep), base + maxStep);
+    limited = fminf(fmaxf(limited, config_.outputMin), config_.outputMax);
+  }
+
+  // Keep the new integral only if it is not feeding a limit: either nothing
+  // clipped, or the error is already pulling the output back inside.
+  saturated_ = (limited != target);
+  bool pushingUp = (target > limited) && (error > 0.0f);
+  bool pushingDown = (target < limited) && (error < 0.0f);
+  if (!pushingUp && !pushingDown) {
+    integral_ = candidateIntegral;
+  }
+
+  feedforward_ = feedforward;
+  output_ = limited;
+  return output_;
+}
+
+StepResponseMonitor::StepResponseMonitor(float bandFraction, float bandMin, float holdS, float timeoutS)
+    : bandFraction_(bandFraction), bandMin_(bandMin), holdS_(holdS), timeoutS_(timeoutS)
+{
+}
+
+void StepResponseMonitor::begin(float from, float to, uint64_t timestampUs)
+{
+  from_ = from;
+  to_ = to;
+  startUs_ = timestampUs;
+  inside_ = false;
+  overshoot_ = 0.0f;
+  settlingS_ = 0.0f;
+  active_ = (to != from);
+}
+
+bool StepResponseMonitor::update(float measured, uint64_t timestampUs)
+{
+  if (!active_ || isnan(measured)) {
+    return false;
+  }
+
+  float step = to_ - from_;
+  float past = (measured - to_) / step;  // > 0 once beyond the target, for either direction
+  if (past > overshoot_) {
+    overshoot_ = past;
+  }
+
+  float band = fmaxf(fabsf(step) * bandFraction_, bandMin_);
+  if (fabsf(measured - to_) <= band) {
+    if (!inside_) {
+      inside_ = true;
+      insideSinceUs_ = timestampUs;
+    }
+    if ((float)(timestampUs - insideSinceUs_) / 1000000.0f >= holdS_) {
+      settlingS_ = (float)(insideSinceUs_ - startUs_) / 1000000.0f;
+      active_ = false;
+      return true;
+    }
+  } else {
+    inside_ = false;
+  }
+
+  if ((float)(timestampUs - startUs_) / 1000000.0f >= timeoutS_) {
+    settlingS_ = NAN;
+    active_ = false;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  float kp;              // output per unit of error
+  float ki;              // output per unit of error per second
+  float outputMin;
+  float outputMax;
+  float slewPerSecond;   // largest output change per second; 0 disables the limit
+} pi_controller_config_t;
+
+// PI controller with the two protections a DAC-driven load needs. The
+// output is clamped to its range and rate-limited; while either limit is
+// holding it back, the integrator stops accumulating in the direction that
+// would push further into the limit (conditional integration), so there is
+// no wound-up term to unwind when the limit releases.
+//
+// An optional feedforward term (the expected output for the setpoint, from
+// a plant calibration) is added outside the integrator, and the slew limit
+// follows it: only the correction is rate-limited, so a setpoint change
+// lands on the calibrated level in one step.
+//
+// No hardware or RTOS calls: step() is a pure function of its inputs and
+// the controller's state, so it runs the same on the host against a model.
+class PiController {
+public:
+  explicit PiController(const pi_controller_config_t &config);
+
+  void configure(const pi_controller_config_t &config);
+  // Start from `output` with no integral history beyond what holds it there.
+  void reset(float output, float feedforward = 0.0f);
+
+  // One control update dtS seconds after the previous one.
+  float step(float setpoint, float measured, float dtS, float feedforward = 0.0f);
+
+  float output() const { return output_; }
+  bool saturated() const { return saturated_; }
+
+private:
+  pi_controller_config_t config_;
+  float integral_ = 0.0f;
+  float output_ = 0.0f;
+  float feedforward_ = 0.0f;
+  bool saturated_ = false;
+};
+
+// Measures one setpoint step for tuning: overshoot as a fraction of the step
+// and the time until the measurement stays inside the settling band.
+class StepResponseMonitor {
+public:
+  // bandFraction of the step (or bandMin, whichever is larger) counts as
+  // settled once held for holdS seconds. A step still unsettled after
+  // timeoutS is reported with a NAN settling time.
+  StepResponseMonitor(float bandFraction, float bandMin, float holdS, float timeoutS);
+
+  void begin(float from, float to, uint64_t timestampUs);
+  // Returns true once, on the update that completes the measurement.
+  bool update(float measured, uint64_t timestampUs);
+
+  bool active() const { return active_; }
+  float target() const { return to_; }
+  float settlingS() const { return settlingS_; }
+  float overshootFraction() const { return overshoot_; }
+
+private:
+  float bandFraction_;
+  float bandMin_;
+  float holdS_;
+  float timeoutS_;
+  bool active_ = false;
+  float from_ = 0.0f;
+  float to_ = 0.0f;
+  uint64_t startUs_ = 0;
+  uint64_t insideSinceUs_ = 0;
+  bool inside_ = false;
+  float overshoot_ = 0.0f;
+  float settlingS_ = 0.0f;
+};
@@ -0,0 +1,67 @@
+#include "safety_supervisor.h"
+
+#include <math.h>
+
+SafetySupervisor::SafetySupervisor(uint32_t shutdownBudgetUs) : budgetUs_(shutdownBudgetUs)
+{
+}
+
+void SafetySupervisor::arm(float cutoffV, float overtempC)
+{
+  trip_ = {SafetyTrip::None, 0.0f, 0.0f, 0, 0};
+  setLimits(cutoffV, overtempC);
+  armed_ = true;
+}
+
+void SafetySupervisor::disarm()
+{
+  armed_ = false;
+}
+
+void SafetySupervisor::setLimits(float cutoffV, float overtempC)
+{
+  cutoffV_ = cutoffV;
+  overtempC_ = overtempC;
+}
+
+bool SafetySupervisor::checkVoltage(float volts, uint64_t timestampUs)
+{
+  if (isnan(volts) || volts > cutoffV_) {
+    return false;
+  }
+  return latch(SafetyTrip::Undervoltage, volts, cutoffV_, timestampUs);
+}
+
+bool SafetySupervisor::checkTemperature(float celsius, uint64_t timestampUs)
+{
+  if (isnan(celsius) || celsius < overtempC_) {
+    return false;
+  }
+  return latch(SafetyTrip::Overtemperature, celsius, overtempC_, timestampUs);
+}
+
+void SafetySupervisor::shutdownComplete(uint64_t timestampUs)
+{
+  if (shutdownPending()) {
+    // A zero timestamp would read as "not yet"
+    trip_.shutdown_us = (timestampUs > trip_.trip_us) ? timestampUs : trip_.trip_us + 1;
+  }
+}
+
+uint32_t SafetySupervisor::latencyUs() const
+{
+  if (!latched() || trip_.shutdown_us == 0) {
+    return UINT32_MAX;
+  }
+  uint64_t latency = trip_.shutdown_us - trip_.trip_us;
+  return latency >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t)latency;
+}
+
+bool SafetySupervisor::latch(SafetyTrip trip, float value, float threshold, uint64_t timestampUs)
+{
+  if (!armed_ || latched()) {
+    return false;
+  }
+  trip_ = {trip, value, threshold, timestampUs, 0};
+  return true;
+}
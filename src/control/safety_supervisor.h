@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class SafetyTrip : uint8_t {
+  None = 0,
+  Undervoltage = 1,
+  Overtemperature = 2
+};
+
+typedef struct {
+  SafetyTrip trip;
+  float value;            // the reading that crossed: V or C
+  float threshold;        // the limit it crossed
+  uint64_t trip_us;       // timestamp of that reading
+  uint64_t shutdown_us;   // when the outputs were confirmed at zero; 0 until then
+} safety_trip_t;
+
+// Latching limit supervisor for the load. It sees every reading on the
+// task that owns the bus, so the caller can zero the DAC inline on the
+// reading that trips instead of waiting for the UI loop. The first trip
+// latches until arm() is called again; later crossings are not recorded.
+//
+// Pure logic with caller-supplied timestamps, so it runs on the host.
+class SafetySupervisor {
+public:
+  // shutdownBudgetUs: the longest acceptable time from the tripping reading
+  // to the outputs confirmed at zero.
+  explicit SafetySupervisor(uint32_t shutdownBudgetUs);
+
+  // Clears any latched trip and starts checking.
+  void arm(float cutoffV, float overtempC);
+  void disarm();
+  // Follows config changes without clearing a latched trip.
+  void setLimits(float cutoffV, float overtempC);
+
+  // Each returns true on the reading that trips. NAN readings never trip.
+  bool checkVoltage(float volts, uint64_t timestampUs);
+  bool checkTemperature(float celsius, uint64_t timestampUs);
+
+  // Record when the outputs were confirmed at zero after a trip.
+  void shutdownComplete(uint64_t timestampUs);
+
+  bool armed() const { return armed_; }
+  bool latched() const { return trip_.trip != SafetyTrip::None; }
+  bool shutdownPending() const { return latched() && trip_.shutdown_us == 0; }
+  const safety_trip_t &trip() const { return trip_; }
+  // Tripping reading to outputs at zero; UINT32_MAX until shutdown.
+  uint32_t latencyUs() const;
+  bool withinBudget() const { return latencyUs() <= budgetUs_; }
+  uint32_t budgetUs() const { return budgetUs_; }
+
+private:
+  bool latch(SafetyTrip trip, float value, float threshold, uint64_t timestampUs);
+
+  uint32_t budgetUs_;
+  bool armed_ = false;
+  float cutoffV_ = 0.0f;
+  float overtempC_ = 0.0f;
+  safety_trip_t trip_ = {SafetyTrip::None, 0.0f, 0.0f, 0, 0};
+};
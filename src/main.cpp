@@ -10,26 +10,93 @@
 #include <Preferences.h>
 #include <M5UnitUnified.h>
 #include <M5UnitUnifiedMETER.h>
-#include <M5UnitUnifiedANADIG.h>
 #include <M5GFX.h>
 #include <math.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
 #include "lvgl.h"
 #include "ui/ui.h"
+#include "acquisition/acq_sample.h"
+#include "acquisition/burst_capture.h"
+#include "acquisition/capacity_evaluator.h"
+#include "acquisition/energy_integrator.h"
+#include "acquisition/jitter_stats.h"
+#include "acquisition/running_stats.h"
+#include "acquisition/sample_ring.h"
+#include "acquisition/trigger_capture.h"
+#include "battery/battery_chemistry.h"
+#include "control/load_calibration.h"
+#include "control/load_profile.h"
+#include "control/pi_controller.h"
+#include "control/safety_supervisor.h"
+#include "sensors/ad5693r_dac.h"
+#include "sensors/auto_range.h"
+#include "sensors/device_link.h"
+#include "sensors/gp8413_dac.h"
+#include "sensors/i2c_transaction_queue.h"
+#include "sensors/ina226_driver.h"
+#include "sensors/ina228_driver.h"
+#include "sensors/ina3221_driver.h"
+#include "sensors/wire_register_bus.h"
 #include "pins_config.h"
 
 // Sensor objects
 static m5::unit::UnitUnified meterUnits1A;
 static m5::unit::UnitUnified meterUnits10A;
 static m5::unit::UnitUnified thermoUnits;
-static m5::unit::UnitUnified anadigUnits;
 
 static m5::unit::UnitINA226_1A ina226_1a;
 static m5::unit::UnitINA226_10A ina226_10a;
 static m5::unit::UnitKmeterISO loadThermocouple;
-static m5::unit::UnitDAC2 dac2;
 
 static m5::unit::UnitINA226 *activeIna226 = &ina226_1a;
 static m5::unit::UnitUnified *activeMeterUnits = &meterUnits1A;
+
+// Register-level access to the active INA226. UnitUnified still brings the
+// unit up; per-sample reads go through the lean driver when it attaches.
+static WireRegisterBus externalBus(Wire);
+static Ina226Driver ina226Driver;
+static bool ina226DriverActive = false;
+static bool conversionReadyMode = false;
+static uint32_t conversionPeriodUs = 0;
+static std::atomic<uint64_t> ina226AlertUs{0};
+// Slack on top of two expected periods before a silent ALERT is re-armed
+static constexpr uint64_t CONVERSION_READY_SLACK_US = 50000;
+
+// Auto-range: the 10A unit is the active one (captures, presets) and the 1A
+// unit is read alongside it on every sample through its own driver.
+static bool autoRanging = false;
+static Ina226Driver fineDriver;
+static bool fineDriverActive = false;
+
+// INA3221 mode: one part, three rails, all read in one pass per sample
+static constexpr uint8_t INA3221_ADDRESS = 0x42;  // A0 tied to SDA
+static constexpr float INA3221_SHUNT_OHMS = 0.1f;
+static Ina3221Driver ina3221Driver;
+static bool ina3221Mode = false;
+static bool ina3221DriverActive = false;
+static uint8_t appliedSensorType = 0xFF;  // acquisition task's view of acqSensorType
+
+// INA228 mode: the chip integrates energy and charge itself; the software
+// integral keeps running alongside as a cross-check
+static constexpr uint8_t INA228_ADDRESS = 0x44;  // A1 tied to VS
+static constexpr float INA228_SHUNT_OHMS = 0.015f;
+static constexpr float INA228_MAX_CURRENT_A = 10.0f;
+static constexpr uint64_t INA228_TOTALS_INTERVAL_US = 1000000;
+static Ina228Driver ina228Driver;
+static bool ina228Mode = false;
+static bool ina228DriverActive = false;
+static uint64_t lastTotalsReadUs = 0;
+
+// INA228 accumulator totals: written by the acquisition task about once a
+// second during a test, read by the UI loop
+static acq_energy_totals_t ina228Totals = {0.0, 0.0, 0, 0};
+static portMUX_TYPE ina228TotalsMux = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t testStartUs = 0;
+static double ina228EnergyWh = 0.0;  // channel 0 totals as the chip counted them
+static double ina228ChargeAh = 0.0;
 static Preferences preferences;
 
 // Display
@@ -40,7 +107,6 @@ static lv_disp_draw_buf_t draw_buf;
 static lv_color_t *buf;
 
 // Runtime state
-static ui_channel_data_t channelData;
 static ui_config_t runtimeConfig = {
   UI_SENSOR_INA226_1A,
   UI_UNITS_IMPERIAL,
@@ -51,40 +117,379 @@ static ui_config_t runtimeConfig = {
   10.0f,
   60.0f,
   100.0f,
-  4
+  4,
+  UI_INA_PRESET_BALANCED,
+  2,
+  4,
+  4,
+  UI_TRIGGER_SOURCE_CURRENT,
+  UI_TRIGGER_RISING_EDGE,
+  100.0f,
+  1000,
+  1.0f,
+  5.0f,
+  10.0f
 };
 
-static uint32_t lastSampleMs = 0;
+// Per-metric statistics: over the whole test, and over a sliding window of
+// STATS_WINDOW_BUCKETS one-second buckets
+static constexpr size_t STATS_WINDOW_BUCKETS = 60;
+static constexpr uint32_t STATS_BUCKET_US = 1000000;
+static constexpr uint32_t STATS_LOG_INTERVAL_MS = 10000;
+typedef WindowedStats<STATS_WINDOW_BUCKETS, STATS_BUCKET_US> window_stats_t;
+
+// One energy and charge integrator per monitor channel, all fed from the same
+// sample timestamps. Cutoff and overtemp watch channel 0, the battery under test.
+typedef struct {
+  ui_channel_data_t data;
+  EnergyIntegrator integrator;
+  RunningStats testStats[UI_STAT_COUNT];
+  window_stats_t windowStats[UI_STAT_COUNT];
+} channel_state_t;
+
+static channel_state_t channels[UI_CHANNEL_COUNT] = {};
+static_assert(INA3221_CHANNEL_COUNT <= UI_CHANNEL_COUNT, "every INA3221 channel needs a monitor channel");
 static uint32_t lastDebugMs = 0;
+static uint32_t lastStatsLogMs = 0;
 static uint32_t lastLvTickMs = 0;
-static uint32_t lastSensorRetryMs = 0;
-static uint32_t lastLoadTempRetryMs = 0;
-
-static float energyWh = 0.0f;
-static bool sensor1AReady = false;
-static bool sensor10AReady = false;
-static bool loadTempPresent = false;
-static bool sensorPresent = false;
+
 static bool cutoffReached = false;
 static bool overtempReached = false;
-static bool dacPresent = false;
 static bool testRunning = false;
 
+// Capacity verdict for channel 0: PASS when the battery delivers at least
+// this fraction of its rated Ah before reaching cutoff
+static constexpr float CAPACITY_PASS_FRACTION = 0.8f;
+static constexpr float CAPACITY_PROJECTION_STEP = 0.02f;  // of rated Ah per voltage checkpoint
+static CapacityEvaluator capacity(CAPACITY_PASS_FRACTION, CAPACITY_PROJECTION_STEP);
+static constexpr float RUNTIME_MIN_CURRENT_A = 0.001f;  // below this the runtime is shown as unknown
+
+// External-bus devices, each with its own connection state machine. The
+// links belong to the acquisition task (setup uses them before it starts);
+// state changes reach the UI loop as events.
+enum DeviceId : uint8_t {
+  DEVICE_INA226_1A = 0,
+  DEVICE_INA226_10A,
+  DEVICE_THERMOCOUPLE,
+  DEVICE_DAC2,
+  DEVICE_INA3221,
+  DEVICE_INA228,
+  DEVICE_AD5693R,
+  DEVICE_COUNT
+};
+
+typedef struct {
+  uint8_t device;
+  LinkState state;
+} device_event_t;
+
+static constexpr uint32_t PROBE_BACKOFF_MIN_MS = 500;
+static constexpr uint32_t PROBE_BACKOFF_MAX_MS = 30000;
+static DeviceLink deviceLinks[DEVICE_COUNT] = {
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS},
+  {PROBE_BACKOFF_MIN_MS, PROBE_BACKOFF_MAX_MS}
+};
+static bool deviceUnitAdded[DEVICE_COUNT] = {};
+// Both start at Probing ("not heard from yet"), so the first settled state of
+// every device, absent included, reaches the status screen.
+static LinkState devicePublished[DEVICE_COUNT] = {
+  LinkState::Probing, LinkState::Probing, LinkState::Probing, LinkState::Probing, LinkState::Probing,
+  LinkState::Probing, LinkState::Probing
+};
+static SampleRing<device_event_t, 16> deviceEvents;
+static LinkState deviceStatus[DEVICE_COUNT] = {  // UI loop's copy
+  LinkState::Probing, LinkState::Probing, LinkState::Probing, LinkState::Probing, LinkState::Probing,
+  LinkState::Probing, LinkState::Probing
+};
+static bool deviceStatusShown = false;
+
+// Startup timing, in esp_timer microseconds since boot. The first sample is
+// the first good read of the active INA226, stamped by the acquisition task.
+static int64_t bootFirstFrameUs = 0;
+static std::atomic<uint64_t> acqFirstSampleUs{0};
+static bool bootFirstSampleLogged = false;
+
+// Written by the UI loop, picked up by the acquisition task
+static std::atomic<bool> acqEnabled{false};
+static std::atomic<uint16_t> acqIntervalMs{200};
+static std::atomic<uint16_t> acqTempIntervalMs{1000};
+static std::atomic<uint8_t> acqSensorType{UI_SENSOR_INA226_1A};
+static std::atomic<uint16_t> acqIna226Config{0};
+
+static constexpr size_t SAMPLE_RING_CAPACITY = 128;  // room for three INA3221 channels per tick
+static SampleRing<acq_sample_t, SAMPLE_RING_CAPACITY> sampleRing;
+static TaskHandle_t acquisitionTaskHandle = nullptr;
+static esp_timer_handle_t sampleTimer = nullptr;
+static uint32_t acqDroppedLogged = 0;
+
+// Sampling period statistics: owned by the acquisition task, snapshotted for the UI loop
+static JitterStats acqJitter;
+static JitterStats acqJitterSnapshot;
+static portMUX_TYPE acqJitterMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<bool> acqJitterResetPending{true};
+static std::atomic<uint32_t> acqBytesPerSample{0};
+
+// Burst and triggered captures share one set of PSRAM buffers. The
+// acquisition task fills them, then hands them to the UI loop, which owns
+// them until the capture has been shown.
+static constexpr uint32_t CAPTURE_CAPACITY = 16384;
+static constexpr uint32_t BURST_WINDOW_US = 1000000;
+static constexpr uint32_t TRIGGER_PRE_SAMPLES = 1024;
+static constexpr uint32_t TRIGGER_POST_SAMPLES = 3072;
+static constexpr uint64_t TRIGGER_TIMEOUT_US = 30000000ULL;
+static BurstCapture burstCapture;
+static TriggerCapture triggerCapture;
+static trigger_config_t pendingTrigger = {};
+static std::atomic<bool> acqBurstRequested{false};
+static std::atomic<bool> acqBurstReady{false};
+static std::atomic<bool> acqTriggerRequested{false};
+static std::atomic<bool> acqTriggerCancel{false};
+static std::atomic<bool> acqTriggerReady{false};
+static bool captureInFlight = false;
+static bool triggerArmed = false;
+static uint32_t acqSequence = 0;
+
+// Every external-bus transaction other than the INA226 sample read goes
+// through this queue and runs on the acquisition task, which owns Wire.
+static I2cTransactionQueue busQueue;
+static constexpr size_t I2C_QUEUE_DEPTH = 8;
+static constexpr uint32_t I2C_JOB_STARVATION_US = 100000;
+static constexpr uint32_t I2C_JOB_GUARD_US = 300;
+static constexpr uint32_t I2C_SERVICE_MS = 10;
+
+// Per-device queue priority and expected bus time per job
+static constexpr I2cPriority DAC_I2C_PRIORITY = I2cPriority::Control;
+static constexpr uint32_t DAC_WRITE_US = 400;
+static constexpr I2cPriority PROBE_I2C_PRIORITY = I2cPriority::Maintenance;
+static constexpr uint32_t PROBE_ACK_US = 150;
+static constexpr uint32_t PROBE_BRING_UP_US = 20000;
+static constexpr I2cPriority THERMO_READ_I2C_PRIORITY = I2cPriority::Background;
+static constexpr uint32_t THERMO_READ_US = 1500;
+
+// Bus utilization: time the bus owner spent in transactions, and bytes the
+// register driver moved, collected by the task and drained once a second
+static std::atomic<uint32_t> acqBusBusyUs{0};
+static std::atomic<uint32_t> acqBusBytes{0};
+
+// Acquisition task only: thermocouple scheduling
+static float thermoReadC = NAN;
+static bool thermoJobPending = false;
+static uint32_t lastLoadTempRequestMs = 0;
+
+// Latest thermocouple reading: written by the acquisition task, read by the
+// UI loop. Overtemp protection ignores readings older than this many
+// thermocouple intervals.
+static acq_temp_reading_t loadTempReading = {NAN, 0};
+static portMUX_TYPE loadTempMux = portMUX_INITIALIZER_UNLOCKED;
+static constexpr uint32_t LOAD_TEMP_STALE_INTERVALS = 3;
+static bool loadTempStaleLogged = false;
+
+// Load DACs: the DAC2 unit (GP8413, 15-bit over 0-10 V) and an optional
+// AD5693R (16-bit over 0-5 V), which is preferred when both answer for its
+// finer steps at low currents. The acquisition task picks the active one.
 static constexpr uint8_t DAC_ADDRESS = 0x59;
+static constexpr uint8_t AD5693R_ADDRESS = AD5693R_ADDRESS_A0_LOW;
+static constexpr bool AD5693R_GAIN_2X = true;
+static Gp8413Dac gp8413Dac;
+static Ad5693rDac ad5693rDac;
+static std::atomic<LoadDac *> loadDac{nullptr};
+
+// Electronic load: the load DAC drives the load stage, and a PI loop in its
+// own task closes on the channel 0 current. Constant power and constant
+// impedance are outer laws that turn their setpoint into a current target
+// from each new voltage reading. The gains assume roughly 1 A per volt above
+// the stage's threshold; they were tuned on a simulated MOSFET load and want
+// revisiting on real hardware.
+static constexpr uint32_t LOAD_CONTROL_PERIOD_MS = 20;
+static constexpr float LOAD_KP_V_PER_A = 0.4f;
+static constexpr float LOAD_KI_V_PER_AS = 15.0f;
+static constexpr float LOAD_SLEW_V_PER_S = 20.0f;
+static constexpr float LOAD_MAX_CURRENT_A = 10.0f;
+static constexpr float LOAD_MAX_POWER_W = 200.0f;
+static constexpr float LOAD_MIN_RESISTANCE_OHM = 0.1f;
+static constexpr float LOAD_MAX_RESISTANCE_OHM = 1000.0f;
+// Below this the pack is collapsed or disconnected; constant power would
+// otherwise ask for ever more current
+static constexpr float LOAD_MIN_VOLTAGE_V = 0.5f;
+static constexpr uint32_t LOAD_MEASUREMENT_STALE_US = 500000;
+static constexpr uint32_t LOAD_TASK_STACK = 4096;
+static constexpr UBaseType_t LOAD_TASK_PRIORITY = 4;  // below acquisition, which owns the bus
+
+// Pulsed load: a looping profile of (duration, current) steps. Step edges
+// come from a one-shot esp_timer and each step learns its own DAC level
+// over repeats, since a 10 ms pulse is gone before the PI loop could act.
+static constexpr float LOAD_PROFILE_LEARN_GAIN_V_PER_A = 0.3f;
+static constexpr float LOAD_PROFILE_SEED_V_PER_A = 1.0f;
+static constexpr uint32_t LOAD_PROFILE_SETTLE_US = 1000;
+static constexpr const char *DEFAULT_LOAD_PROFILE = "10ms 2A, 990ms 5mA";
+static constexpr size_t LOAD_PROFILE_TEXT_MAX = 256;
+
+// Load calibration: the "calibrate" command sweeps the DAC open-loop and
+// stores the current-to-volts map in NVS; the loop adds it as feedforward so
+// a setpoint change lands in a tick or two. While regulating, every reading
+// taken with the output held steady refines the map, which follows the
+// stage as it warms; refinements are saved when the load turns off.
+static constexpr uint8_t LOAD_CALIBRATION_SETTLE_READINGS = 2;
+static constexpr uint8_t LOAD_CALIBRATION_AVERAGE_READINGS = 2;
+static constexpr float LOAD_CALIBRATION_MIN_SPAN_A = 0.05f;
+static constexpr float LOAD_CALIBRATION_REFINE_GAIN = 0.1f;
+static constexpr float LOAD_CALIBRATION_HOLD_V = 0.005f;
+
+// Settling: within 2% of the step (at least 5 mA) for 200 ms; give up after 5 s
+static constexpr float LOAD_SETTLE_BAND = 0.02f;
+static constexpr float LOAD_SETTLE_BAND_MIN_A = 0.005f;
+static constexpr float LOAD_SETTLE_HOLD_S = 0.2f;
+static constexpr float LOAD_SETTLE_TIMEOUT_S = 5.0f;
+
+// Latest channel 0 reading: written by the acquisition task, read by the
+// load control task
+typedef struct {
+  float voltage_v;
+  float current_a;
+  uint64_t timestamp_us;  // 0 when there has been no reading
+} load_measurement_t;
+
+static load_measurement_t loadMeasurement = {0.0f, 0.0f, 0};
+static portMUX_TYPE loadMeasurementMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<bool> loadEnabled{false};
+static std::atomic<uint8_t> loadMode{UI_LOAD_CONSTANT_CURRENT};
+static std::atomic<float> loadSetpoint{0.0f};  // A, W or ohm by loadMode
+static TaskHandle_t loadControlTaskHandle = nullptr;
+
+// The profile to play is set by the UI loop and copied by the control task
+// when playback starts; the revision tells it to restart on a change.
+static load_profile_t loadProfile = {};
+static char loadProfileText[LOAD_PROFILE_TEXT_MAX] = "";
+static portMUX_TYPE loadProfileMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> loadProfileRevision{0};
+// Started and stopped by the control task, advanced by the edge timer. The
+// output range is set from the active DAC before each start.
+static LoadProfilePlayer profilePlayer(LOAD_PROFILE_LEARN_GAIN_V_PER_A, 0.0f, LOAD_PROFILE_SETTLE_US);
+static portMUX_TYPE profilePlayerMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t profileTimer = nullptr;
+// One-shot per step, learnDelayUs() after its edge: asks the acquisition task
+// for a read the step can learn from, whatever the sample interval
+static esp_timer_handle_t profileSettleTimer = nullptr;
+static std::atomic<bool> acqSettleReadPending{false};
+// Edge and settle wakes of the acquisition task, which must not be counted
+// as sample ticks
+static std::atomic<uint32_t> acqProfileWakes{0};
+// Channel 0 current per profile step over the test (UI loop)
+static RunningStats profileStepStats[LOAD_PROFILE_MAX_STEPS];
+
+// Owned by the control task once it starts; setup loads it from NVS first.
+// The control task hands copies to the UI loop, which does the NVS write.
+static load_calibration_t loadCalibration = {};
+static load_calibration_t loadCalibrationToSave = {};
+static portMUX_TYPE loadCalibrationMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<bool> loadCalibrationDirty{false};
+static std::atomic<bool> loadCalibrationRequested{false};
+
+// Cutoff and overtemp are enforced on the acquisition task as each reading
+// arrives: a trip zeroes the load DAC inline, ahead of every queued job, so the load
+// is off within one sample interval plus this budget of the crossing.
+static constexpr uint32_t SAFETY_SHUTDOWN_BUDGET_US = 2000;
+// Owned by the acquisition task. The UI loop arms it and sets the limits
+// through the atomics and reads the latched trip back from the snapshot.
+static SafetySupervisor safety(SAFETY_SHUTDOWN_BUDGET_US);
+static std::atomic<bool> safetyArmed{false};
+static std::atomic<uint32_t> safetyArmCount{0};  // bumped by every test start
+static uint32_t safetyAppliedArmCount = 0;       // acquisition task
+static std::atomic<float> safetyCutoffV{0.0f};
+static std::atomic<float> safetyOvertempC{0.0f};
+// Raised before the DAC is zeroed; every later non-zero write is refused
+// until the next test arms the supervisor again.
+static std::atomic<bool> safetyLatched{false};
+static safety_trip_t safetySnapshot = {SafetyTrip::None, 0.0f, 0.0f, 0, 0};
+static portMUX_TYPE safetyMux = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t safetyTripLoggedUs = 0;  // UI loop
+static uint64_t safetyPendingLoggedUs = 0;
+
+// The INA226 full-scale shunt voltage is 81.92 mV, so these give the 1 A and
+// 10 A ranges the two units are sold as.
+static constexpr float INA226_1A_SHUNT_OHMS = 0.08f;
+static constexpr float INA226_10A_SHUNT_OHMS = 0.008f;
+static constexpr float INA226_1A_FULL_SCALE_A = 32767.0f * INA226_SHUNT_LSB_V / INA226_1A_SHUNT_OHMS;
+// Leave the 1A unit at 90% of its full scale, return below 70% after 3
+// consecutive samples.
+static constexpr float AUTO_RANGE_UP_FRACTION = 0.9f;
+static constexpr float AUTO_RANGE_DOWN_FRACTION = 0.7f;
+static constexpr uint8_t AUTO_RANGE_DOWN_DWELL = 3;
+static AutoRange autoRange(INA226_1A_FULL_SCALE_A, AUTO_RANGE_UP_FRACTION, AUTO_RANGE_DOWN_FRACTION, AUTO_RANGE_DOWN_DWELL);
+static std::atomic<uint32_t> acqRangeSwitches{0};
+static bool lastSampleFineRange = false;  // UI loop
+
 static constexpr const char *PREF_NAMESPACE = "energy_cfg";
 
+// The acquisition task runs on the core the Arduino loop (and LVGL) does not use
+#if CONFIG_FREERTOS_UNICORE
+static constexpr BaseType_t ACQ_TASK_CORE = 0;
+#else
+static constexpr BaseType_t ACQ_TASK_CORE = (ARDUINO_RUNNING_CORE == 0) ? 1 : 0;
+#endif
+static constexpr uint32_t ACQ_TASK_STACK = 6144;
+static constexpr UBaseType_t ACQ_TASK_PRIORITY = 5;
+
+static const char *deviceName(uint8_t device)
+{
+  switch (device) {
+    case DEVICE_INA226_1A:
+      return "INA226-1A";
+    case DEVICE_INA226_10A:
+      return "INA226-10A";
+    case DEVICE_THERMOCOUPLE:
+      return "Load Thermocouple";
+    case DEVICE_INA3221:
+      return "INA3221";
+    case DEVICE_INA228:
+      return "INA228";
+    case DEVICE_AD5693R:
+      return "AD5693R";
+    case DEVICE_DAC2:
+    default:
+      return "DAC2";
+  }
+}
+
+static const char *deviceStatusText(LinkState state)
+{
+  switch (state) {
+    case LinkState::Ready:
+      return "Connected";
+    case LinkState::Probing:
+      return "Probing";
+    case LinkState::Faulted:
+      return "Fault, retrying";
+    case LinkState::Absent:
+    default:
+      return "Not Connected";
+  }
+}
+
+// UI loop only; rebuilt when a device event arrives.
 static void publishSensorStatus(void)
 {
-  char status[192];
+  char status[256];
   snprintf(status, sizeof(status),
            "INA226-1A: %s\n"
            "INA226-10A: %s\n"
            "Load Thermocouple: %s\n"
-           "DAC2: %s",
-           sensor1AReady ? "Connected" : "Not Connected",
-           sensor10AReady ? "Connected" : "Not Connected",
-           loadTempPresent ? "Connected" : "Not Connected",
-           dacPresent ? "Connected" : "Not Connected");
+           "DAC2: %s\n"
+           "AD5693R: %s\n"
+           "INA3221: %s\n"
+           "INA228: %s",
+           deviceStatusText(deviceStatus[DEVICE_INA226_1A]),
+           deviceStatusText(deviceStatus[DEVICE_INA226_10A]),
+           deviceStatusText(deviceStatus[DEVICE_THERMOCOUPLE]),
+           deviceStatusText(deviceStatus[DEVICE_DAC2]),
+           deviceStatusText(deviceStatus[DEVICE_AD5693R]),
+           deviceStatusText(deviceStatus[DEVICE_INA3221]),
+           deviceStatusText(deviceStatus[DEVICE_INA228]));
   ui_set_sensor_status(status);
 }
 
@@ -94,7 +499,9 @@ static void sanitizeConfig(ui_config_t *config)
     return;
   }
 
-  if (config->sensor_type != UI_SENSOR_INA226_1A && config->sensor_type != UI_SENSOR_INA226_10A) {
+  if (config->sensor_type != UI_SENSOR_INA226_1A && config->sensor_type != UI_SENSOR_INA226_10A &&
+      config->sensor_type != UI_SENSOR_AUTO_RANGE && config->sensor_type != UI_SENSOR_INA3221 &&
+      config->sensor_type != UI_SENSOR_INA228) {
     config->sensor_type = UI_SENSOR_INA226_1A;
   }
 
@@ -109,6 +516,13 @@ static void sanitizeConfig(ui_config_t *config)
     config->sample_interval_ms = 2000;
   }
 
+  if (config->temp_interval_ms < 250) {
+    config->temp_interval_ms = 250;
+  }
+  if (config->temp_interval_ms > 10000) {
+    config->temp_interval_ms = 10000;
+  }
+
   if (config->cutoff_voltage_v < 1.0f) {
     config->cutoff_voltage_v = 1.0f;
   }
@@ -149,6 +563,46 @@ static void sanitizeConfig(ui_config_t *config)
   if (config->num_series_cells > 30) {
     config->num_series_cells = 30;
   }
+
+  if (config->ina_preset < UI_INA_PRESET_FAST_TRANSIENT || config->ina_preset > UI_INA_PRESET_LOW_NOISE) {
+    config->ina_preset = UI_INA_PRESET_BALANCED;
+  }
+  config->ina_avg_code &= 0x7;
+  config->ina_vbus_ct_code &= 0x7;
+  config->ina_vshunt_ct_code &= 0x7;
+
+  if (config->trigger_source != UI_TRIGGER_SOURCE_CURRENT && config->trigger_source != UI_TRIGGER_SOURCE_VOLTAGE) {
+    config->trigger_source = UI_TRIGGER_SOURCE_CURRENT;
+  }
+  if (config->trigger_mode < UI_TRIGGER_RISING_EDGE || config->trigger_mode > UI_TRIGGER_BELOW_LEVEL) {
+    config->trigger_mode = UI_TRIGGER_RISING_EDGE;
+  }
+  if (isnan(config->load_current_a) || config->load_current_a < 0.0f) {
+    config->load_current_a = 0.0f;
+  }
+  if (config->load_current_a > LOAD_MAX_CURRENT_A) {
+    config->load_current_a = LOAD_MAX_CURRENT_A;
+  }
+  if (isnan(config->load_power_w) || config->load_power_w < 0.0f) {
+    config->load_power_w = 0.0f;
+  }
+  if (config->load_power_w > LOAD_MAX_POWER_W) {
+    config->load_power_w = LOAD_MAX_POWER_W;
+  }
+  if (isnan(config->load_resistance_ohm) || config->load_resistance_ohm < LOAD_MIN_RESISTANCE_OHM) {
+    config->load_resistance_ohm = LOAD_MIN_RESISTANCE_OHM;
+  }
+  if (config->load_resistance_ohm > LOAD_MAX_RESISTANCE_OHM) {
+    config->load_resistance_ohm = LOAD_MAX_RESISTANCE_OHM;
+  }
+
+  float maxTriggerLevel = (config->trigger_source == UI_TRIGGER_SOURCE_VOLTAGE) ? 36.0f : 10000.0f;
+  if (isnan(config->trigger_level) || config->trigger_level < 0.0f) {
+    config->trigger_level = 0.0f;
+  }
+  if (config->trigger_level > maxTriggerLevel) {
+    config->trigger_level = maxTriggerLevel;
+  }
 }
 
 static void saveConfigToNvs(const ui_config_t *config)
@@ -167,6 +621,17 @@ static void saveConfigToNvs(const ui_config_t *config)
   preferences.putFloat("overtemp", config->overtemp_cutoff_c);
   preferences.putFloat("ampacity", config->rated_battery_ampacity_ah);
   preferences.putUChar("cells", config->num_series_cells);
+  preferences.putUChar("inapreset", (uint8_t)config->ina_preset);
+  preferences.putUChar("inaavg", config->ina_avg_code);
+  preferences.putUChar("inavbusct", config->ina_vbus_ct_code);
+  preferences.putUChar("inavshct", config->ina_vshunt_ct_code);
+  preferences.putUChar("trigsrc", (uint8_t)config->trigger_source);
+  preferences.putUChar("trigmode", (uint8_t)config->trigger_mode);
+  preferences.putFloat("triglevel", config->trigger_level);
+  preferences.putUShort("tempint", config->temp_interval_ms);
+  preferences.putFloat("loadcur", config->load_current_a);
+  preferences.putFloat("loadpow", config->load_power_w);
+  preferences.putFloat("loadres", config->load_resistance_ohm);
 }
 
 static void loadConfigFromNvs(ui_config_t *config)
@@ -185,356 +650,2545 @@ static void loadConfigFromNvs(ui_config_t *config)
   config->overtemp_cutoff_c = preferences.getFloat("overtemp", config->overtemp_cutoff_c);
   config->rated_battery_ampacity_ah = preferences.getFloat("ampacity", config->rated_battery_ampacity_ah);
   config->num_series_cells = preferences.getUChar("cells", config->num_series_cells);
+  config->ina_preset = (ui_ina_preset_t)preferences.getUChar("inapreset", (uint8_t)config->ina_preset);
+  config->ina_avg_code = preferences.getUChar("inaavg", config->ina_avg_code);
+  config->ina_vbus_ct_code = preferences.getUChar("inavbusct", config->ina_vbus_ct_code);
+  config->ina_vshunt_ct_code = preferences.getUChar("inavshct", config->ina_vshunt_ct_code);
+  config->trigger_source = (ui_trigger_source_t)preferences.getUChar("trigsrc", (uint8_t)config->trigger_source);
+  config->trigger_mode = (ui_trigger_mode_t)preferences.getUChar("trigmode", (uint8_t)config->trigger_mode);
+  config->trigger_level = preferences.getFloat("triglevel", config->trigger_level);
+  config->temp_interval_ms = preferences.getUShort("tempint", config->temp_interval_ms);
+  config->load_current_a = preferences.getFloat("loadcur", config->load_current_a);
+  config->load_power_w = preferences.getFloat("loadpow", config->load_power_w);
+  config->load_resistance_ohm = preferences.getFloat("loadres", config->load_resistance_ohm);
 
   sanitizeConfig(config);
 }
 
-static float celsiusToFahrenheit(float celsius)
+// UI loop: parse and validate a profile, hand it to the control task and
+// show it on the config screen; persist saves the text to NVS as well.
+static bool setLoadProfileText(const char *text, bool persist)
 {
-  return (celsius * 9.0f / 5.0f) + 32.0f;
-}
+  if (strlen(text) >= LOAD_PROFILE_TEXT_MAX) {
+    Serial.println("Load profile rejected: text too long.");
+    return false;
+  }
 
-static void setSensorPresent(bool present)
-{
-  sensorPresent = present;
-  publishSensorStatus();
-}
+  load_profile_t profile;
+  size_t errorStep = 0;
+  LoadProfileError error = parseLoadProfile(text, LOAD_MAX_CURRENT_A, &profile, &errorStep);
+  if (error != LoadProfileError::None) {
+    Serial.printf("Load profile rejected at step %u: %s.\n", (unsigned)(errorStep + 1), loadProfileErrorText(error));
+    return false;
+  }
 
-static const char *sensorTypeName(ui_sensor_type_t sensorType)
-{
-  return sensorType == UI_SENSOR_INA226_10A ? "INA226-10A" : "INA226-1A";
+  portENTER_CRITICAL(&loadProfileMux);
+  loadProfile = profile;
+  portEXIT_CRITICAL(&loadProfileMux);
+  snprintf(loadProfileText, sizeof(loadProfileText), "%s", text);
+  loadProfileRevision.fetch_add(1);
+  if (persist) {
+    preferences.putString("profile", text);
+  }
+
+  char summary[32];
+  snprintf(summary, sizeof(summary), "%u steps, %.3f s", (unsigned)profile.count,
+           loadProfilePeriodUs(profile) / 1000000.0);
+  ui_set_load_profile_summary(summary);
+  return true;
 }
 
-static bool initializeINA226_1A()
+static void loadProfileFromNvs(void)
 {
-  if (sensor1AReady) {
-    return true;
+  char text[LOAD_PROFILE_TEXT_MAX];
+  if (!preferences.isKey("profile") || preferences.getString("profile", text, sizeof(text)) == 0) {
+    (void)setLoadProfileText(DEFAULT_LOAD_PROFILE, false);
+    return;
   }
-  if (!meterUnits1A.add(ina226_1a, Wire)) {
-    return false;
+  if (!setLoadProfileText(text, false)) {
+    Serial.println("Stored load profile is invalid, using the default.");
+    (void)setLoadProfileText(DEFAULT_LOAD_PROFILE, false);
   }
-  sensor1AReady = meterUnits1A.begin();
-  return sensor1AReady;
 }
 
-static bool initializeINA226_10A()
+static void logLoadCalibration(const load_calibration_t &calibration)
 {
-  if (sensor10AReady) {
-    return true;
+  if (calibration.count < 2) {
+    Serial.println("Load calibration: none, the loop runs on PI alone.");
+    return;
   }
-  if (!meterUnits10A.add(ina226_10a, Wire)) {
-    return false;
+  Serial.printf("Load calibration: %u points to %.3fA:", (unsigned)calibration.count, calibration.max_current_a);
+  for (uint8_t k = 0; k < calibration.count; k++) {
+    Serial.printf(" %.3f", calibration.volts[k]);
   }
-  sensor10AReady = meterUnits10A.begin();
-  return sensor10AReady;
+  Serial.println(" V");
 }
 
-static bool initializeLoadThermocouple()
+static void loadCalibrationFromNvs(void)
 {
-  if (loadTempPresent) {
-    return true;
-  }
-  if (!thermoUnits.add(loadThermocouple, Wire)) {
-    return false;
+  load_calibration_t calibration = {};
+  if (preferences.isKey("loadcal") && preferences.getBytesLength("loadcal") == sizeof(calibration) &&
+      preferences.getBytes("loadcal", &calibration, sizeof(calibration)) == sizeof(calibration) &&
+      validateLoadCalibration(calibration)) {
+    loadCalibration = calibration;
+  } else {
+    loadCalibration = {};
   }
-  loadTempPresent = thermoUnits.begin();
-  return loadTempPresent;
+  logLoadCalibration(loadCalibration);
 }
 
-static bool initializeDAC2()
+// Control task: hand the map to the UI loop for saving.
+static void publishLoadCalibration(void)
 {
-  if (dacPresent) {
-    return true;
+  portENTER_CRITICAL(&loadCalibrationMux);
+  loadCalibrationToSave = loadCalibration;
+  portEXIT_CRITICAL(&loadCalibrationMux);
+  loadCalibrationDirty = true;
+}
+
+// UI loop.
+static void saveLoadCalibration(void)
+{
+  if (!loadCalibrationDirty.exchange(false)) {
+    return;
   }
+  load_calibration_t calibration;
+  portENTER_CRITICAL(&loadCalibrationMux);
+  calibration = loadCalibrationToSave;
+  portEXIT_CRITICAL(&loadCalibrationMux);
+  preferences.putBytes("loadcal", &calibration, sizeof(calibration));
+}
 
-  auto cfg = dac2.config();
-  cfg.range0 = m5::unit::gp8413::Output::Range10V;
-  cfg.range1 = m5::unit::gp8413::Output::Range10V;
-  dac2.config(cfg);
+// UI loop: line commands on the serial port. "profile 10ms 2A, 990ms 5mA"
+// replaces the pulsed-load profile; "profile" alone prints the current one.
+// "calibrate" sweeps the load stage; it needs a running test so the source
+// is connected and the safety limits are armed.
+static void handleSerialCommands(void)
+{
+  static char line[LOAD_PROFILE_TEXT_MAX + 16];
+  static size_t length = 0;
+  static bool overflowed = false;
+
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == '\r') {
+      continue;
+    }
+    if (c != '\n') {
+      if (length < sizeof(line) - 1) {
+        line[length++] = (char)c;
+      } else {
+        overflowed = true;
+      }
+      continue;
+    }
 
-  if (!anadigUnits.add(dac2, Wire)) {
-    Serial.println("DAC2 add() failed.");
-    return false;
-  }
+    line[length] = '\0';
+    bool tooLong = overflowed;
+    length = 0;
+    overflowed = false;
+    if (tooLong) {
+      Serial.println("Command too long, ignored.");
+      continue;
+    }
 
-  dacPresent = anadigUnits.begin();
-  if (!dacPresent) {
-    Serial.println("DAC2 begin() failed.");
-    return false;
+    if (strncmp(line, "profile", 7) == 0 && (line[7] == '\0' || line[7] == ' ')) {
+      const char *steps = line + 7;
+      while (*steps == ' ') {
+        steps++;
+      }
+      if (*steps == '\0') {
+        Serial.printf("Load profile: %s\n", loadProfileText);
+      } else if (setLoadProfileText(steps, true)) {
+        Serial.printf("Load profile set: %s\n", loadProfileText);
+      }
+    } else if (strcmp(line, "calibrate") == 0) {
+      if (!loadEnabled.load()) {
+        Serial.println("Load calibration needs the load on: start a test with the source connected.");
+      } else {
+        loadCalibrationRequested = true;
+      }
+    } else if (line[0] != '\0') {
+      Serial.printf("Unknown command: %s\n", line);
+    }
   }
-
-  return true;
 }
 
-static void applyDacTestPattern()
+static float celsiusToFahrenheit(float celsius)
 {
-  if (!dacPresent) {
-    return;
-  }
-
-  constexpr float ch0_test_mv = 1500.0f;
-  constexpr float ch1_test_mv = 8500.0f;
+  return (celsius * 9.0f / 5.0f) + 32.0f;
+}
 
-  bool wrote = dac2.writeBothVoltage(ch0_test_mv, ch1_test_mv);
-  if (wrote) {
-    Serial.printf("DAC2 test output set: CH0=%.3fV CH1=%.3fV (Range 0-10V).\n", ch0_test_mv / 1000.0f, ch1_test_mv / 1000.0f);
-    Serial.println("DAC2 is unipolar only; negative voltage output is not supported by this hardware.");
-  } else {
-    Serial.println("DAC2 write failed.");
+static const char *sensorTypeName(ui_sensor_type_t sensorType)
+{
+  switch (sensorType) {
+    case UI_SENSOR_INA226_10A:
+      return "INA226-10A";
+    case UI_SENSOR_AUTO_RANGE:
+      return "Auto Range";
+    case UI_SENSOR_INA3221:
+      return "INA3221";
+    case UI_SENSOR_INA228:
+      return "INA228";
+    case UI_SENSOR_INA226_1A:
+    default:
+      return "INA226-1A";
   }
 }
 
-static void applySensorSelection(void)
+static const char *inaPresetName(ui_ina_preset_t preset)
 {
-  if (runtimeConfig.sensor_type == UI_SENSOR_INA226_10A) {
-    activeIna226 = &ina226_10a;
-    activeMeterUnits = &meterUnits10A;
-    setSensorPresent(sensor10AReady);
-  } else {
-    activeIna226 = &ina226_1a;
-    activeMeterUnits = &meterUnits1A;
-    setSensorPresent(sensor1AReady);
+  switch (preset) {
+    case UI_INA_PRESET_FAST_TRANSIENT:
+      return "Fast Transient";
+    case UI_INA_PRESET_LOW_NOISE:
+      return "Low Noise";
+    case UI_INA_PRESET_BALANCED:
+    default:
+      return "Balanced";
   }
 }
 
-static void applyUiConfig(const ui_config_t *config)
+static uint16_t ina226ConfigFor(const ui_config_t *config)
 {
-  if (config == nullptr) {
-    return;
-  }
+  return ina226_config_value(config->ina_avg_code, config->ina_vbus_ct_code, config->ina_vshunt_ct_code);
+}
 
-  bool sensorChanged = (runtimeConfig.sensor_type != config->sensor_type);
-  runtimeConfig = *config;
+// Fresh INA226 data arrives at the slower of the conversion rate and the
+// rate we read it: the sample timer, or in conversion-ready mode the bus
+// time one read takes.
+static float effectiveSampleRateHz(const ui_config_t *config, bool conversionReady, uint32_t bytesPerSample)
+{
+  uint32_t conversionUs = ina226_config_period_us(ina226ConfigFor(config));
+  float conversionHz = 1000000.0f / (float)conversionUs;
 
-  sanitizeConfig(&runtimeConfig);
+  float readHz = 1000.0f / (float)config->sample_interval_ms;
+  if (conversionReady) {
+    // 9 clocks per byte on a 400 kHz bus
+    readHz = (bytesPerSample > 0) ? 400000.0f / (9.0f * (float)bytesPerSample) : conversionHz;
+  }
 
-  applySensorSelection();
-  saveConfigToNvs(&runtimeConfig);
+  return conversionHz < readHz ? conversionHz : readHz;
+}
 
-  if (sensorChanged) {
-    lastSampleMs = 0;
-    cutoffReached = false;
-    overtempReached = false;
-    Serial.printf("Sensor type changed to %s\n", sensorTypeName(runtimeConfig.sensor_type));
-  }
+static void logIna226Preset(const ui_config_t *config)
+{
+  uint32_t conversionUs = ina226_config_period_us(ina226ConfigFor(config));
+  Serial.printf("INA226 preset %s: AVG %u, VBUS %uus, VSHUNT %uus -> %.1f Hz conversions, %.1f Hz effective\n",
+                inaPresetName(config->ina_preset),
+                (unsigned)ina226_avg_count(config->ina_avg_code),
+                (unsigned)ina226_conversion_time_us(config->ina_vbus_ct_code),
+                (unsigned)ina226_conversion_time_us(config->ina_vshunt_ct_code),
+                1000000.0f / (float)conversionUs,
+                effectiveSampleRateHz(config, INA226_ALERT_PIN >= 0, acqBytesPerSample));
 }
 
-static float readLoadTempConfiguredUnits(uint32_t nowMs)
+// UnitUnified registers a unit for good on add(), so that only happens
+// once; a re-probe after a fault just repeats begin().
+static bool bringUpUnit(m5::unit::UnitUnified &units, m5::unit::Component &unit, uint8_t device)
 {
-  if (!loadTempPresent && (nowMs - lastLoadTempRetryMs >= 2000)) {
-    lastLoadTempRetryMs = nowMs;
-    loadTempPresent = initializeLoadThermocouple();
-    if (loadTempPresent) {
-      Serial.println("Load thermocouple detected and initialized.");
-    } else {
-      Serial.println("Load thermocouple not detected.");
+  if (!deviceUnitAdded[device]) {
+    if (!units.add(unit, Wire)) {
+      return false;
     }
+    deviceUnitAdded[device] = true;
   }
+  return units.begin();
+}
 
-  if (!loadTempPresent) {
-    return NAN;
-  }
-
-  thermoUnits.update();
-  float tempC = loadThermocouple.temperature();
-  if (isnan(tempC)) {
-    loadTempPresent = false;
-    Serial.println("Load thermocouple read failed.");
-    return NAN;
+static bool bringUpDevice(uint8_t device)
+{
+  switch (device) {
+    case DEVICE_INA226_1A:
+      return bringUpUnit(meterUnits1A, ina226_1a, device);
+    case DEVICE_INA226_10A:
+      return bringUpUnit(meterUnits10A, ina226_10a, device);
+    case DEVICE_THERMOCOUPLE:
+      return bringUpUnit(thermoUnits, loadThermocouple, device);
+    case DEVICE_DAC2:
+      return gp8413Dac.begin(&externalBus, DAC_ADDRESS);
+    case DEVICE_AD5693R:
+      return ad5693rDac.begin(&externalBus, AD5693R_ADDRESS, AD5693R_GAIN_2X);
+    case DEVICE_INA3221:
+      return ina3221Driver.begin(&externalBus, INA3221_ADDRESS, INA3221_SHUNT_OHMS);
+    case DEVICE_INA228:
+      return ina228Driver.begin(&externalBus, INA228_ADDRESS, INA228_SHUNT_OHMS, INA228_MAX_CURRENT_A);
+    default:
+      return false;
   }
+}
 
-  if (runtimeConfig.units == UI_UNITS_METRIC) {
-    return tempC;
+static uint8_t deviceAddress(uint8_t device)
+{
+  switch (device) {
+    case DEVICE_INA226_1A:
+      return ina226_1a.address();
+    case DEVICE_INA226_10A:
+      return ina226_10a.address();
+    case DEVICE_THERMOCOUPLE:
+      return loadThermocouple.address();
+    case DEVICE_INA3221:
+      return INA3221_ADDRESS;
+    case DEVICE_INA228:
+      return INA228_ADDRESS;
+    case DEVICE_AD5693R:
+      return AD5693R_ADDRESS;
+    case DEVICE_DAC2:
+    default:
+      return DAC_ADDRESS;
   }
-
-  return celsiusToFahrenheit(tempC);
 }
 
-static void updateEnergyAndUi()
+// A zero-length write: the device either ACKs its address or it does not.
+static bool deviceAcks(uint8_t device)
 {
-  uint32_t nowMs = millis();
-  uint32_t deltaMs = (lastSampleMs == 0) ? 0 : (nowMs - lastSampleMs);
-  float deltaHours = (float)deltaMs / 3600000.0f;
+  Wire.beginTransmission(deviceAddress(device));
+  return Wire.endTransmission() == 0;
+}
 
-  if (ui_consume_start_request(0)) {
-    energyWh = 0.0f;
-    testRunning = true;
-    lastSampleMs = nowMs;
-    cutoffReached = false;
-    overtempReached = false;
-    channelData.energy_wh = 0.0f;
-    ui_set_test_running(true);
+// Hand a link's settled state to the UI loop when it differs from the last
+// one sent. Probe rounds that end where they started raise no event, so an
+// empty port stays quiet however often it is retried.
+static void publishLinkState(uint8_t device)
+{
+  LinkState state = deviceLinks[device].state();
+  if (state != LinkState::Probing && state != devicePublished[device]) {
+    devicePublished[device] = state;
+    device_event_t event = {device, state};
+    (void)deviceEvents.push(event);
   }
+}
 
-  if (ui_consume_stop_request(0)) {
-    testRunning = false;
-    lastSampleMs = nowMs;
-    ui_set_test_running(false);
-  }
+static void faultDevice(uint8_t device)
+{
+  deviceLinks[device].fault(millis());
+  publishLinkState(device);
+}
 
-  if (ui_consume_reset_request(0)) {
-    energyWh = 0.0f;
-    testRunning = false;
-    cutoffReached = false;
-    overtempReached = false;
-    lastSampleMs = nowMs;
-    deltaMs = 0;
-    deltaHours = 0.0f;
-    ui_set_test_running(false);
+static uint8_t activeDeviceId(void)
+{
+  if (ina3221Mode) {
+    return DEVICE_INA3221;
   }
-
-  if (!testRunning) {
-    return;
+  if (ina228Mode) {
+    return DEVICE_INA228;
   }
+  return (activeIna226 == &ina226_10a) ? DEVICE_INA226_10A : DEVICE_INA226_1A;
+}
+
+static bool activeSensorReady(void)
+{
+  return deviceLinks[activeDeviceId()].ready();
+}
 
-  float loadTemp = readLoadTempConfiguredUnits(nowMs);
+static uint8_t loadDacDevice(const LoadDac *dac)
+{
+  return (dac == &ad5693rDac) ? DEVICE_AD5693R : DEVICE_DAC2;
+}
 
-  if (!sensorPresent || activeMeterUnits == nullptr || activeIna226 == nullptr) {
-    channelData.voltage_v = 0.0f;
-    channelData.current_ma = 0.0f;
-    channelData.power_w = 0.0f;
-    channelData.energy_wh = energyWh;
-    channelData.load_temp_f = loadTemp;
-    ui_set_channel_data(0, &channelData);
-    lastSampleMs = nowMs;
+// Bus owner: make the best DAC whose link is up the active one. A DAC is
+// brought up at zero, so switching never carries an old level across.
+static void selectLoadDac(void)
+{
+  LoadDac *dac = nullptr;
+  if (deviceLinks[DEVICE_AD5693R].ready()) {
+    dac = &ad5693rDac;
+  } else if (deviceLinks[DEVICE_DAC2].ready()) {
+    dac = &gp8413Dac;
+  }
+  if (dac == loadDac.load()) {
     return;
   }
 
-  activeMeterUnits->update();
-
-  float voltageV = activeIna226->voltage() / 1000.0f;
-  float currentA = activeIna226->current() / 1000.0f;
-
-  if (isnan(voltageV) || isnan(currentA)) {
-    setSensorPresent(false);
-    Serial.println("INA226 read failed, sensor unavailable.");
-    lastSampleMs = nowMs;
+  loadDac = dac;
+  if (dac == nullptr) {
+    Serial.println("Load DAC: none connected, load disabled.");
     return;
   }
+  Serial.printf("Load DAC: %s, %u-bit over 0-%.1fV (%.3fmV per step).\n", dac->name(), (unsigned)dac->bits(),
+                dac->fullScaleV(), dac->lsbV() * 1000.0f);
+}
 
-  if (!cutoffReached && voltageV <= runtimeConfig.cutoff_voltage_v) {
-    cutoffReached = true;
-    Serial.printf("Cutoff reached at %.3fV (configured %.3fV).\n", voltageV, runtimeConfig.cutoff_voltage_v);
+// Latest requested load output. Writers store it and make sure one write
+// job is queued; the job sends whatever is latest when it runs, so any
+// number of updates between bus slots cost a single transaction. While a
+// profile plays, its active step's level, read at that same moment, takes
+// the place of the request, so an edge and a correction queued just before
+// it can never leave the previous step's level on the DAC.
+static std::atomic<float> loadOutputRequestV{0.0f};
+static std::atomic<bool> loadDacJobQueued{false};
+
+// Bus owner.
+static bool runLoadDacWrite(const i2c_job_t *job)
+{
+  (void)job;
+  // Cleared first: an update from here on needs a job of its own
+  loadDacJobQueued = false;
+  LoadDac *dac = loadDac.load();
+  if (dac == nullptr) {
+    return true;
   }
 
-  // Check for overtemp cutoff (temperature is already in correct units)
-  if (!isnan(loadTemp) && !overtempReached) {
-    float tempC = (runtimeConfig.units == UI_UNITS_METRIC) ? loadTemp : (loadTemp - 32.0f) * 5.0f / 9.0f;
-    if (tempC >= runtimeConfig.overtemp_cutoff_c) {
-      overtempReached = true;
-      Serial.printf("Overtemp cutoff reached at %.1fC (configured %.1fC).\n", tempC, runtimeConfig.overtemp_cutoff_c);
-    }
+  // Under the mux start() rewrites the profile with, so a step index from one
+  // run never picks its level out of the next, or out of a half-copied one
+  float outputV = loadOutputRequestV.load();
+  portENTER_CRITICAL(&profilePlayerMux);
+  uint8_t step = profilePlayer.step();
+  if (step != LOAD_PROFILE_NO_STEP) {
+    outputV = profilePlayer.outputV(step);
   }
-
-  float powerW = voltageV * currentA;
-  if (testRunning && !cutoffReached && !overtempReached && deltaMs > 0) {
-    energyWh += powerW * deltaHours;
+  portEXIT_CRITICAL(&profilePlayerMux);
+  if (safetyLatched) {
+    outputV = 0.0f;
   }
+  return dac->writeLoadCode(dac->codeFor(outputV));
+}
 
-  channelData.voltage_v = voltageV;
-  channelData.current_ma = currentA * 1000.0f;
-  channelData.power_w = powerW;
-  channelData.energy_wh = energyWh;
-  channelData.load_temp_f = loadTemp;
-
-  ui_set_channel_data(0, &channelData);
-  lastSampleMs = nowMs;
+// Load writes run many times a second; only failures are worth a line.
+static void onLoadDacWriteDone(const i2c_job_t *job, bool ok)
+{
+  (void)job;
+  LoadDac *dac = loadDac.load();
+  if (ok || dac == nullptr) {
+    return;
+  }
+  Serial.printf("%s write failed.\n", dac->name());
+  faultDevice(loadDacDevice(dac));
+  selectLoadDac();
 }
 
-void lv_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+// Any task, including the profile edge timer: make sure a write is queued.
+static bool queueLoadDacWrite(void)
 {
-  uint32_t w = (area->x2 - area->x1 + 1);
-  uint32_t h = (area->y2 - area->y1 + 1);
-  display.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
-  lv_disp_flush_ready(disp);
+  if (loadDacJobQueued.exchange(true)) {
+    return true;
+  }
+  i2c_job_t job = {};
+  job.run = runLoadDacWrite;
+  job.done = onLoadDacWriteDone;
+  job.estimated_us = DAC_WRITE_US;
+  if (!busQueue.submit(DAC_I2C_PRIORITY, job)) {
+    loadDacJobQueued = false;
+    return false;
+  }
+  return true;
 }
 
-static void lv_indev_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+// Any task.
+static bool requestLoadOutput(float volts)
 {
-  (void)indev_driver;
+  loadOutputRequestV = volts;
+  return queueLoadDacWrite();
+}
 
-  lgfx::touch_point_t tp[3];
-  uint8_t touchpad = display.getTouch(tp, 3);
-  if (touchpad > 0) {
-    data->state = LV_INDEV_STATE_PR;
-    data->point.x = tp[0].x;
-    data->point.y = tp[0].y;
-  } else {
-    data->state = LV_INDEV_STATE_REL;
+// Acquisition task: the profile step active at timestampUs and how far into
+// it the read began. A read that began just before an edge is given offset
+// 0, which is inside the settle time and so never learned from.
+static uint8_t profileStepAt(uint64_t timestampUs, uint32_t *offsetUs)
+{
+  uint8_t step;
+  uint64_t startUs;
+  *offsetUs = 0;
+  if (!profilePlayer.activeStep(&step, &startUs)) {
+    return LOAD_PROFILE_NO_STEP;
   }
+  if (timestampUs > startUs) {
+    uint64_t offset = timestampUs - startUs;
+    *offsetUs = offset > UINT32_MAX ? UINT32_MAX : (uint32_t)offset;
+  }
+  return step;
+}
 
-  data->continue_reading = false;
+// Acquisition task: hand the latest channel 0 reading to the load controller
+// and, while a profile plays, to the step it was taken in.
+static void publishLoadReading(uint64_t timestampUs, float voltageV, float currentA, uint8_t profileStep,
+                               uint32_t profileOffsetUs)
+{
+  portENTER_CRITICAL(&loadMeasurementMux);
+  loadMeasurement.voltage_v = voltageV;
+  loadMeasurement.current_a = currentA;
+  loadMeasurement.timestamp_us = timestampUs;
+  portEXIT_CRITICAL(&loadMeasurementMux);
+
+  if (profileStep != LOAD_PROFILE_NO_STEP) {
+    portENTER_CRITICAL(&profilePlayerMux);
+    (void)profilePlayer.record(profileStep, profileOffsetUs, currentA);
+    portEXIT_CRITICAL(&profilePlayerMux);
+  }
 }
 
-void setup()
+static void publishSafetySnapshot(void)
 {
-  display.init();
-  Serial.begin(115200);
+  portENTER_CRITICAL(&safetyMux);
+  safetySnapshot = safety.trip();
+  portEXIT_CRITICAL(&safetyMux);
+}
 
-  if (!preferences.begin(PREF_NAMESPACE, false)) {
-    Serial.println("Failed to open NVS preferences namespace.");
+// Acquisition task: zero the load DAC directly, not through the queue.
+// Called on the trip and again every task pass until it succeeds. With no
+// DAC up there is nothing to zero: one that comes back is brought up at zero.
+static void shutdownLoadOutputs(void)
+{
+  if (!safety.shutdownPending()) {
+    return;
   }
-  loadConfigFromNvs(&runtimeConfig);
-  saveConfigToNvs(&runtimeConfig);
-
-  lv_init();
-  buf = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * LVGL_LCD_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-  lv_disp_draw_buf_init(&draw_buf, buf, NULL, LVGL_LCD_BUF_SIZE);
+  LoadDac *dac = loadDac.load();
+  if (dac != nullptr && !dac->writeLoadCode(0)) {
+    return;
+  }
+  safety.shutdownComplete((uint64_t)esp_timer_get_time());
+  publishSafetySnapshot();
+}
 
-  static lv_disp_drv_t disp_drv;
-  lv_disp_drv_init(&disp_drv);
-  disp_drv.hor_res = EXAMPLE_LCD_H_RES;
-  disp_drv.ver_res = EXAMPLE_LCD_V_RES;
-  disp_drv.flush_cb = lv_disp_flush;
-  disp_drv.draw_buf = &draw_buf;
-  disp_drv.sw_rotate = 0;
-  lv_disp_drv_register(&disp_drv);
+static void onSafetyTrip(void)
+{
+  safetyLatched = true;
+  shutdownLoadOutputs();
+  publishSafetySnapshot();
+}
 
-  static lv_indev_drv_t indev_drv;
-  lv_indev_drv_init(&indev_drv);
-  indev_drv.type = LV_INDEV_TYPE_POINTER;
-  indev_drv.read_cb = lv_indev_read;
-  lv_indev_drv_register(&indev_drv);
+// Acquisition task: check each channel 0 voltage the moment it is read.
+static void checkSafetyVoltage(float volts, uint64_t timestampUs)
+{
+  if (safety.checkVoltage(volts, timestampUs)) {
+    onSafetyTrip();
+  }
+}
 
-  ui_init();
-  ui_set_config(&runtimeConfig);
-  ui_set_test_running(false);
-  display.setBrightness(255);
+// Acquisition task, every pass: follow the UI's arm state and limits and
+// retry a shutdown write that failed. Each test start re-arms, which clears
+// the latch.
+static void serviceSafety(void)
+{
+  bool armed = safetyArmed.load();
+  uint32_t armCount = safetyArmCount.load();
+  if (armed && (armCount != safetyAppliedArmCount || !safety.armed())) {
+    safetyAppliedArmCount = armCount;
+    safety.arm(safetyCutoffV.load(), safetyOvertempC.load());
+    safetyLatched = false;
+    publishSafetySnapshot();
+  } else if (!armed && safety.armed()) {
+    safety.disarm();
+  }
+  safety.setLimits(safetyCutoffV.load(), safetyOvertempC.load());
+  shutdownLoadOutputs();
+}
 
-  Wire.begin(I2C_SDA, I2C_SCL, 400000U);
-  delay(1000);
+static const char *loadModeName(uint8_t mode)
+{
+  switch (mode) {
+    case UI_LOAD_CONSTANT_POWER:
+      return "CP";
+    case UI_LOAD_CONSTANT_IMPEDANCE:
+      return "CR";
+    case UI_LOAD_CONSTANT_CURRENT:
+    default:
+      return "CC";
+  }
+}
 
-  (void)initializeINA226_1A();
-  (void)initializeINA226_10A();
-  applySensorSelection();
+// Current the load should draw right now to hold the mode's setpoint.
+static float loadTargetCurrentA(uint8_t mode, float setpoint, float voltageV)
+{
+  float targetA;
+  switch (mode) {
+    case UI_LOAD_CONSTANT_POWER:
+      targetA = (voltageV >= LOAD_MIN_VOLTAGE_V) ? setpoint / voltageV : 0.0f;
+      break;
+    case UI_LOAD_CONSTANT_IMPEDANCE:
+      targetA = (voltageV > 0.0f) ? voltageV / setpoint : 0.0f;
+      break;
+    case UI_LOAD_CONSTANT_CURRENT:
+    default:
+      targetA = setpoint;
+      break;
+  }
+  return fminf(fmaxf(targetA, 0.0f), LOAD_MAX_CURRENT_A);
+}
 
-  if (!sensorPresent) {
-    Serial.printf("%s not found at startup, running without sensor data.\n", sensorTypeName(runtimeConfig.sensor_type));
+static void logStepResponse(uint8_t mode, const StepResponseMonitor &response)
+{
+  if (isnan(response.settlingS())) {
+    Serial.printf("%s load: step to %.3fA did not settle within %.1fs (overshoot %.1f%%).\n", loadModeName(mode),
+                  response.target(), LOAD_SETTLE_TIMEOUT_S, response.overshootFraction() * 100.0f);
   } else {
-    Serial.printf("%s initialized.\n", sensorTypeName(runtimeConfig.sensor_type));
+    Serial.printf("%s load: step to %.3fA settled in %.3fs, overshoot %.1f%%.\n", loadModeName(mode),
+                  response.target(), response.settlingS(), response.overshootFraction() * 100.0f);
   }
+}
 
-  if (initializeLoadThermocouple()) {
-    Serial.println("Load thermocouple initialized.");
-  } else {
-    Serial.println("Load thermocouple not found at startup.");
+// Edge timer and control task: time the active step's settle read from its
+// edge. Steps too short to hold one are left to their seeded level.
+static void scheduleSettleRead(void)
+{
+  uint8_t step;
+  uint64_t startUs;
+  if (profileSettleTimer == nullptr || !profilePlayer.activeStep(&step, &startUs) || !profilePlayer.learnable(step)) {
+    return;
   }
+  uint64_t readUs = startUs + profilePlayer.learnDelayUs();
+  uint64_t nowUs = (uint64_t)esp_timer_get_time();
+  (void)esp_timer_stop(profileSettleTimer);
+  (void)esp_timer_start_once(profileSettleTimer, readUs > nowUs ? readUs - nowUs : 1);
+}
 
-  if (initializeDAC2()) {
-    Serial.printf("DAC2 detected at expected I2C address 0x%02X.\n", DAC_ADDRESS);
-    applyDacTestPattern();
-  } else {
-    Serial.printf("DAC2 not detected at expected I2C address 0x%02X.\n", DAC_ADDRESS);
+// esp_timer callback: the active step's settle read is due.
+static void onProfileSettleTimer(void *arg)
+{
+  (void)arg;
+  if (acquisitionTaskHandle != nullptr) {
+    acqSettleReadPending = true;
+    acqProfileWakes.fetch_add(1);
+    xTaskNotifyGive(acquisitionTaskHandle);
   }
+}
 
-  publishSensorStatus();
+// esp_timer callback at each profile edge: step on, queue the new level and
+// wake the bus owner to write it now rather than at its next sample. The
+// next edge is timed from this one's schedule, not from now.
+static void onProfileTimer(void *arg)
+{
+  (void)arg;
+  portENTER_CRITICAL(&profilePlayerMux);
+  uint64_t edgeUs = profilePlayer.advance();
+  portEXIT_CRITICAL(&profilePlayerMux);
+  if (edgeUs == 0) {
+    return;
+  }
 
-  updateEnergyAndUi();
+  (void)queueLoadDacWrite();
+  scheduleSettleRead();
+  if (acquisitionTaskHandle != nullptr) {
+    acqProfileWakes.fetch_add(1);
+    xTaskNotifyGive(acquisitionTaskHandle);
+  }
+  uint64_t nowUs = (uint64_t)esp_timer_get_time();
+  (void)esp_timer_start_once(profileTimer, edgeUs > nowUs ? edgeUs - nowUs : 1);
 }
 
-void loop()
+// Control task. A callback already past its check when this stops the
+// player may still re-arm the timer once; that firing finds the player
+// stopped and ends there.
+static void stopLoadProfile(void)
 {
-  uint32_t now = millis();
+  portENTER_CRITICAL(&profilePlayerMux);
+  profilePlayer.stop();
+  portEXIT_CRITICAL(&profilePlayerMux);
+  if (profileTimer != nullptr) {
+    (void)esp_timer_stop(profileTimer);
+  }
+  if (profileSettleTimer != nullptr) {
+    (void)esp_timer_stop(profileSettleTimer);
+  }
+}
+
+// Control task: play the current profile from step 0.
+static bool startLoadProfile(uint64_t nowUs, float outputMaxV)
+{
+  if (profileTimer == nullptr) {
+    return false;
+  }
+
+  load_profile_t profile;
+  portENTER_CRITICAL(&loadProfileMux);
+  profile = loadProfile;
+  portEXIT_CRITICAL(&loadProfileMux);
+  if (profile.count == 0) {
+    return false;
+  }
+
+  stopLoadProfile();
+  portENTER_CRITICAL(&profilePlayerMux);
+  profilePlayer.setOutputMax(outputMaxV);
+  profilePlayer.start(profile, nowUs, LOAD_PROFILE_SEED_V_PER_A);
+  if (loadCalibration.count >= 2) {
+    for (uint8_t i = 0; i < profile.count; i++) {
+      profilePlayer.seedOutput(i, loadCalibrationVolts(loadCalibration, profile.steps[i].current_a));
+    }
+  }
+  uint64_t edgeUs = profilePlayer.nextEdgeUs();
+  portEXIT_CRITICAL(&profilePlayerMux);
+
+  (void)queueLoadDacWrite();
+  if (esp_timer_start_once(profileTimer, edgeUs - nowUs) != ESP_OK) {
+    stopLoadProfile();
+    return false;
+  }
+  scheduleSettleRead();
+  Serial.printf("Pulsed load: playing %u steps, %.3fs period.\n", (unsigned)profile.count,
+                loadProfilePeriodUs(profile) / 1000000.0);
+  uint8_t unlearnable = 0;
+  for (uint8_t i = 0; i < profile.count; i++) {
+    unlearnable += profilePlayer.learnable(i) ? 0 : 1;
+  }
+  if (unlearnable > 0) {
+    Serial.printf("Pulsed load: %u steps are no longer than %.1fms, the settle time plus two sensor conversions; "
+                  "they play their seeded level without learning.\n",
+                  (unsigned)unlearnable, profilePlayer.learnDelayUs() / 1000.0f);
+  }
+  return true;
+}
+
+// Fixed-rate load loop. It updates only on a measurement newer than the last
+// one it used, with dt from the sample timestamps, so a slow sample interval
+// slows the loop instead of integrating stale error. CP and CR recompute the
+// current target from every new voltage, so they track the pack as it sags.
+// Pulsed mode hands the output to the profile player and only feeds it the
+// readings to learn from. A calibration sweep, when asked for, takes over
+// the output in any mode until it is done. DAC writes go through the bus
+// queue like every
+// other transaction, at most one per tick, and only when the output moves
+// by at least one step of the DAC in use.
+static void loadControlTask(void *arg)
+{
+  (void)arg;
+
+  pi_controller_config_t controllerConfig = {LOAD_KP_V_PER_A, LOAD_KI_V_PER_AS, 0.0f, 0.0f, LOAD_SLEW_V_PER_S};
+  PiController controller(controllerConfig);
+  LoadDac *controlDac = nullptr;
+  StepResponseMonitor response(LOAD_SETTLE_BAND, LOAD_SETTLE_BAND_MIN_A, LOAD_SETTLE_HOLD_S, LOAD_SETTLE_TIMEOUT_S);
+  LoadCalibrationSweep sweep(LOAD_CALIBRATION_SETTLE_READINGS, LOAD_CALIBRATION_AVERAGE_READINGS);
+  float sweepOutputV = 0.0f;
+  bool calibrationRefined = false;
+  float priorOutputV = NAN;  // the output before the one applied now
+  bool running = false;
+  uint8_t lastMode = 0xFF;
+  float lastSetpoint = NAN;
+  uint64_t lastMeasurementUs = 0;
+  uint16_t lastOutputCode = 0;
+  bool outputPending = false;
+  bool profileAttempted = false;  // a start was tried since pulsed mode was entered
+  bool profilePlaying = false;
+  uint32_t profileRevision = 0;
+  TickType_t lastWake = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LOAD_CONTROL_PERIOD_MS));
+
+    load_measurement_t measurement;
+    portENTER_CRITICAL(&loadMeasurementMux);
+    measurement = loadMeasurement;
+    portEXIT_CRITICAL(&loadMeasurementMux);
+
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    bool fresh = measurement.timestamp_us != 0 && nowUs - measurement.timestamp_us <= LOAD_MEASUREMENT_STALE_US;
+    bool enabled = loadEnabled.load();
+    LoadDac *dac = loadDac.load();
+
+    if (!enabled || !fresh || dac != controlDac) {
+      if (running) {
+        if (dac != controlDac) {
+          Serial.println("Load: DAC changed, restarting from zero.");
+        } else if (enabled) {
+          Serial.println("Load: current reading went stale, load off.");
+        }
+        if (profileAttempted) {
+          stopLoadProfile();
+          profileAttempted = false;
+          profilePlaying = false;
+        }
+        if (sweep.active()) {
+          sweep.abort();
+          Serial.println("Load calibration aborted.");
+        }
+        if (calibrationRefined) {
+          publishLoadCalibration();
+          calibrationRefined = false;
+        }
+        controller.reset(0.0f);
+        lastOutputCode = 0;
+        priorOutputV = NAN;
+        outputPending = true;
+        running = false;
+      }
+      if (dac != controlDac) {
+        // The loop's output range is the range of the DAC it drives
+        controlDac = dac;
+        if (dac != nullptr) {
+          controllerConfig.outputMax = dac->fullScaleV();
+          controller.configure(controllerConfig);
+        }
+      }
+      if (outputPending && requestLoadOutput(0.0f)) {
+        outputPending = false;
+      }
+      continue;
+    }
+
+    if (!running) {
+      controller.reset(0.0f);
+      lastMeasurementUs = measurement.timestamp_us;
+      lastMode = 0xFF;
+      priorOutputV = NAN;
+      running = true;
+    }
+
+    if (!sweep.active() && loadCalibrationRequested.exchange(false)) {
+      if (profileAttempted) {
+        stopLoadProfile();
+        profileAttempted = false;
+        profilePlaying = false;
+      }
+      Serial.printf("Load calibration: sweeping 0-%.1fV in %u steps.\n", dac->fullScaleV(),
+                    (unsigned)LOAD_CALIBRATION_SWEEP_STEPS);
+      sweepOutputV = sweep.begin(dac->fullScaleV(), LOAD_MAX_CURRENT_A, LOAD_MAX_POWER_W);
+      lastMeasurementUs = measurement.timestamp_us;
+      outputPending = true;
+    }
+    if (sweep.active()) {
+      if (measurement.timestamp_us != lastMeasurementUs) {
+        lastMeasurementUs = measurement.timestamp_us;
+        sweepOutputV = sweep.update(measurement.voltage_v, measurement.current_a);
+        outputPending = true;
+        if (!sweep.active()) {
+          load_calibration_t result;
+          if (sweep.finish(LOAD_CALIBRATION_MIN_SPAN_A, &result)) {
+            loadCalibration = result;
+            calibrationRefined = false;
+            publishLoadCalibration();
+            logLoadCalibration(loadCalibration);
+          } else {
+            Serial.printf("Load calibration failed: the load never drew more than %.0fmA.\n",
+                          LOAD_CALIBRATION_MIN_SPAN_A * 1000.0f);
+          }
+          // Back to the selected mode from zero
+          controller.reset(0.0f);
+          lastOutputCode = 0;
+          priorOutputV = NAN;
+          lastMode = 0xFF;
+        }
+      }
+      if (outputPending && requestLoadOutput(sweepOutputV)) {
+        outputPending = false;
+      }
+      continue;
+    }
+
+    uint8_t mode = loadMode.load();
+    if (mode == UI_LOAD_PULSED) {
+      uint32_t revision = loadProfileRevision.load();
+      if (!profileAttempted || revision != profileRevision) {
+        profileAttempted = true;
+        profileRevision = revision;
+        profilePlaying = startLoadProfile(nowUs, dac->fullScaleV());
+        if (!profilePlaying) {
+          Serial.println("Pulsed load: no profile to play, load off.");
+          outputPending = true;
+          lastOutputCode = 0;
+        }
+      }
+      if (profilePlaying) {
+        // Each step's newest reading, however many steps went by since the
+        // last tick. Correct the level straight away only while its step is
+        // still on.
+        uint8_t activeStep = profilePlayer.step();
+        for (uint8_t i = 0; i < profilePlayer.stepCount(); i++) {
+          if (profilePlayer.learn(i) && i == activeStep) {
+            (void)queueLoadDacWrite();
+          }
+        }
+      }
+      if (outputPending && requestLoadOutput(0.0f)) {
+        outputPending = false;
+      }
+      continue;
+    }
+    if (profileAttempted) {
+      // Back to a regulated mode: start from zero, not from the last pulse
+      stopLoadProfile();
+      profileAttempted = false;
+      profilePlaying = false;
+      controller.reset(0.0f);
+      lastOutputCode = 0;
+      priorOutputV = NAN;
+      outputPending = true;
+      lastMeasurementUs = measurement.timestamp_us;
+      lastMode = 0xFF;
+    }
+
+    float setpoint = loadSetpoint.load();
+    float targetA = loadTargetCurrentA(mode, setpoint, measurement.voltage_v);
+    if (mode != lastMode || setpoint != lastSetpoint) {
+      // Step response is judged on the current target at the moment of the
+      // change; in CP and CR it then drifts only as fast as the pack sags
+      response.begin(measurement.current_a, targetA, measurement.timestamp_us);
+      lastMode = mode;
+      lastSetpoint = setpoint;
+    }
+
+    if (measurement.timestamp_us != lastMeasurementUs) {
+      float dtS = (float)(measurement.timestamp_us - lastMeasurementUs) / 1000000.0f;
+      lastMeasurementUs = measurement.timestamp_us;
+
+      // The reading was taken under the applied output; it only describes
+      // the stage if that output had also been on for the reading before
+      float appliedV = dac->voltsFor(lastOutputCode);
+      if (!outputPending && fabsf(appliedV - priorOutputV) <= LOAD_CALIBRATION_HOLD_V &&
+          refineLoadCalibration(&loadCalibration, appliedV, measurement.current_a, LOAD_CALIBRATION_REFINE_GAIN)) {
+        calibrationRefined = true;
+      }
+      priorOutputV = outputPending ? NAN : appliedV;
+
+      float feedforwardV = loadCalibrationVolts(loadCalibration, targetA);
+      float outputV = controller.step(targetA, measurement.current_a, dtS, feedforwardV);
+      if (response.update(measurement.current_a, measurement.timestamp_us)) {
+        logStepResponse(mode, response);
+      }
+
+      uint16_t outputCode = dac->codeFor(outputV);
+      outputPending |= (outputCode != lastOutputCode);
+      lastOutputCode = outputCode;
+    }
+
+    if (outputPending && requestLoadOutput(dac->voltsFor(lastOutputCode))) {
+      outputPending = false;
+    }
+  }
+}
+
+static void applySensorSelection(void)
+{
+  uint8_t sensorType = acqSensorType.load();
+  appliedSensorType = sensorType;
+  autoRanging = (sensorType == UI_SENSOR_AUTO_RANGE);
+  ina3221Mode = (sensorType == UI_SENSOR_INA3221);
+  ina228Mode = (sensorType == UI_SENSOR_INA228);
+  if (autoRanging) {
+    autoRange.reset(CurrentRange::Coarse);
+  }
+  if (sensorType != UI_SENSOR_INA226_1A) {
+    activeIna226 = &ina226_10a;
+    activeMeterUnits = &meterUnits10A;
+  } else {
+    activeIna226 = &ina226_1a;
+    activeMeterUnits = &meterUnits1A;
+  }
+}
+
+// Acquisition task: attach the register-level driver to the active INA226
+// and, when its ALERT line is wired, arm one-read-per-conversion sampling.
+// Falls back to UnitUnified reads if the driver cannot attach. In INA3221
+// mode only that part is configured, with the same preset codes.
+static void configureSensorDrivers(void)
+{
+  ina226DriverActive = false;
+  conversionReadyMode = false;
+  fineDriverActive = false;
+  ina3221DriverActive = false;
+  ina228DriverActive = false;
+
+  // What one reading averages over, for the profile's learning. The INA228
+  // converts faster for each code, so for it this errs long.
+  uint16_t presetValue = acqIna226Config;
+  uint32_t conversionUs = ina226_config_period_us(presetValue);
+  profilePlayer.setConversionWindow(ina3221Mode ? INA3221_CHANNEL_COUNT * conversionUs : conversionUs);
+
+  if (ina228Mode) {
+    ina228DriverActive = activeSensorReady() &&
+                         ina228Driver.writeAdcConfig(ina228_adc_config_value((uint8_t)(presetValue >> 9),
+                                                                             (uint8_t)(presetValue >> 6),
+                                                                             (uint8_t)(presetValue >> 3)));
+    return;
+  }
+
+  if (ina3221Mode) {
+    uint16_t configValue = ina3221_config_value((uint8_t)(presetValue >> 9), (uint8_t)(presetValue >> 6),
+                                                (uint8_t)(presetValue >> 3));
+    ina3221DriverActive = activeSensorReady() && ina3221Driver.writeConfig(configValue);
+    if (ina3221DriverActive) {
+      Serial.printf("INA3221: three channels, fresh set every %luus.\n",
+                    (unsigned long)ina3221_config_period_us(configValue));
+    }
+    return;
+  }
+
+  if (autoRanging && deviceLinks[DEVICE_INA226_1A].ready()) {
+    fineDriverActive = fineDriver.begin(&externalBus, ina226_1a.address(), INA226_1A_SHUNT_OHMS) &&
+                       fineDriver.writeConfig(acqIna226Config);
+    if (!fineDriverActive) {
+      Serial.println("Auto-range: INA226-1A driver did not attach, using the 10A unit only.");
+    }
+  }
+
+  if (!activeSensorReady() || activeIna226 == nullptr) {
+    return;
+  }
+
+  float shuntOhms = (activeIna226 == &ina226_10a) ? INA226_10A_SHUNT_OHMS : INA226_1A_SHUNT_OHMS;
+  if (!ina226Driver.begin(&externalBus, activeIna226->address(), shuntOhms)) {
+    Serial.println("INA226 register driver did not attach, using UnitUnified reads.");
+    return;
+  }
+
+  uint16_t configValue = acqIna226Config;
+  if (!ina226Driver.writeConfig(configValue)) {
+    Serial.println("INA226 preset write failed, using UnitUnified reads.");
+    return;
+  }
+  ina226DriverActive = true;
+
+#if INA226_ALERT_PIN >= 0
+  if (autoRanging) {
+    // Two units convert independently; one ALERT line cannot pace both
+    Serial.println("Auto-range uses timed sampling.");
+    return;
+  }
+
+  uint32_t periodUs = ina226_config_period_us(configValue);
+  if (!ina226Driver.enableConversionReadyAlert()) {
+    Serial.println("INA226 conversion-ready setup failed, using timed sampling.");
+    return;
+  }
+
+  conversionReadyMode = true;
+  conversionPeriodUs = periodUs;
+  acqJitterResetPending = true;
+  Serial.printf("INA226 conversion-ready sampling: one read every %luus.\n", (unsigned long)periodUs);
+#endif
+}
+
+static void applyUiConfig(const ui_config_t *config)
+{
+  if (config == nullptr) {
+    return;
+  }
+
+  bool sensorChanged = (runtimeConfig.sensor_type != config->sensor_type);
+  runtimeConfig = *config;
+
+  sanitizeConfig(&runtimeConfig);
+
+  acqIntervalMs = runtimeConfig.sample_interval_ms;
+  acqTempIntervalMs = runtimeConfig.temp_interval_ms;
+  acqSensorType = (uint8_t)runtimeConfig.sensor_type;
+  acqIna226Config = ina226ConfigFor(&runtimeConfig);
+  saveConfigToNvs(&runtimeConfig);
+  logIna226Preset(&runtimeConfig);
+
+  if (sensorChanged) {
+    for (uint8_t ch = 0; ch < UI_CHANNEL_COUNT; ch++) {
+      channels[ch].integrator.restart();
+    }
+    cutoffReached = false;
+    overtempReached = false;
+    Serial.printf("Sensor type changed to %s\n", sensorTypeName(runtimeConfig.sensor_type));
+  }
+}
+
+static void publishLoadTemp(float tempC)
+{
+  acq_temp_reading_t reading = {tempC, (uint64_t)esp_timer_get_time()};
+  portENTER_CRITICAL(&loadTempMux);
+  loadTempReading = reading;
+  portEXIT_CRITICAL(&loadTempMux);
+}
+
+static bool runThermocoupleRead(const i2c_job_t *job)
+{
+  (void)job;
+  thermoUnits.update();
+  thermoReadC = loadThermocouple.temperature();
+  return !isnan(thermoReadC);
+}
+
+static void onThermocoupleReadDone(const i2c_job_t *job, bool ok)
+{
+  (void)job;
+  thermoJobPending = false;
+  publishLoadTemp(thermoReadC);
+  if (ok && safety.checkTemperature(thermoReadC, (uint64_t)esp_timer_get_time())) {
+    onSafetyTrip();
+  }
+  if (!ok) {
+    faultDevice(DEVICE_THERMOCOUPLE);
+    Serial.println("Load thermocouple read failed.");
+  }
+}
+
+// Acquisition task only. Queues a thermocouple read once per temperature
+// interval, independent of the power sample rate, while the link is up.
+static void serviceLoadTemp(uint32_t nowMs)
+{
+  if (thermoJobPending || !deviceLinks[DEVICE_THERMOCOUPLE].ready() ||
+      (nowMs - lastLoadTempRequestMs < acqTempIntervalMs.load())) {
+    return;
+  }
+
+  lastLoadTempRequestMs = nowMs;
+  i2c_job_t job = {};
+  job.run = runThermocoupleRead;
+  job.done = onThermocoupleReadDone;
+  job.estimated_us = THERMO_READ_US;
+  thermoJobPending = busQueue.submit(THERMO_READ_I2C_PRIORITY, job);
+}
+
+// Acquisition task: keeps the active INA226 selected.
+static void serviceSensorSelection(void)
+{
+  if (acqSensorType.load() != appliedSensorType) {
+    applySensorSelection();
+    configureSensorDrivers();
+  }
+}
+
+// Acquisition task, auto-range only: read the 1A unit right after the 10A one
+// and keep whichever reading the range selector trusts. Range changes touch
+// nothing downstream, so energy keeps integrating straight through them.
+static bool applyAutoRange(bool coarseOk, acq_sample_t *sample)
+{
+  range_reading_t coarse = {sample->voltage_v, sample->current_a, coarseOk};
+  range_reading_t fine = {0.0f, 0.0f, false};
+  if (fineDriverActive) {
+    ina226_reading_t reading = {};
+    fine.valid = fineDriver.read(&reading);
+    fine.voltage_v = reading.bus_voltage_v;
+    fine.current_a = reading.current_a;
+    if (!fine.valid) {
+      fineDriverActive = false;
+      faultDevice(DEVICE_INA226_1A);
+      Serial.println("Auto-range: INA226-1A read failed, using the 10A unit only.");
+    }
+  }
+
+  range_reading_t chosen;
+  if (!autoRange.select(fine, coarse, &chosen)) {
+    return false;
+  }
+  sample->voltage_v = chosen.voltage_v;
+  sample->current_a = chosen.current_a;
+  if (autoRange.range() == CurrentRange::Fine) {
+    sample->flags |= ACQ_SAMPLE_FINE_RANGE;
+  }
+  acqRangeSwitches = autoRange.switches();
+  return true;
+}
+
+// Acquisition task, INA3221 mode: one pass over all three channels, handed
+// on as three samples sharing a timestamp and sequence number.
+static void acquireIna3221Sample(void)
+{
+  uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+  uint32_t profileOffsetUs;
+  uint8_t profileStep = profileStepAt(timestampUs, &profileOffsetUs);
+  ina3221_reading_t reading = {};
+  bool readOk = ina3221DriverActive && ina3221Driver.read(&reading);
+  if (readOk) {
+    acqBytesPerSample = ina3221Driver.lastSampleBytes();
+    if (acqFirstSampleUs.load() == 0) {
+      acqFirstSampleUs = timestampUs;
+    }
+  } else if (ina3221DriverActive) {
+    ina3221DriverActive = false;
+    faultDevice(DEVICE_INA3221);
+    Serial.println("INA3221 read failed, sensor unavailable.");
+  }
+
+  uint32_t sequence = acqSequence++;
+  acqJitter.record(timestampUs);
+  for (uint8_t ch = 0; ch < INA3221_CHANNEL_COUNT; ch++) {
+    acq_sample_t sample = {};
+    sample.sequence = sequence;
+    sample.timestamp_us = timestampUs;
+    sample.channel = ch;
+    sample.profile_step = profileStep;
+    if (readOk) {
+      sample.voltage_v = reading.bus_voltage_v[ch];
+      sample.current_a = reading.current_a[ch];
+      sample.flags = ACQ_SAMPLE_POWER_VALID;
+      if (ch == 0) {
+        checkSafetyVoltage(sample.voltage_v, timestampUs);
+        publishLoadReading(timestampUs, sample.voltage_v, sample.current_a, profileStep, profileOffsetUs);
+      }
+    }
+    (void)sampleRing.push(sample);
+  }
+}
+
+// Acquisition task, INA228 mode: VBUS and CURRENT every sample; the energy
+// and charge totals once a second, since the chip integrates between reads.
+static void acquireIna228Sample(void)
+{
+  acq_sample_t sample = {};
+  uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+  uint32_t profileOffsetUs;
+  sample.profile_step = profileStepAt(timestampUs, &profileOffsetUs);
+  ina228_reading_t reading = {};
+  bool readOk = ina228DriverActive && ina228Driver.read(&reading);
+
+  if (readOk && timestampUs - lastTotalsReadUs >= INA228_TOTALS_INTERVAL_US) {
+    ina228_totals_t totals;
+    readOk = ina228Driver.readTotals(&totals);
+    if (readOk) {
+      lastTotalsReadUs = timestampUs;
+      portENTER_CRITICAL(&ina228TotalsMux);
+      ina228Totals.energy_wh = totals.energy_j / 3600.0;
+      ina228Totals.charge_ah = totals.charge_c / 3600.0;
+      ina228Totals.overflows = totals.overflows;
+      ina228Totals.timestamp_us = timestampUs;
+      portEXIT_CRITICAL(&ina228TotalsMux);
+    }
+  }
+
+  if (readOk) {
+    sample.voltage_v = reading.bus_voltage_v;
+    sample.current_a = reading.current_a;
+    sample.flags = ACQ_SAMPLE_POWER_VALID;
+    checkSafetyVoltage(sample.voltage_v, timestampUs);
+    publishLoadReading(timestampUs, sample.voltage_v, sample.current_a, sample.profile_step, profileOffsetUs);
+    acqBytesPerSample = ina228Driver.lastSampleBytes();
+    if (acqFirstSampleUs.load() == 0) {
+      acqFirstSampleUs = timestampUs;
+    }
+  } else if (ina228DriverActive) {
+    ina228DriverActive = false;
+    faultDevice(DEVICE_INA228);
+    Serial.println("INA228 read failed, sensor unavailable.");
+  }
+
+  sample.sequence = acqSequence++;
+  sample.timestamp_us = timestampUs;
+  acqJitter.record(timestampUs);
+  (void)sampleRing.push(sample);
+}
+
+// Acquisition task: read the sensors once and hand the result to the UI loop.
+static void acquireSample(void)
+{
+  if (ina3221Mode) {
+    acquireIna3221Sample();
+    return;
+  }
+  if (ina228Mode) {
+    acquireIna228Sample();
+    return;
+  }
+
+  acq_sample_t sample = {};
+  uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+  uint32_t profileOffsetUs;
+  sample.profile_step = profileStepAt(timestampUs, &profileOffsetUs);
+
+  if (activeSensorReady() && activeMeterUnits != nullptr && activeIna226 != nullptr) {
+    bool readOk = false;
+
+    if (conversionReadyMode) {
+      ina226_reading_t reading = {};
+      Ina226ServiceResult result = ina226Driver.serviceConversionReady(&reading);
+      if (result == Ina226ServiceResult::Idle) {
+        // Woken without a finished conversion: nothing new to publish
+        return;
+      }
+      if (result == Ina226ServiceResult::Sample) {
+        timestampUs = ina226AlertUs.load();
+        sample.profile_step = profileStepAt(timestampUs, &profileOffsetUs);
+        sample.voltage_v = reading.bus_voltage_v;
+        sample.current_a = reading.current_a;
+        readOk = true;
+      }
+    } else if (ina226DriverActive) {
+      ina226_reading_t reading = {};
+      readOk = ina226Driver.read(&reading);
+      sample.voltage_v = reading.bus_voltage_v;
+      sample.current_a = reading.current_a;
+    } else {
+      activeMeterUnits->update();
+      sample.voltage_v = activeIna226->voltage() / 1000.0f;
+      sample.current_a = activeIna226->current() / 1000.0f;
+      readOk = !isnan(sample.voltage_v) && !isnan(sample.current_a);
+    }
+
+    bool activeOk = readOk;
+    if (autoRanging) {
+      readOk = applyAutoRange(activeOk, &sample);
+    }
+
+    if (readOk) {
+      sample.flags |= ACQ_SAMPLE_POWER_VALID;
+      checkSafetyVoltage(sample.voltage_v, timestampUs);
+      publishLoadReading(timestampUs, sample.voltage_v, sample.current_a, sample.profile_step, profileOffsetUs);
+      if (acqFirstSampleUs.load() == 0) {
+        acqFirstSampleUs = timestampUs;
+      }
+      if (ina226DriverActive) {
+        acqBytesPerSample = ina226Driver.lastSampleBytes() + (fineDriverActive ? fineDriver.lastSampleBytes() : 0);
+      }
+    } else {
+      sample.voltage_v = 0.0f;
+      sample.current_a = 0.0f;
+    }
+    if (!activeOk) {
+      ina226DriverActive = false;
+      conversionReadyMode = false;
+      faultDevice(activeDeviceId());
+      Serial.println("INA226 read failed, sensor unavailable.");
+    }
+  }
+
+  sample.sequence = acqSequence++;
+  sample.timestamp_us = timestampUs;
+  acqJitter.record(timestampUs);
+
+  (void)sampleRing.push(sample);
+}
+
+// Acquisition task: a read for the load loop alone, at a profile step's
+// settle time, so every step long enough to learn gets a reading to learn
+// from however it falls against the sample interval. It reaches the safety
+// check and the load controller but not the sample stream, whose cadence
+// and jitter stay the sample timer's. In auto-range it is the 10A unit's
+// reading; without the register drivers there is none. A failed read is left
+// to the next sample to report.
+static void takeSettleRead(void)
+{
+  uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+  float voltageV = 0.0f;
+  float currentA = 0.0f;
+  if (ina3221Mode) {
+    ina3221_reading_t reading;
+    if (!ina3221DriverActive || !ina3221Driver.read(&reading)) {
+      return;
+    }
+    voltageV = reading.bus_voltage_v[0];
+    currentA = reading.current_a[0];
+  } else if (ina228Mode) {
+    ina228_reading_t reading;
+    if (!ina228DriverActive || !ina228Driver.read(&reading)) {
+      return;
+    }
+    voltageV = reading.bus_voltage_v;
+    currentA = reading.current_a;
+  } else {
+    ina226_reading_t reading;
+    if (!ina226DriverActive || !ina226Driver.read(&reading)) {
+      return;
+    }
+    voltageV = reading.bus_voltage_v;
+    currentA = reading.current_a;
+  }
+
+  uint32_t profileOffsetUs;
+  uint8_t profileStep = profileStepAt(timestampUs, &profileOffsetUs);
+  checkSafetyVoltage(voltageV, timestampUs);
+  publishLoadReading(timestampUs, voltageV, currentA, profileStep, profileOffsetUs);
+}
+
+// Acquisition task: time the UnitUnified read path against the register
+// driver on the live unit, so the per-sample cost of each is visible.
+static void benchmarkIna226Paths(void)
+{
+  constexpr uint32_t BENCH_READS = 32;
+
+  if (!ina226DriverActive || activeMeterUnits == nullptr || activeIna226 == nullptr) {
+    return;
+  }
+
+  int64_t startUs = esp_timer_get_time();
+  for (uint32_t i = 0; i < BENCH_READS; i++) {
+    activeMeterUnits->update(true);
+    (void)activeIna226->voltage();
+    (void)activeIna226->current();
+  }
+  int64_t unitUs = esp_timer_get_time() - startUs;
+  ina226Driver.invalidatePointer();
+
+  ina226_reading_t reading;
+  uint32_t bytesBefore = externalBus.bytesMoved();
+  startUs = esp_timer_get_time();
+  for (uint32_t i = 0; i < BENCH_READS; i++) {
+    (void)ina226Driver.read(&reading);
+  }
+  int64_t driverUs = esp_timer_get_time() - startUs;
+  uint32_t driverBytes = externalBus.bytesMoved() - bytesBefore;
+
+  Serial.printf("INA226 per-sample cost: UnitUnified %.0fus | register driver %.0fus, %.1f bytes\n",
+                (double)unitUs / BENCH_READS, (double)driverUs / BENCH_READS, (double)driverBytes / BENCH_READS);
+}
+
+// Acquisition task: one read as soon as the active INA226 comes up, so the
+// boot-to-first-sample time does not depend on a test being started.
+static void takeFirstSample(void)
+{
+  bool ok = false;
+  if (ina3221Mode) {
+    ina3221_reading_t reading;
+    ok = ina3221DriverActive && ina3221Driver.read(&reading);
+  } else if (ina228Mode) {
+    ina228_reading_t reading;
+    ok = ina228DriverActive && ina228Driver.read(&reading);
+  } else if (ina226DriverActive) {
+    ina226_reading_t reading;
+    ok = ina226Driver.read(&reading);
+  } else if (activeMeterUnits != nullptr && activeIna226 != nullptr) {
+    activeMeterUnits->update(true);
+    ok = !isnan(activeIna226->voltage());
+    ina226Driver.invalidatePointer();
+  }
+  if (ok) {
+    acqFirstSampleUs = (uint64_t)esp_timer_get_time();
+  }
+}
+
+// Bus owner: args[0] is the device, args[1] the probe stage. Stage 0 is an
+// address-only ACK check costing a few bytes on the bus; only a device that
+// answers gets the full bring-up in stage 1, so an empty port never blocks
+// the bus for a UnitUnified begin().
+static bool runDeviceProbe(const i2c_job_t *job)
+{
+  uint8_t device = (uint8_t)job->args[0];
+  return (job->args[1] == 0) ? deviceAcks(device) : bringUpDevice(device);
+}
+
+static void onDeviceProbeDone(const i2c_job_t *job, bool ok)
+{
+  uint8_t device = (uint8_t)job->args[0];
+  if (ok && job->args[1] == 0) {
+    i2c_job_t next = *job;
+    next.args[1] = 1;
+    next.estimated_us = PROBE_BRING_UP_US;
+    if (busQueue.submit(PROBE_I2C_PRIORITY, next)) {
+      return;
+    }
+    // Queue full: give up this round and let the backoff retry it
+  }
+
+  ProbeResult result = !ok ? ((job->args[1] == 0) ? ProbeResult::NoAck : ProbeResult::InitFailed)
+                           : ProbeResult::Ready;
+  deviceLinks[device].finishProbe(result, millis());
+  publishLinkState(device);
+
+  if (result != ProbeResult::Ready) {
+    return;
+  }
+  if (device == activeDeviceId()) {
+    configureSensorDrivers();
+    if (acqFirstSampleUs.load() == 0) {
+      takeFirstSample();
+      benchmarkIna226Paths();
+    }
+  } else if (device == DEVICE_INA226_1A && autoRanging) {
+    configureSensorDrivers();
+  } else if (device == DEVICE_DAC2 || device == DEVICE_AD5693R) {
+    selectLoadDac();
+  }
+}
+
+// Acquisition task: starts a probe for every link whose backoff has expired.
+static void serviceDeviceLinks(uint32_t nowMs)
+{
+  for (uint8_t device = 0; device < DEVICE_COUNT; device++) {
+    if (!deviceLinks[device].startProbe(nowMs)) {
+      continue;
+    }
+
+    i2c_job_t job = {};
+    job.run = runDeviceProbe;
+    job.done = onDeviceProbeDone;
+    job.args[0] = device;
+    job.args[1] = 0;
+    job.estimated_us = PROBE_ACK_US;
+    if (!busQueue.submit(PROBE_I2C_PRIORITY, job)) {
+      deviceLinks[device].finishProbe(ProbeResult::NoAck, nowMs);
+    }
+  }
+}
+
+// Acquisition task: while a capture owns the sensor, keep the live readout
+// and energy total going by passing on one fast reading per sample interval.
+static void publishFastReading(uint64_t timestampUs, const ina226_reading_t *reading, uint64_t *nextLiveUs)
+{
+  // The limits and the load loop's measurement follow the capture rate, not
+  // the live rate, so the load controller never sees a capture as stale
+  uint32_t profileOffsetUs;
+  uint8_t profileStep = profileStepAt(timestampUs, &profileOffsetUs);
+  checkSafetyVoltage(reading->bus_voltage_v, timestampUs);
+  publishLoadReading(timestampUs, reading->bus_voltage_v, reading->current_a, profileStep, profileOffsetUs);
+  if (!acqEnabled || timestampUs < *nextLiveUs) {
+    return;
+  }
+  *nextLiveUs = timestampUs + (uint64_t)acqIntervalMs.load() * 1000ULL;
+
+  acq_sample_t sample = {};
+  sample.sequence = acqSequence++;
+  sample.timestamp_us = timestampUs;
+  sample.voltage_v = reading->bus_voltage_v;
+  sample.current_a = reading->current_a;
+  sample.flags = ACQ_SAMPLE_POWER_VALID;
+  sample.profile_step = profileStep;
+  (void)sampleRing.push(sample);
+}
+
+// Acquisition task, every capture pass: what the main loop would otherwise
+// do for the supervisor. A Start during the capture arms it and a failed
+// shutdown write is retried. While it is armed the thermocouple is still
+// read on its interval, so an overtemp trips mid-capture; each such read
+// leaves a gap of about THERMO_READ_US in the capture's timestamps.
+static void serviceCaptureSafety(void)
+{
+  serviceSafety();
+  (void)busQueue.runPending(UINT32_MAX, I2cPriority::Control);
+  if (!safety.armed()) {
+    return;
+  }
+  serviceLoadTemp(millis());
+  if (thermoJobPending) {
+    (void)busQueue.runPending(THERMO_READ_US, THERMO_READ_I2C_PRIORITY);
+  }
+}
+
+// Acquisition task: read the active INA226 back-to-back at its fastest
+// conversion setting for one capture window, then restore the preset.
+// Reads are not paced by conversion-ready, so the bus rate sets the sample
+// rate and consecutive reads may repeat a conversion.
+static void runBurstCapture(void)
+{
+  if (!ina226DriverActive || !burstCapture.attached()) {
+    Serial.println("Burst capture needs the INA226 register driver and PSRAM buffers.");
+    acqBurstReady = true;
+    return;
+  }
+
+  (void)ina226Driver.disableAlert();
+  if (!ina226Driver.writeConfig(ina226_config_value(0, 0, 0))) {
+    Serial.println("Burst capture: INA226 config write failed.");
+    configureSensorDrivers();
+    acqBurstReady = true;
+    return;
+  }
+
+  ina226_reading_t reading = {};
+  uint64_t nextLiveUs = 0;
+  burstCapture.arm(BURST_WINDOW_US);
+  while (burstCapture.capturing()) {
+    if (!ina226Driver.read(&reading)) {
+      Serial.println("Burst capture: INA226 read failed, window cut short.");
+      burstCapture.finish();
+      break;
+    }
+    uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+    (void)burstCapture.add(timestampUs, reading.bus_voltage_v, reading.current_a);
+    publishFastReading(timestampUs, &reading, &nextLiveUs);
+    serviceCaptureSafety();
+  }
+
+  configureSensorDrivers();
+  acqBurstReady = true;
+}
+
+// Acquisition task: stream fast reads through the trigger engine until it
+// fires and the post-trigger samples are in, the UI cancels, or nothing
+// triggers within the timeout.
+static void runTriggerCapture(void)
+{
+  acqTriggerCancel = false;
+  if (!ina226DriverActive || !triggerCapture.attached() || !triggerCapture.arm(pendingTrigger)) {
+    Serial.println("Triggered capture needs the INA226 register driver and PSRAM buffers.");
+    acqTriggerReady = true;
+    return;
+  }
+
+  (void)ina226Driver.disableAlert();
+  if (!ina226Driver.writeConfig(ina226_config_value(0, 0, 0))) {
+    Serial.println("Triggered capture: INA226 config write failed.");
+    triggerCapture.cancel();
+    configureSensorDrivers();
+    acqTriggerReady = true;
+    return;
+  }
+
+  ina226_reading_t reading = {};
+  uint64_t nextLiveUs = 0;
+  uint64_t armedUs = (uint64_t)esp_timer_get_time();
+  while (triggerCapture.armed()) {
+    if (acqTriggerCancel.exchange(false)) {
+      triggerCapture.cancel();
+      break;
+    }
+    if (!ina226Driver.read(&reading)) {
+      Serial.println("Triggered capture: INA226 read failed.");
+      triggerCapture.cancel();
+      break;
+    }
+
+    uint64_t timestampUs = (uint64_t)esp_timer_get_time();
+    (void)triggerCapture.add(timestampUs, reading.bus_voltage_v, reading.current_a);
+    publishFastReading(timestampUs, &reading, &nextLiveUs);
+    serviceCaptureSafety();
+
+    if (!triggerCapture.triggered() && timestampUs - armedUs > TRIGGER_TIMEOUT_US) {
+      Serial.println("Triggered capture: no trigger within timeout.");
+      triggerCapture.cancel();
+    }
+  }
+
+  configureSensorDrivers();
+  acqTriggerReady = true;
+}
+
+#if INA226_ALERT_PIN >= 0
+static void IRAM_ATTR onIna226Alert()
+{
+  ina226AlertUs.store((uint64_t)esp_timer_get_time());
+  ina226Driver.notifyAlertFromIsr();
+  if (acquisitionTaskHandle != nullptr) {
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(acquisitionTaskHandle, &higherPriorityWoken);
+    portYIELD_FROM_ISR(higherPriorityWoken);
+  }
+}
+#endif
+
+// esp_timer callback: wakes the acquisition task on every sample period.
+static void onSampleTimer(void *arg)
+{
+  (void)arg;
+  if (acquisitionTaskHandle != nullptr) {
+    xTaskNotifyGive(acquisitionTaskHandle);
+  }
+}
+
+static void stopSampleTimer(void)
+{
+  if (sampleTimer != nullptr) {
+    (void)esp_timer_stop(sampleTimer);
+  }
+}
+
+static void restartSampleTimer(uint16_t intervalMs)
+{
+  if (sampleTimer == nullptr) {
+    return;
+  }
+
+  stopSampleTimer();
+  if (esp_timer_start_periodic(sampleTimer, (uint64_t)intervalMs * 1000ULL) != ESP_OK) {
+    Serial.println("Failed to start sample timer.");
+  }
+}
+
+// Acquisition task: bus time left for queued jobs before the next sample
+// is due, keeping a guard band so a job never overlaps the sample read.
+static uint32_t busJobBudgetUs(bool enabled, uint64_t lastSampleWakeUs, uint16_t intervalMs)
+{
+  if (!enabled) {
+    return UINT32_MAX;
+  }
+
+  uint64_t periodUs = conversionReadyMode ? conversionPeriodUs : (uint64_t)intervalMs * 1000ULL;
+  uint64_t sampleStartUs = conversionReadyMode ? ina226AlertUs.load() : lastSampleWakeUs;
+  uint64_t nextSampleUs = sampleStartUs + periodUs;
+  uint64_t nowUs = (uint64_t)esp_timer_get_time();
+  if (nextSampleUs <= nowUs + I2C_JOB_GUARD_US) {
+    return 0;
+  }
+  return (uint32_t)(nextSampleUs - nowUs - I2C_JOB_GUARD_US);
+}
+
+// Acquisition task: how long conversion-ready mode waits for an ALERT edge
+// before it re-arms. The preset's conversion period paces the alerts, and a
+// slow preset can outlast the sample interval.
+static uint64_t conversionReadyTimeoutUs(uint16_t intervalMs)
+{
+  uint64_t periodUs = (uint64_t)conversionPeriodUs;
+  uint64_t intervalUs = (uint64_t)intervalMs * 1000ULL;
+  if (intervalUs > periodUs) {
+    periodUs = intervalUs;
+  }
+  return 2ULL * periodUs + CONVERSION_READY_SLACK_US;
+}
+
+static void acquisitionTask(void *arg)
+{
+  (void)arg;
+
+  uint16_t timerIntervalMs = acqIntervalMs.load();
+  uint16_t appliedIna226Config = acqIna226Config.load();
+  bool timerRunning = false;
+  bool wasEnabled = false;
+  uint64_t lastWakeUs = (uint64_t)esp_timer_get_time();
+  uint32_t lastBusBytes = externalBus.bytesMoved();
+
+  for (;;) {
+    // In conversion-ready mode the ALERT ISR paces us; the timer only runs
+    // while that mode is off (including while the sensor is absent).
+    if (timerRunning == conversionReadyMode) {
+      timerRunning = !conversionReadyMode;
+      if (timerRunning) {
+        restartSampleTimer(timerIntervalMs);
+      } else {
+        stopSampleTimer();
+      }
+    }
+
+    // Wake at least every I2C_SERVICE_MS so queued jobs never wait for a
+    // slow sample interval; a wake without a notification takes no sample.
+    uint32_t ticks = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(I2C_SERVICE_MS));
+    uint64_t wakeUs = (uint64_t)esp_timer_get_time();
+    // A profile edge wakes us only to write the DAC, and a settle wake only
+    // for a read the load loop learns from. A wake counted just before its
+    // notification arrives shifts one sample by microseconds; it never adds
+    // or loses one.
+    uint32_t profileWakes = acqProfileWakes.exchange(0);
+    ticks = (ticks > profileWakes) ? ticks - profileWakes : 0;
+    bool settleRead = acqSettleReadPending.exchange(false);
+    if (ticks > 0) {
+      lastWakeUs = wakeUs;
+    }
+
+    uint16_t intervalMs = acqIntervalMs.load();
+    if (intervalMs != timerIntervalMs) {
+      timerIntervalMs = intervalMs;
+      if (timerRunning) {
+        restartSampleTimer(timerIntervalMs);
+      }
+      acqJitterResetPending = true;
+    }
+
+    if (acqIna226Config.load() != appliedIna226Config) {
+      appliedIna226Config = acqIna226Config.load();
+      configureSensorDrivers();
+    }
+
+    bool enabled = acqEnabled;
+    if (conversionReadyMode && enabled && !wasEnabled) {
+      // Conversions that finished while idle are stale; start from a clean latch
+      (void)ina226Driver.enableConversionReadyAlert();
+    } else if (conversionReadyMode && enabled && ticks == 0 &&
+               wakeUs - lastWakeUs > conversionReadyTimeoutUs(timerIntervalMs)) {
+      // No ALERT edge for two periods: clear the latch and re-arm
+      Serial.println("INA226 conversion-ready alert timed out, re-arming.");
+      (void)ina226Driver.enableConversionReadyAlert();
+      lastWakeUs = wakeUs;
+    }
+    if (ina228DriverActive && enabled && !wasEnabled) {
+      // The chip has been integrating since power-up; count from the start
+      if (!ina228Driver.resetAccumulators()) {
+        ina228DriverActive = false;
+        faultDevice(DEVICE_INA228);
+      }
+      lastTotalsReadUs = wakeUs;
+    }
+    wasEnabled = enabled;
+
+    if (acqJitterResetPending.exchange(false)) {
+      acqJitter.reset(conversionReadyMode ? conversionPeriodUs : (uint32_t)timerIntervalMs * 1000U);
+    } else if (ticks > 1 && !conversionReadyMode) {
+      acqJitter.recordMissedTicks(ticks - 1);
+    }
+
+    if (acqBurstRequested.exchange(false)) {
+      runBurstCapture();
+      acqJitterResetPending = true;
+      continue;
+    }
+    if (acqTriggerRequested.exchange(false)) {
+      runTriggerCapture();
+      acqJitterResetPending = true;
+      continue;
+    }
+
+    uint32_t nowMs = millis();
+    serviceSensorSelection();
+    serviceDeviceLinks(nowMs);
+    serviceLoadTemp(nowMs);
+    serviceSafety();
+    if (enabled && ticks > 0) {
+      acquireSample();
+      acqBusBusyUs.fetch_add((uint32_t)((uint64_t)esp_timer_get_time() - wakeUs), std::memory_order_relaxed);
+    } else if (enabled && settleRead && !conversionReadyMode) {
+      // Conversion-ready mode reads every conversion already
+      takeSettleRead();
+      acqBusBusyUs.fetch_add((uint32_t)((uint64_t)esp_timer_get_time() - wakeUs), std::memory_order_relaxed);
+    }
+
+    acqBusBusyUs.fetch_add(busQueue.runPending(busJobBudgetUs(enabled, lastWakeUs, timerIntervalMs)),
+                           std::memory_order_relaxed);
+
+    uint32_t busBytes = externalBus.bytesMoved();
+    acqBusBytes.fetch_add(busBytes - lastBusBytes, std::memory_order_relaxed);
+    lastBusBytes = busBytes;
+
+    portENTER_CRITICAL(&acqJitterMux);
+    acqJitterSnapshot = acqJitter;
+    portEXIT_CRITICAL(&acqJitterMux);
+  }
+}
+
+static void allocateCaptureBuffers(void)
+{
+  uint32_t *offsetsUs = (uint32_t *)heap_caps_malloc(sizeof(uint32_t) * CAPTURE_CAPACITY, MALLOC_CAP_SPIRAM);
+  float *voltageV = (float *)heap_caps_malloc(sizeof(float) * CAPTURE_CAPACITY, MALLOC_CAP_SPIRAM);
+  float *currentA = (float *)heap_caps_malloc(sizeof(float) * CAPTURE_CAPACITY, MALLOC_CAP_SPIRAM);
+  if (offsetsUs == nullptr || voltageV == nullptr || currentA == nullptr) {
+    heap_caps_free(offsetsUs);
+    heap_caps_free(voltageV);
+    heap_caps_free(currentA);
+    Serial.println("Capture buffers unavailable, burst and triggered capture disabled.");
+    return;
+  }
+
+  burstCapture.attach(offsetsUs, voltageV, currentA, CAPTURE_CAPACITY);
+  triggerCapture.attach(offsetsUs, voltageV, currentA, CAPTURE_CAPACITY);
+}
+
+static void startAcquisitionTask(void)
+{
+  if (!busQueue.begin(I2C_QUEUE_DEPTH, I2C_JOB_STARVATION_US)) {
+    Serial.println("Failed to create I2C transaction queue.");
+    return;
+  }
+
+  const esp_timer_create_args_t timerArgs = {
+    .callback = onSampleTimer,
+    .arg = nullptr,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "sample",
+    .skip_unhandled_events = false
+  };
+  if (esp_timer_create(&timerArgs, &sampleTimer) != ESP_OK) {
+    sampleTimer = nullptr;
+    Serial.println("Failed to create sample timer.");
+    return;
+  }
+
+  const esp_timer_create_args_t profileTimerArgs = {
+    .callback = onProfileTimer,
+    .arg = nullptr,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "load_profile",
+    .skip_unhandled_events = false
+  };
+  if (esp_timer_create(&profileTimerArgs, &profileTimer) != ESP_OK) {
+    profileTimer = nullptr;
+    Serial.println("Failed to create load profile timer, pulsed load disabled.");
+  }
+
+  const esp_timer_create_args_t settleTimerArgs = {
+    .callback = onProfileSettleTimer,
+    .arg = nullptr,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "load_settle",
+    .skip_unhandled_events = false
+  };
+  if (esp_timer_create(&settleTimerArgs, &profileSettleTimer) != ESP_OK) {
+    profileSettleTimer = nullptr;
+    Serial.println("Failed to create load settle timer, short profile steps will not learn.");
+  }
+
+  BaseType_t created = xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQ_TASK_STACK, nullptr,
+                                               ACQ_TASK_PRIORITY, &acquisitionTaskHandle, ACQ_TASK_CORE);
+  if (created != pdPASS) {
+    acquisitionTaskHandle = nullptr;
+    Serial.println("Failed to start acquisition task.");
+    return;
+  }
+
+  created = xTaskCreatePinnedToCore(loadControlTask, "load_control", LOAD_TASK_STACK, nullptr, LOAD_TASK_PRIORITY,
+                                    &loadControlTaskHandle, ACQ_TASK_CORE);
+  if (created != pdPASS) {
+    loadControlTaskHandle = nullptr;
+    Serial.println("Failed to start load control task.");
+  }
+
+#if INA226_ALERT_PIN >= 0
+  pinMode(INA226_ALERT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INA226_ALERT_PIN), onIna226Alert, FALLING);
+#endif
+}
+
+static void logJitterStats(void)
+{
+  JitterStats stats;
+  portENTER_CRITICAL(&acqJitterMux);
+  stats = acqJitterSnapshot;
+  portEXIT_CRITICAL(&acqJitterMux);
+
+  if (stats.periods() == 0) {
+    return;
+  }
+
+  Serial.printf("Sample period: target %luus | mean %.1fus min %luus max %luus | jitter rms %.1fus max %luus | missed %lu of %lu\n",
+                (unsigned long)stats.nominalUs(), stats.meanPeriodUs(),
+                (unsigned long)stats.minPeriodUs(), (unsigned long)stats.maxPeriodUs(),
+                stats.rmsErrorUs(), (unsigned long)stats.maxAbsErrorUs(),
+                (unsigned long)stats.missedTicks(), (unsigned long)stats.periods());
+
+  // Measured delivery: we cannot get fresh data faster than the INA226
+  // finishes conversions, however fast we read.
+  double readHz = stats.meanPeriodUs() > 0.0 ? 1000000.0 / stats.meanPeriodUs() : 0.0;
+  double conversionHz = 1000000.0 / (double)ina226_config_period_us(acqIna226Config);
+  Serial.printf("Effective sample rate: %.1f Hz (reading at %.1f Hz, converting at %.1f Hz)\n",
+                readHz < conversionHz ? readHz : conversionHz, readHz, conversionHz);
+
+  uint32_t bytesPerSample = acqBytesPerSample;
+  if (bytesPerSample > 0) {
+    Serial.printf("INA226 register driver: %lu bus bytes/sample\n", (unsigned long)bytesPerSample);
+  }
+}
+
+static void showCapture(const char *kind, const capture_summary_t &summary, const float *voltageV,
+                        const float *currentA, float triggerOffsetMs)
+{
+  Serial.printf("%s capture: %lu samples in %.1fms (%.1fus/sample, %.0f Hz)\n", kind,
+                (unsigned long)summary.sample_count, summary.duration_us / 1000.0f, summary.mean_period_us,
+                summary.mean_period_us > 0.0f ? 1000000.0f / summary.mean_period_us : 0.0f);
+  Serial.printf("%s capture: V %.3f/%.3f/%.3fV  I %.2f/%.2f/%.2fmA (min/mean/max)  peak %.3fW\n", kind,
+                summary.voltage_min_v, summary.voltage_mean_v, summary.voltage_max_v,
+                summary.current_min_a * 1000.0f, summary.current_mean_a * 1000.0f, summary.current_max_a * 1000.0f,
+                summary.peak_power_w);
+
+  ui_capture_summary_t uiSummary = {};
+  uiSummary.sample_count = summary.sample_count;
+  uiSummary.duration_ms = summary.duration_us / 1000.0f;
+  uiSummary.mean_period_us = summary.mean_period_us;
+  uiSummary.voltage_min_v = summary.voltage_min_v;
+  uiSummary.voltage_max_v = summary.voltage_max_v;
+  uiSummary.voltage_mean_v = summary.voltage_mean_v;
+  uiSummary.current_min_ma = summary.current_min_a * 1000.0f;
+  uiSummary.current_max_ma = summary.current_max_a * 1000.0f;
+  uiSummary.current_mean_ma = summary.current_mean_a * 1000.0f;
+  uiSummary.peak_power_w = summary.peak_power_w;
+  uiSummary.trigger_offset_ms = triggerOffsetMs;
+  ui_show_capture(voltageV, currentA, summary.sample_count, &uiSummary);
+}
+
+static trigger_config_t triggerConfigFor(const ui_config_t *config)
+{
+  trigger_config_t trigger = {};
+  bool voltage = config->trigger_source == UI_TRIGGER_SOURCE_VOLTAGE;
+  trigger.source = voltage ? TriggerSource::Voltage : TriggerSource::Current;
+  switch (config->trigger_mode) {
+    case UI_TRIGGER_FALLING_EDGE:
+      trigger.mode = TriggerMode::FallingEdge;
+      break;
+    case UI_TRIGGER_ABOVE_LEVEL:
+      trigger.mode = TriggerMode::Above;
+      break;
+    case UI_TRIGGER_BELOW_LEVEL:
+      trigger.mode = TriggerMode::Below;
+      break;
+    case UI_TRIGGER_RISING_EDGE:
+    default:
+      trigger.mode = TriggerMode::RisingEdge;
+      break;
+  }
+  trigger.level = voltage ? config->trigger_level : config->trigger_level / 1000.0f;
+  trigger.pre_samples = TRIGGER_PRE_SAMPLES;
+  trigger.post_samples = TRIGGER_POST_SAMPLES;
+  return trigger;
+}
+
+// One capture at a time: the shared buffers are not touched again by the
+// task until the previous result has been charted.
+static void handleCaptureRequests(void)
+{
+  if (ui_consume_capture_request() && !captureInFlight) {
+    ui_set_capture_status("Capturing...");
+    captureInFlight = true;
+    acqBurstRequested = true;
+  }
+
+  if (ui_consume_trigger_request()) {
+    if (triggerArmed) {
+      acqTriggerCancel = true;
+    } else if (!captureInFlight) {
+      // Published to the task by the release store on acqTriggerRequested
+      pendingTrigger = triggerConfigFor(&runtimeConfig);
+      captureInFlight = true;
+      triggerArmed = true;
+      ui_set_trigger_armed(true);
+      ui_set_capture_status("Waiting for trigger...");
+      acqTriggerRequested = true;
+    }
+  }
+
+  if (acqBurstReady.exchange(false)) {
+    captureInFlight = false;
+    if (burstCapture.state() == BurstCapture::State::Complete && burstCapture.count() > 0) {
+      showCapture("Burst", burstCapture.summary(), burstCapture.voltageV(), burstCapture.currentA(), -1.0f);
+    } else {
+      ui_set_capture_status("Capture failed");
+    }
+  }
+
+  if (acqTriggerReady.exchange(false)) {
+    captureInFlight = false;
+    triggerArmed = false;
+    ui_set_trigger_armed(false);
+    if (triggerCapture.state() == TriggerCapture::State::Complete) {
+      float triggerOffsetMs = triggerCapture.offsetsUs()[triggerCapture.triggerIndex()] / 1000.0f;
+      showCapture("Triggered", triggerCapture.summary(), triggerCapture.voltageV(), triggerCapture.currentA(),
+                  triggerOffsetMs);
+    } else {
+      ui_set_capture_status("No trigger");
+    }
+  }
+}
+
+static void logBusUtilization(uint32_t elapsedMs)
+{
+  uint32_t busyUs = acqBusBusyUs.exchange(0);
+  uint32_t bytes = acqBusBytes.exchange(0);
+  if (elapsedMs == 0) {
+    return;
+  }
+
+  // Busy time includes driver overhead, so it is the upper bound; the
+  // register driver's bytes at 9 clocks each are the wire-level lower bound.
+  float busyPercent = (float)busyUs / ((float)elapsedMs * 10.0f);
+  float wirePercent = ((float)bytes * 9.0f) / ((float)elapsedMs * 400.0f) * 100.0f;
+  Serial.printf("I2C bus: %.1f%% busy (INA226 wire time %.1f%% of 400 kHz) | queue: %lu done, %lu failed, %lu rejected, %lu starved\n",
+                busyPercent, wirePercent, (unsigned long)busQueue.completed(), (unsigned long)busQueue.failed(),
+                (unsigned long)busQueue.rejected(), (unsigned long)busQueue.starved());
+}
+
+static void resetChannel(uint8_t ch)
+{
+  channels[ch].integrator.reset();
+  for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+    channels[ch].testStats[m].reset();
+    channels[ch].windowStats[m].reset();
+  }
+  channels[ch].data.energy_wh = 0.0f;
+  channels[ch].data.charge_ah = 0.0f;
+  if (ch == 0) {
+    ina228EnergyWh = 0.0;
+    ina228ChargeAh = 0.0;
+    for (size_t step = 0; step < LOAD_PROFILE_MAX_STEPS; step++) {
+      profileStepStats[step].reset();
+    }
+  }
+}
+
+// UI loop: the latest INA228 totals, if any were read since the test started.
+static bool freshIna228Totals(acq_energy_totals_t *totals)
+{
+  portENTER_CRITICAL(&ina228TotalsMux);
+  *totals = ina228Totals;
+  portEXIT_CRITICAL(&ina228TotalsMux);
+  return totals->timestamp_us > testStartUs;
+}
+
+static uint8_t activeChannelCount(void)
+{
+  return ina3221Mode ? INA3221_CHANNEL_COUNT : 1;
+}
+
+static void fillUiStat(const RunningStats &stats, bool temperature, ui_stat_t *out)
+{
+  out->count = stats.count();
+  out->min = stats.min();
+  out->max = stats.max();
+  out->mean = (float)stats.mean();
+  out->rms = temperature ? NAN : (float)stats.rms();
+  out->stddev = (float)stats.stddev();
+  if (temperature && runtimeConfig.units != UI_UNITS_METRIC) {
+    out->min = celsiusToFahrenheit(out->min);
+    out->max = celsiusToFahrenheit(out->max);
+    out->mean = celsiusToFahrenheit(out->mean);
+    out->stddev *= 1.8f;
+  }
+}
+
+// UI loop: hand the stats screen a fresh snapshot of every active channel.
+static void publishChannelStats(uint64_t nowUs)
+{
+  ui_channel_stats_t stats;
+  stats.window_s = (uint16_t)(window_stats_t::spanMs() / 1000U);
+  for (uint8_t ch = 0; ch < activeChannelCount(); ch++) {
+    for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+      bool temperature = (m == UI_STAT_LOAD_TEMP);
+      fillUiStat(channels[ch].testStats[m], temperature, &stats.test[m]);
+      fillUiStat(channels[ch].windowStats[m].summary(nowUs), temperature, &stats.window[m]);
+    }
+    ui_set_channel_stats(ch, &stats);
+  }
+}
+
+// UI loop: export the statistics as CSV lines for whoever is logging the
+// serial port: STATS,<channel>,<span>,<metric>,count,min,max,mean,rms,stddev
+static void logChannelStats(uint64_t nowUs)
+{
+  static const char *const metricNames[UI_STAT_COUNT] = {"voltage_v", "current_ma", "power_w", "load_temp_c"};
+  for (uint8_t ch = 0; ch < activeChannelCount(); ch++) {
+    for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+      const RunningStats window = channels[ch].windowStats[m].summary(nowUs);
+      const RunningStats *spans[2] = {&channels[ch].testStats[m], &window};
+      for (uint8_t span = 0; span < 2; span++) {
+        const RunningStats *stats = spans[span];
+        Serial.printf("STATS,CH%u,%s,%s,%lu,%.6f,%.6f,%.6f,%.6f,%.6f\n", (unsigned)(ch + 1),
+                      span == 0 ? "test" : "window", metricNames[m], (unsigned long)stats->count(),
+                      (double)stats->min(), (double)stats->max(), stats->mean(), stats->rms(), stats->stddev());
+      }
+    }
+  }
+
+  for (uint8_t step = 0; step < loadProfile.count; step++) {
+    const RunningStats &stats = profileStepStats[step];
+    if (stats.count() == 0) {
+      continue;
+    }
+    Serial.printf("PROFILE,step%u,%.6f,%lu,%.6f,%.6f,%.6f\n", (unsigned)step, (double)loadProfile.steps[step].current_a,
+                  (unsigned long)stats.count(), (double)stats.min(), (double)stats.max(), stats.mean());
+  }
+}
+
+// UI loop: the load runs only while a test is integrating and the DAC is
+// up; anything else turns it off on the next control tick.
+static void updateLoadControl(void)
+{
+  float setpoint = 0.0f;
+  switch (runtimeConfig.load_type) {
+    case UI_LOAD_CONSTANT_CURRENT:
+      setpoint = runtimeConfig.load_current_a;
+      break;
+    case UI_LOAD_CONSTANT_POWER:
+      setpoint = runtimeConfig.load_power_w;
+      break;
+    case UI_LOAD_CONSTANT_IMPEDANCE:
+      setpoint = runtimeConfig.load_resistance_ohm;
+      break;
+    case UI_LOAD_PULSED:
+    default:
+      // The profile carries its own setpoints
+      break;
+  }
+
+  loadMode = (uint8_t)runtimeConfig.load_type;
+  loadSetpoint = setpoint;
+  loadEnabled = testRunning && !cutoffReached && !overtempReached && !safetyLatched &&
+                (deviceStatus[DEVICE_DAC2] == LinkState::Ready || deviceStatus[DEVICE_AD5693R] == LinkState::Ready);
+}
+
+// UI loop: keep the supervisor's limits in step with the config and report
+// each trip, with its shutdown latency, once the load DAC is confirmed at zero.
+static void updateSafety(void)
+{
+  safetyCutoffV = runtimeConfig.cutoff_voltage_v;
+  safetyOvertempC = runtimeConfig.overtemp_cutoff_c;
+
+  safety_trip_t trip;
+  portENTER_CRITICAL(&safetyMux);
+  trip = safetySnapshot;
+  portEXIT_CRITICAL(&safetyMux);
+  if (trip.trip == SafetyTrip::None || trip.trip_us == safetyTripLoggedUs) {
+    return;
+  }
+
+  // The UI's own checks normally see the same reading first; this covers
+  // a tripping sample that never reached the ring
+  bool undervoltage = (trip.trip == SafetyTrip::Undervoltage);
+  if (undervoltage) {
+    cutoffReached = true;
+  } else {
+    overtempReached = true;
+  }
+  if (trip.shutdown_us == 0) {
+    if (trip.trip_us != safetyPendingLoggedUs) {
+      safetyPendingLoggedUs = trip.trip_us;
+      Serial.println("Safety: trip latched but the load DAC did not take the zero write; retrying.");
+    }
+    return;
+  }
+
+  safetyTripLoggedUs = trip.trip_us;
+  uint64_t latencyUs = trip.shutdown_us - trip.trip_us;
+  // Detection can lag the crossing by up to one sample (or temperature) interval
+  uint32_t intervalMs = undervoltage ? runtimeConfig.sample_interval_ms : runtimeConfig.temp_interval_ms;
+  Serial.printf("Safety: %s trip at %.3f%s (limit %.3f%s); load at zero %luus after the reading, "
+                "worst case %luus from the crossing%s.\n",
+                undervoltage ? "cutoff" : "overtemp", (double)trip.value, undervoltage ? "V" : "C",
+                (double)trip.threshold, undervoltage ? "V" : "C", (unsigned long)latencyUs,
+                (unsigned long)(latencyUs + intervalMs * 1000UL),
+                latencyUs > SAFETY_SHUTDOWN_BUDGET_US ? ", OVER BUDGET" : "");
+}
+
+static void publishCapacity(void)
+{
+  ui_capacity_t status;
+  switch (capacity.verdict()) {
+    case CapacityVerdict::Running:
+      status.verdict = UI_CAPACITY_RUNNING;
+      break;
+    case CapacityVerdict::Pass:
+      status.verdict = UI_CAPACITY_PASS;
+      break;
+    case CapacityVerdict::Fail:
+      status.verdict = UI_CAPACITY_FAIL;
+      break;
+    case CapacityVerdict::Incomplete:
+      status.verdict = UI_CAPACITY_INCOMPLETE;
+      break;
+    case CapacityVerdict::Idle:
+    default:
+      status.verdict = UI_CAPACITY_IDLE;
+      break;
+  }
+  status.delivered_ah = (float)capacity.deliveredAh();
+  status.delivered_wh = (float)capacity.deliveredWh();
+  status.rated_ah = capacity.ratedAh();
+  status.rated_percent = capacity.ratedPercent();
+  status.projected_ah = capacity.projectedAh();
+
+  // Live SoC from the chemistry's OCV curve, on the window means so one noisy
+  // sample does not move it. Under load the pack sits below its resting
+  // voltage, so this reads low; it recovers when the load stops.
+  status.soc_percent = NAN;
+  status.runtime_h = NAN;
+  uint64_t nowUs = (uint64_t)esp_timer_get_time();
+  RunningStats voltage = channels[0].windowStats[UI_STAT_VOLTAGE].summary(nowUs);
+  RunningStats current = channels[0].windowStats[UI_STAT_CURRENT].summary(nowUs);
+  uint8_t cells = runtimeConfig.num_series_cells;
+  if (voltage.count() > 0 && cells > 0) {
+    uint8_t chemistry = (uint8_t)runtimeConfig.battery_type;
+    float soc = battery_soc_from_cell_voltage(chemistry, (float)voltage.mean() / (float)cells);
+    float cutoffSoc = battery_soc_from_cell_voltage(chemistry, runtimeConfig.cutoff_voltage_v / (float)cells);
+    status.soc_percent = soc * 100.0f;
+
+    float currentA = (current.count() > 0) ? (float)current.mean() / 1000.0f : 0.0f;
+    if (currentA > RUNTIME_MIN_CURRENT_A) {
+      float usableAh = (soc > cutoffSoc ? soc - cutoffSoc : 0.0f) * runtimeConfig.rated_battery_ampacity_ah;
+      status.runtime_h = usableAh / currentA;
+    }
+  }
+  ui_set_capacity(&status);
+}
+
+static const char *capacityVerdictName(CapacityVerdict verdict)
+{
+  switch (verdict) {
+    case CapacityVerdict::Pass:
+      return "PASS";
+    case CapacityVerdict::Fail:
+      return "FAIL";
+    case CapacityVerdict::Incomplete:
+      return "INCOMPLETE";
+    case CapacityVerdict::Running:
+      return "RUNNING";
+    case CapacityVerdict::Idle:
+    default:
+      return "IDLE";
+  }
+}
+
+// UI loop: close out the capacity test once, at cutoff, overtemp or Stop.
+static void finishCapacity(bool atCutoff)
+{
+  if (capacity.verdict() != CapacityVerdict::Running) {
+    return;
+  }
+  capacity.finish(atCutoff);
+  Serial.printf("Capacity: %.4fAh %.4fWh to %.3fV = %.1f%% of %.1fAh rated: %s\n",
+                capacity.deliveredAh(), capacity.deliveredWh(), runtimeConfig.cutoff_voltage_v,
+                (double)capacity.ratedPercent(), (double)capacity.ratedAh(), capacityVerdictName(capacity.verdict()));
+  publishCapacity();
+  logChannelStats((uint64_t)esp_timer_get_time());
+}
+
+// Start and Stop act on the whole test whichever channel is on screen;
+// Reset clears one channel's integrator, and on channel 0 also ends the test.
+static void handleTestRequests(void)
+{
+  bool startRequested = false;
+  bool stopRequested = false;
+  for (uint8_t ch = 0; ch < UI_CHANNEL_COUNT; ch++) {
+    startRequested |= ui_consume_start_request(ch);
+    stopRequested |= ui_consume_stop_request(ch);
+  }
+
+  if (startRequested) {
+    for (uint8_t ch = 0; ch < UI_CHANNEL_COUNT; ch++) {
+      resetChannel(ch);
+    }
+    safetyCutoffV = runtimeConfig.cutoff_voltage_v;
+    safetyOvertempC = runtimeConfig.overtemp_cutoff_c;
+    safetyArmCount.fetch_add(1);
+    safetyArmed = true;
+    testRunning = true;
+    cutoffReached = false;
+    overtempReached = false;
+    testStartUs = (uint64_t)esp_timer_get_time();
+    capacity.start(runtimeConfig.rated_battery_ampacity_ah, runtimeConfig.cutoff_voltage_v);
+    publishCapacity();
+    acqJitterResetPending = true;
+    acqEnabled = true;
+    ui_set_test_running(true);
+  }
+
+  if (stopRequested) {
+    finishCapacity(false);
+    safetyArmed = false;
+    testRunning = false;
+    acqEnabled = false;
+    ui_set_test_running(false);
+  }
+
+  for (uint8_t ch = 0; ch < UI_CHANNEL_COUNT; ch++) {
+    if (!ui_consume_reset_request(ch)) {
+      continue;
+    }
+    resetChannel(ch);
+    publishChannelStats((uint64_t)esp_timer_get_time());
+    if (ch == 0) {
+      capacity.reset();
+      publishCapacity();
+      safetyArmed = false;
+      testRunning = false;
+      cutoffReached = false;
+      overtempReached = false;
+      acqEnabled = false;
+      ui_set_test_running(false);
+    }
+  }
+}
+
+// UI loop: the cached load temperature in C as of nowUs, or NAN when there
+// is no thermocouple or the reading is past the staleness limit.
+static float freshLoadTempC(uint64_t nowUs)
+{
+  acq_temp_reading_t reading;
+  portENTER_CRITICAL(&loadTempMux);
+  reading = loadTempReading;
+  portEXIT_CRITICAL(&loadTempMux);
+
+  if (isnan(reading.temp_c)) {
+    return NAN;
+  }
+
+  uint64_t limitUs = (uint64_t)runtimeConfig.temp_interval_ms * 1000ULL * LOAD_TEMP_STALE_INTERVALS;
+  uint64_t ageUs = (nowUs > reading.timestamp_us) ? nowUs - reading.timestamp_us : 0;
+  if (ageUs > limitUs) {
+    if (!loadTempStaleLogged) {
+      Serial.printf("Load temperature is stale (%lums old), overtemp check paused.\n", (unsigned long)(ageUs / 1000ULL));
+      loadTempStaleLogged = true;
+    }
+    return NAN;
+  }
+
+  loadTempStaleLogged = false;
+  return reading.temp_c;
+}
+
+// UI loop: copy a channel's running totals into its display data.
+static void applyChannelTotals(uint8_t ch)
+{
+  channel_state_t *channel = &channels[ch];
+  if (ina228Mode && ch == 0) {
+    channel->data.energy_wh = (float)ina228EnergyWh;
+    channel->data.charge_ah = (float)ina228ChargeAh;
+  } else {
+    channel->data.energy_wh = (float)channel->integrator.energyWh();
+    channel->data.charge_ah = (float)channel->integrator.chargeAh();
+  }
+}
+
+// UI loop: integrate one sample using its acquisition timestamp, so a slow
+// redraw delays the display but never the measurement or the energy total.
+static void processSample(const acq_sample_t *sample)
+{
+  if (sample->channel >= UI_CHANNEL_COUNT) {
+    return;
+  }
+  channel_state_t *channel = &channels[sample->channel];
+  ui_channel_data_t *channelData = &channel->data;
+
+  float loadTempC = freshLoadTempC(sample->timestamp_us);
+  float loadTemp = NAN;
+  if (!isnan(loadTempC)) {
+    loadTemp = (runtimeConfig.units == UI_UNITS_METRIC) ? loadTempC : celsiusToFahrenheit(loadTempC);
+  }
+
+  if ((sample->flags & ACQ_SAMPLE_POWER_VALID) == 0) {
+    channelData->voltage_v = 0.0f;
+    channelData->current_ma = 0.0f;
+    channelData->power_w = 0.0f;
+    channel->integrator.skip(sample->timestamp_us);
+    applyChannelTotals(sample->channel);
+    channelData->load_temp_f = loadTemp;
+    ui_set_channel_data(sample->channel, channelData);
+    return;
+  }
+
+  float voltageV = sample->voltage_v;
+  float currentA = sample->current_a;
+
+  if (sample->channel == 0 && !cutoffReached && voltageV <= runtimeConfig.cutoff_voltage_v) {
+    cutoffReached = true;
+    Serial.printf("Cutoff reached at %.3fV (configured %.3fV).\n", voltageV, runtimeConfig.cutoff_voltage_v);
+  }
+
+  if (!isnan(loadTempC) && !overtempReached) {
+    if (loadTempC >= runtimeConfig.overtemp_cutoff_c) {
+      overtempReached = true;
+      Serial.printf("Overtemp cutoff reached at %.1fC (configured %.1fC).\n", loadTempC, runtimeConfig.overtemp_cutoff_c);
+    }
+  }
+
+  float powerW = voltageV * currentA;
+  bool integrating = testRunning && !cutoffReached && !overtempReached;
+  channel->integrator.add(sample->timestamp_us, voltageV, currentA, integrating);
+
+  // In INA228 mode the chip's own integral is the reported one; the software
+  // integral keeps running for the reconciliation line in the debug log
+  acq_energy_totals_t totals;
+  if (ina228Mode && sample->channel == 0 && integrating && freshIna228Totals(&totals)) {
+    ina228EnergyWh = totals.energy_wh;
+    ina228ChargeAh = totals.charge_ah;
+  }
+
+  channelData->voltage_v = voltageV;
+  channelData->current_ma = currentA * 1000.0f;
+  channelData->power_w = powerW;
+  applyChannelTotals(sample->channel);
+
+  // Temperature is kept in C and converted when shown, so a units change
+  // mid-test does not mix scales
+  const float statValues[UI_STAT_COUNT] = {voltageV, currentA * 1000.0f, powerW, loadTempC};
+  for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+    if (!isnan(statValues[m])) {
+      channel->testStats[m].add(statValues[m]);
+      channel->windowStats[m].add(sample->timestamp_us, statValues[m]);
+    }
+  }
+  if (sample->channel == 0 && sample->profile_step < LOAD_PROFILE_MAX_STEPS) {
+    profileStepStats[sample->profile_step].add(currentA);
+  }
+
+  if (sample->channel == 0) {
+    if (integrating) {
+      capacity.update(ina228Mode ? ina228ChargeAh : channel->integrator.chargeAh(),
+                      ina228Mode ? ina228EnergyWh : channel->integrator.energyWh(), voltageV);
+    } else if (testRunning) {
+      finishCapacity(cutoffReached);
+    }
+  }
+  channelData->load_temp_f = loadTemp;
+
+  ui_set_channel_data(sample->channel, channelData);
+}
+
+static void drainSampleRing(void)
+{
+  acq_sample_t sample;
+  while (sampleRing.pop(&sample)) {
+    lastSampleFineRange = (sample.flags & ACQ_SAMPLE_FINE_RANGE) != 0;
+    if (testRunning) {
+      processSample(&sample);
+    }
+  }
+
+  uint32_t dropped = sampleRing.dropped();
+  if (dropped != acqDroppedLogged) {
+    Serial.printf("Sample ring overflow: %u samples dropped so far.\n", (unsigned)dropped);
+    acqDroppedLogged = dropped;
+  }
+}
+
+void lv_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+{
+  uint32_t w = (area->x2 - area->x1 + 1);
+  uint32_t h = (area->y2 - area->y1 + 1);
+  display.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+  lv_disp_flush_ready(disp);
+}
+
+static void lv_indev_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+{
+  (void)indev_driver;
+
+  lgfx::touch_point_t tp[3];
+  uint8_t touchpad = display.getTouch(tp, 3);
+  if (touchpad > 0) {
+    data->state = LV_INDEV_STATE_PR;
+    data->point.x = tp[0].x;
+    data->point.y = tp[0].y;
+  } else {
+    data->state = LV_INDEV_STATE_REL;
+  }
+
+  data->continue_reading = false;
+}
+
+// UI loop: applies device state changes from the acquisition task and
+// redraws the status text only when something actually changed.
+static void drainDeviceEvents(void)
+{
+  bool changed = false;
+  device_event_t event;
+  while (deviceEvents.pop(&event)) {
+    if (event.device >= DEVICE_COUNT || deviceStatus[event.device] == event.state) {
+      continue;
+    }
+    deviceStatus[event.device] = event.state;
+    Serial.printf("%s: %s\n", deviceName(event.device), linkStateName(event.state));
+    changed = true;
+  }
+
+  if (changed || !deviceStatusShown) {
+    deviceStatusShown = true;
+    publishSensorStatus();
+  }
+}
+
+void setup()
+{
+  display.init();
+  Serial.begin(115200);
+
+  if (!preferences.begin(PREF_NAMESPACE, false)) {
+    Serial.println("Failed to open NVS preferences namespace.");
+  }
+  loadConfigFromNvs(&runtimeConfig);
+  saveConfigToNvs(&runtimeConfig);
+  loadProfileFromNvs();
+  loadCalibrationFromNvs();
+  acqIntervalMs = runtimeConfig.sample_interval_ms;
+  acqTempIntervalMs = runtimeConfig.temp_interval_ms;
+  acqSensorType = (uint8_t)runtimeConfig.sensor_type;
+  acqIna226Config = ina226ConfigFor(&runtimeConfig);
+
+  lv_init();
+  buf = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * LVGL_LCD_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  lv_disp_draw_buf_init(&draw_buf, buf, NULL, LVGL_LCD_BUF_SIZE);
+
+  static lv_disp_drv_t disp_drv;
+  lv_disp_drv_init(&disp_drv);
+  disp_drv.hor_res = EXAMPLE_LCD_H_RES;
+  disp_drv.ver_res = EXAMPLE_LCD_V_RES;
+  disp_drv.flush_cb = lv_disp_flush;
+  disp_drv.draw_buf = &draw_buf;
+  disp_drv.sw_rotate = 0;
+  lv_disp_drv_register(&disp_drv);
+
+  static lv_indev_drv_t indev_drv;
+  lv_indev_drv_init(&indev_drv);
+  indev_drv.type = LV_INDEV_TYPE_POINTER;
+  indev_drv.read_cb = lv_indev_read;
+  lv_indev_drv_register(&indev_drv);
+
+  ui_init();
+  ui_set_config(&runtimeConfig);
+  ui_set_test_running(false);
+  drainDeviceEvents();
+
+  // Paint the monitor screen before touching the bus; devices come up
+  // behind it and fill in their status as they answer.
+  lv_refr_now(NULL);
+  display.waitDMA();
+  display.setBrightness(255);
+  bootFirstFrameUs = esp_timer_get_time();
+  Serial.printf("Boot: first frame at %.1fms.\n", bootFirstFrameUs / 1000.0f);
+
+  Wire.begin(I2C_SDA, I2C_SCL, 400000U);
+  applySensorSelection();
+  logIna226Preset(&runtimeConfig);
+
+  allocateCaptureBuffers();
+  startAcquisitionTask();
+}
+
+void loop()
+{
+  uint32_t now = millis();
 
   if (lastLvTickMs == 0) {
     lastLvTickMs = now;
@@ -553,39 +3207,62 @@ void loop()
     applyUiConfig(&updatedConfig);
   }
 
-  if (!sensorPresent && (now - lastSensorRetryMs >= 2000)) {
-    lastSensorRetryMs = now;
-
-    if (runtimeConfig.sensor_type == UI_SENSOR_INA226_10A) {
-      (void)initializeINA226_10A();
-    } else {
-      (void)initializeINA226_1A();
-    }
-
-    applySensorSelection();
-    if (sensorPresent) {
-      Serial.printf("%s detected and reinitialized.\n", sensorTypeName(runtimeConfig.sensor_type));
-      lastSampleMs = 0;
-    } else {
-      Serial.printf("%s still not detected.\n", sensorTypeName(runtimeConfig.sensor_type));
-    }
-  }
-
-  if (now - lastSampleMs >= runtimeConfig.sample_interval_ms) {
-    updateEnergyAndUi();
+  handleTestRequests();
+  handleCaptureRequests();
+  handleSerialCommands();
+  saveLoadCalibration();
+  drainSampleRing();
+  drainDeviceEvents();
+  updateSafety();
+  updateLoadControl();
+
+  uint64_t firstSampleUs = acqFirstSampleUs.load();
+  if (!bootFirstSampleLogged && firstSampleUs != 0) {
+    bootFirstSampleLogged = true;
+    Serial.printf("Boot: first sample at %.1fms (%.1fms after first frame).\n",
+                  firstSampleUs / 1000.0f, (int64_t)(firstSampleUs - bootFirstFrameUs) / 1000.0f);
   }
 
   if (now - lastDebugMs >= 1000) {
-    publishSensorStatus();
     Serial.printf(
-      "Sensor:%s | V:%.3fV I:%.2fmA P:%.3fW E:%.6fWh | Load:%.1f%s | Cutoff:%.2fV %s | Overtemp:%.0fC %s | Batt:%uAh %ucells\\n",
+      "Sensor:%s | V:%.3fV I:%.2fmA P:%.3fW E:%.6fWh Q:%.6fAh | Load:%.1f%s | Cutoff:%.2fV %s | Overtemp:%.0fC %s | Batt:%uAh %ucells\\n",
       sensorTypeName(runtimeConfig.sensor_type),
-      channelData.voltage_v, channelData.current_ma, channelData.power_w, channelData.energy_wh,
-      channelData.load_temp_f, runtimeConfig.units == UI_UNITS_METRIC ? "C" : "F",
+      channels[0].data.voltage_v, channels[0].data.current_ma, channels[0].data.power_w, channels[0].data.energy_wh,
+      channels[0].data.charge_ah, channels[0].data.load_temp_f, runtimeConfig.units == UI_UNITS_METRIC ? "C" : "F",
       runtimeConfig.cutoff_voltage_v, cutoffReached ? "REACHED" : "OK",
       runtimeConfig.overtemp_cutoff_c, overtempReached ? "REACHED" : "OK",
       (unsigned)runtimeConfig.rated_battery_ampacity_ah, (unsigned)runtimeConfig.num_series_cells
     );
+    if (testRunning) {
+      logJitterStats();
+      publishCapacity();
+      publishChannelStats((uint64_t)esp_timer_get_time());
+      if (now - lastStatsLogMs >= STATS_LOG_INTERVAL_MS) {
+        logChannelStats((uint64_t)esp_timer_get_time());
+        lastStatsLogMs = now;
+      }
+    }
+    logBusUtilization(now - lastDebugMs);
+    if (runtimeConfig.sensor_type == UI_SENSOR_INA3221) {
+      for (uint8_t ch = 1; ch < INA3221_CHANNEL_COUNT; ch++) {
+        const ui_channel_data_t *data = &channels[ch].data;
+        Serial.printf("CH%u | V:%.3fV I:%.2fmA P:%.3fW E:%.6fWh Q:%.6fAh\n", (unsigned)(ch + 1),
+                      data->voltage_v, data->current_ma, data->power_w, data->energy_wh, data->charge_ah);
+      }
+    }
+    if (runtimeConfig.sensor_type == UI_SENSOR_AUTO_RANGE) {
+      Serial.printf("Auto-range: %s | %u range switches\n", lastSampleFineRange ? "1A" : "10A",
+                    (unsigned)acqRangeSwitches.load());
+    }
+    acq_energy_totals_t totals;
+    if (runtimeConfig.sensor_type == UI_SENSOR_INA228 && testRunning && freshIna228Totals(&totals)) {
+      // The two integrals differ by the chip's finer time base and any samples
+      // the task missed; a growing gap points at the sample path
+      double softwareWh = channels[0].integrator.energyWh();
+      double differencePercent = (totals.energy_wh != 0.0) ? (softwareWh - totals.energy_wh) / totals.energy_wh * 100.0 : 0.0;
+      Serial.printf("INA228 totals: %.6fWh %.6fAh | software %.6fWh (%+.2f%%) | %lu accumulator wraps\n",
+                    totals.energy_wh, totals.charge_ah, softwareWh, differencePercent, (unsigned long)totals.overflows);
+    }
     lastDebugMs = now;
   }
 
@@ -0,0 +1,28 @@
+#include "ad5693r_dac.h"
+
+bool Ad5693rDac::begin(RegisterBus *bus, uint8_t address, bool gain2x)
+{
+  bus_ = nullptr;
+  if (bus == nullptr) {
+    return false;
+  }
+
+  // Normal operation, internal reference on; then start from zero scale
+  uint16_t control = gain2x ? AD5693R_CONTROL_GAIN_2X : 0;
+  if (!bus->writeRegister16(address, AD5693R_CMD_WRITE_CONTROL, control) ||
+      !bus->writeRegister16(address, AD5693R_CMD_WRITE_UPDATE, 0)) {
+    return false;
+  }
+  bus_ = bus;
+  address_ = address;
+  gain2x_ = gain2x;
+  return true;
+}
+
+bool Ad5693rDac::writeLoadCode(uint16_t code)
+{
+  if (bus_ == nullptr) {
+    return false;
+  }
+  return bus_->writeRegister16(address_, AD5693R_CMD_WRITE_UPDATE, code);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include "load_dac.h"
+#include "register_bus.h"
+#include "ad5693r_registers.h"
+
+// Register-level AD5693R: one 16-bit channel on the internal 2.5 V
+// reference, 0-2.5 V or 0-5 V with the output gain of two.
+class Ad5693rDac : public LoadDac {
+public:
+  // Sets normal operation, the internal reference and the gain, and
+  // starts the output at zero.
+  bool begin(RegisterBus *bus, uint8_t address, bool gain2x);
+
+  const char *name() const override { return "AD5693R"; }
+  bool ready() const override { return bus_ != nullptr; }
+  uint8_t bits() const override { return AD5693R_BITS; }
+  float fullScaleV() const override { return gain2x_ ? 2.0f * AD5693R_REFERENCE_V : AD5693R_REFERENCE_V; }
+  bool writeLoadCode(uint16_t code) override;
+
+private:
+  RegisterBus *bus_ = nullptr;
+  uint8_t address_ = 0;
+  bool gain2x_ = false;
+};
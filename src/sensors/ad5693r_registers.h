@@ -0,0 +1,23 @@
+#pragma once
+
+// AD5693R command set (see docs/Sensors/AD5693R_5692R_5691R_5693.pdf). A
+// write is the command byte then 16 data bits, MSB first.
+
+#include <stdint.h>
+
+#define AD5693R_ADDRESS_A0_LOW 0x4C
+#define AD5693R_ADDRESS_A0_HIGH 0x4E
+
+#define AD5693R_CMD_WRITE_INPUT 0x10
+#define AD5693R_CMD_UPDATE_DAC 0x20
+#define AD5693R_CMD_WRITE_UPDATE 0x30  // input register and DAC together
+#define AD5693R_CMD_WRITE_CONTROL 0x40
+
+// Control register bits
+#define AD5693R_CONTROL_RESET (1u << 15)
+#define AD5693R_CONTROL_PD_SHIFT 13    // 00 = normal operation
+#define AD5693R_CONTROL_REF_DISABLE (1u << 12)
+#define AD5693R_CONTROL_GAIN_2X (1u << 11)
+
+#define AD5693R_BITS 16
+#define AD5693R_REFERENCE_V 2.5f
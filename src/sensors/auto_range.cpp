@@ -0,0 +1,49 @@
+#include "auto_range.h"
+
+#include <math.h>
+
+AutoRange::AutoRange(float fineFullScaleA, float upFraction, float downFraction, uint8_t downDwellSamples)
+    : upA_(fineFullScaleA * upFraction), downA_(fineFullScaleA * downFraction), downDwell_(downDwellSamples)
+{
+}
+
+void AutoRange::reset(CurrentRange range)
+{
+  range_ = range;
+  belowCount_ = 0;
+}
+
+bool AutoRange::select(const range_reading_t &fine, const range_reading_t &coarse, range_reading_t *out)
+{
+  CurrentRange next = range_;
+  if (range_ == CurrentRange::Fine) {
+    if (coarse.valid && (!fine.valid || fabsf(fine.current_a) >= upA_)) {
+      next = CurrentRange::Coarse;
+    }
+  } else if (!coarse.valid) {
+    if (fine.valid && fabsf(fine.current_a) < upA_) {
+      next = CurrentRange::Fine;
+    }
+  } else if (fine.valid && fabsf(coarse.current_a) <= downA_) {
+    if (++belowCount_ >= downDwell_) {
+      next = CurrentRange::Fine;
+    }
+  } else {
+    belowCount_ = 0;
+  }
+
+  if (next != range_) {
+    range_ = next;
+    belowCount_ = 0;
+    switches_++;
+  }
+
+  // A fine reading near full scale may be clipped. With the coarse unit
+  // unreadable it is still not a measurement, so the sample has none.
+  const range_reading_t &chosen = (range_ == CurrentRange::Fine) ? fine : coarse;
+  if (!chosen.valid || (range_ == CurrentRange::Fine && fabsf(chosen.current_a) >= upA_)) {
+    return false;
+  }
+  *out = chosen;
+  return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class CurrentRange : uint8_t {
+  Fine,   // INA226-1A: best resolution, saturates near 1 A
+  Coarse  // INA226-10A
+};
+
+typedef struct {
+  float voltage_v;
+  float current_a;
+  bool valid;
+} range_reading_t;
+
+// Picks, per sample, which of two INA226 units to trust. Leaves the fine
+// range as soon as its reading nears full scale (or fails), but only drops
+// back once the coarse reading has sat well inside the fine range for a few
+// samples, so a load hovering at the boundary does not flap between units.
+class AutoRange {
+public:
+  AutoRange(float fineFullScaleA, float upFraction, float downFraction, uint8_t downDwellSamples);
+
+  void reset(CurrentRange range);
+  CurrentRange range() const { return range_; }
+  uint32_t switches() const { return switches_; }
+
+  // Either reading may be invalid; returns false when neither is usable,
+  // including when only a fine reading at or past the switch-up point is.
+  bool select(const range_reading_t &fine, const range_reading_t &coarse, range_reading_t *out);
+
+private:
+  float upA_;
+  float downA_;
+  uint8_t downDwell_;
+  uint8_t belowCount_ = 0;
+  uint32_t switches_ = 0;
+  CurrentRange range_ = CurrentRange::Coarse;
+};
@@ -0,0 +1,62 @@
+#include "device_link.h"
+
+const char *linkStateName(LinkState state)
+{
+  switch (state) {
+    case LinkState::Probing:
+      return "Probing";
+    case LinkState::Ready:
+      return "Ready";
+    case LinkState::Faulted:
+      return "Faulted";
+    case LinkState::Absent:
+    default:
+      return "Absent";
+  }
+}
+
+DeviceLink::DeviceLink(uint32_t minBackoffMs, uint32_t maxBackoffMs)
+    : minBackoffMs_(minBackoffMs), maxBackoffMs_(maxBackoffMs), backoffMs_(minBackoffMs)
+{
+}
+
+bool DeviceLink::startProbe(uint32_t nowMs)
+{
+  if (state_ == LinkState::Ready || state_ == LinkState::Probing) {
+    return false;
+  }
+  if ((int32_t)(nowMs - nextProbeMs_) < 0) {
+    return false;
+  }
+
+  state_ = LinkState::Probing;
+  return true;
+}
+
+void DeviceLink::finishProbe(ProbeResult result, uint32_t nowMs)
+{
+  if (state_ != LinkState::Probing) {
+    return;
+  }
+
+  if (result == ProbeResult::Ready) {
+    state_ = LinkState::Ready;
+    backoffMs_ = minBackoffMs_;
+    return;
+  }
+
+  state_ = (result == ProbeResult::NoAck) ? LinkState::Absent : LinkState::Faulted;
+  nextProbeMs_ = nowMs + backoffMs_;
+  backoffMs_ = (backoffMs_ > maxBackoffMs_ / 2) ? maxBackoffMs_ : backoffMs_ * 2;
+}
+
+void DeviceLink::fault(uint32_t nowMs)
+{
+  if (state_ != LinkState::Ready) {
+    return;
+  }
+
+  state_ = LinkState::Faulted;
+  backoffMs_ = minBackoffMs_;
+  nextProbeMs_ = nowMs + backoffMs_;
+}
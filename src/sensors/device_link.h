@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class LinkState : uint8_t {
+  Absent,   // not answering its address
+  Probing,  // a probe is queued or running
+  Ready,
+  Faulted   // answers, but bring-up or a transfer failed
+};
+
+enum class ProbeResult : uint8_t {
+  NoAck,
+  InitFailed,
+  Ready
+};
+
+const char *linkStateName(LinkState state);
+
+// Connection state for one external-bus device. The owner asks whether a
+// probe is due, runs it however it likes (here: a cheap address-ACK check,
+// then the full bring-up only once the device answers) and reports back.
+// Every failed probe doubles the wait before the next, up to a ceiling; a
+// successful one resets it.
+class DeviceLink {
+public:
+  DeviceLink(uint32_t minBackoffMs, uint32_t maxBackoffMs);
+
+  LinkState state() const { return state_; }
+  bool ready() const { return state_ == LinkState::Ready; }
+  uint32_t backoffMs() const { return backoffMs_; }
+
+  // True when a probe should start now; the link is then Probing until
+  // finishProbe().
+  bool startProbe(uint32_t nowMs);
+  void finishProbe(ProbeResult result, uint32_t nowMs);
+
+  // A transfer to a Ready device failed: fault and re-probe after the
+  // minimum backoff.
+  void fault(uint32_t nowMs);
+
+private:
+  uint32_t minBackoffMs_;
+  uint32_t maxBackoffMs_;
+  uint32_t backoffMs_;
+  uint32_t nextProbeMs_ = 0;
+  LinkState state_ = LinkState::Absent;
+};
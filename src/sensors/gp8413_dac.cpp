@@ -0,0 +1,35 @@
+#include "gp8413_dac.h"
+
+bool Gp8413Dac::begin(RegisterBus *bus, uint8_t address)
+{
+  bus_ = nullptr;
+  if (bus == nullptr) {
+    return false;
+  }
+
+  const uint8_t range = GP8413_RANGE_10V;
+  if (!bus->writeRegisterBytes(address, GP8413_REG_RANGE, &range, 1)) {
+    return false;
+  }
+  bus_ = bus;
+  address_ = address;
+  if (!writeLoadCode(0)) {
+    bus_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool Gp8413Dac::writeLoadCode(uint16_t code)
+{
+  if (bus_ == nullptr) {
+    return false;
+  }
+  if (code > maxCode()) {
+    code = maxCode();
+  }
+
+  uint16_t data = (uint16_t)(code << 1);
+  const uint8_t bytes[4] = {(uint8_t)(data & 0xFF), (uint8_t)(data >> 8), 0x00, 0x00};
+  return bus_->writeRegisterBytes(address_, GP8413_REG_CH0_DATA, bytes, sizeof(bytes));
+}
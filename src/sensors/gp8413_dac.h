@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "load_dac.h"
+#include "register_bus.h"
+#include "gp8413_registers.h"
+
+// Register-level GP8413 (M5Stack DAC2). CH0 drives the load; CH1 is held
+// at zero by every write, which covers both channels in one transaction.
+class Gp8413Dac : public LoadDac {
+public:
+  // Selects the 0-10 V range on both channels and starts them at zero.
+  bool begin(RegisterBus *bus, uint8_t address);
+
+  const char *name() const override { return "GP8413"; }
+  bool ready() const override { return bus_ != nullptr; }
+  uint8_t bits() const override { return GP8413_BITS; }
+  float fullScaleV() const override { return 10.0f; }
+  bool writeLoadCode(uint16_t code) override;
+
+private:
+  RegisterBus *bus_ = nullptr;
+  uint8_t address_ = 0;
+};
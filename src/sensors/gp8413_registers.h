@@ -0,0 +1,16 @@
+#pragma once
+
+// GP8413 (M5Stack DAC2) register map. Two 15-bit channels; data registers
+// take the code shifted left by one, low byte first, and a write starting
+// at CH0 runs on into CH1.
+
+#include <stdint.h>
+
+#define GP8413_REG_RANGE 0x01
+#define GP8413_REG_CH0_DATA 0x02
+#define GP8413_REG_CH1_DATA 0x04
+
+#define GP8413_RANGE_5V 0x00
+#define GP8413_RANGE_10V 0x11  // both channels
+
+#define GP8413_BITS 15
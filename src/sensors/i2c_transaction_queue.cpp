@@ -0,0 +1,69 @@
+#include "i2c_transaction_queue.h"
+
+#include "esp_timer.h"
+
+bool I2cTransactionQueue::begin(size_t depthPerPriority, uint32_t starvationUs)
+{
+  starvationUs_ = starvationUs;
+  for (size_t i = 0; i < I2C_PRIORITY_COUNT; i++) {
+    queues_[i] = xQueueCreate((UBaseType_t)depthPerPriority, sizeof(i2c_job_t));
+    if (queues_[i] == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool I2cTransactionQueue::submit(I2cPriority priority, i2c_job_t job)
+{
+  QueueHandle_t queue = queues_[(size_t)priority];
+  job.submitted_us = esp_timer_get_time();
+  if (queue == nullptr || job.run == nullptr || xQueueSend(queue, &job, 0) != pdTRUE) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  submitted_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+uint32_t I2cTransactionQueue::runPending(uint32_t budgetUs, I2cPriority lowest)
+{
+  uint32_t usedUs = 0;
+  size_t level = 0;
+  while (level <= (size_t)lowest) {
+    QueueHandle_t queue = queues_[level];
+    i2c_job_t job;
+    if (queue == nullptr || xQueuePeek(queue, &job, 0) != pdTRUE) {
+      level++;
+      continue;
+    }
+
+    // Oldest job of the best waiting priority: run it if it fits, or if it
+    // has waited too long. Otherwise nothing below it runs either, so a
+    // long low-priority job cannot slip in ahead of it.
+    int64_t startUs = esp_timer_get_time();
+    uint32_t remainingUs = (usedUs < budgetUs) ? budgetUs - usedUs : 0;
+    bool starving = (uint64_t)(startUs - job.submitted_us) > starvationUs_;
+    if (job.estimated_us > remainingUs && !starving) {
+      break;
+    }
+    if (job.estimated_us > remainingUs) {
+      starved_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    (void)xQueueReceive(queue, &job, 0);
+    bool ok = job.run(&job);
+    if (job.done != nullptr) {
+      job.done(&job, ok);
+    }
+    if (ok) {
+      completed_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    usedUs += (uint32_t)(esp_timer_get_time() - startUs);
+    level = 0;
+  }
+  return usedUs;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Queue priorities, highest first. INA226 sample reads are not queued at
+// all: the bus owner runs them inline, ahead of every queued job.
+enum class I2cPriority : uint8_t {
+  Control = 0,      // outputs that change the load (DAC)
+  Maintenance = 1,  // probing / re-initialising absent devices
+  Background = 2    // slow housekeeping reads (thermocouple)
+};
+
+static constexpr size_t I2C_PRIORITY_COUNT = 3;
+
+typedef struct i2c_job i2c_job_t;
+
+// Runs on the bus owner and performs the transfer(s); returns success.
+typedef bool (*i2c_job_fn)(const i2c_job_t *job);
+// Completion, also called on the bus owner; keep it short.
+typedef void (*i2c_done_fn)(const i2c_job_t *job, bool ok);
+
+// Jobs are copied into the queue, so small arguments travel in args[] and
+// need no storage shared with the submitter.
+struct i2c_job {
+  i2c_job_fn run;
+  i2c_done_fn done;
+  void *context;
+  uint32_t args[2];
+  uint32_t estimated_us;  // expected bus time, used to fit the job between samples
+  int64_t submitted_us;   // set by submit()
+};
+
+// Transactions from any task are queued by priority and executed by the
+// single task that owns the bus, in the slack between power samples. A job
+// only starts if its estimate fits the time left before the next sample,
+// unless it has already waited longer than the starvation limit.
+class I2cTransactionQueue {
+public:
+  bool begin(size_t depthPerPriority, uint32_t starvationUs);
+
+  // Any task; never blocks. Returns false if that priority's queue is full.
+  bool submit(I2cPriority priority, i2c_job_t job);
+
+  // Bus owner only. Runs queued jobs of priority `lowest` or higher, best
+  // first, while they fit in budgetUs. Returns the bus time used.
+  uint32_t runPending(uint32_t budgetUs, I2cPriority lowest = I2cPriority::Background);
+
+  uint32_t submitted() const { return submitted_; }
+  uint32_t rejected() const { return rejected_; }
+  uint32_t completed() const { return completed_; }
+  uint32_t failed() const { return failed_; }
+  uint32_t starved() const { return starved_; }
+
+private:
+  QueueHandle_t queues_[I2C_PRIORITY_COUNT] = {};
+  uint32_t starvationUs_ = 0;
+  std::atomic<uint32_t> submitted_{0};
+  std::atomic<uint32_t> rejected_{0};
+  std::atomic<uint32_t> completed_{0};
+  std::atomic<uint32_t> failed_{0};
+  std::atomic<uint32_t> starved_{0};
+};
@@ -0,0 +1,124 @@
+#include "ina226_driver.h"
+
+bool Ina226Driver::begin(RegisterBus *bus, uint8_t address, float shuntOhms)
+{
+  bus_ = nullptr;
+  if (bus == nullptr || shuntOhms <= 0.0f) {
+    return false;
+  }
+
+  uint16_t manufacturerId = 0;
+  if (!bus->readRegister16(address, INA226_REG_MANUFACTURER_ID, &manufacturerId) ||
+      manufacturerId != INA226_MANUFACTURER_ID_TI) {
+    return false;
+  }
+
+  bus_ = bus;
+  address_ = address;
+  pointer_ = INA226_REG_MANUFACTURER_ID;
+  lastSampleBytes_ = 0;
+  currentPerShuntLsb_ = INA226_SHUNT_LSB_V / shuntOhms;
+  pendingAlerts_ = 0;
+  conversions_ = 0;
+  missedConversions_ = 0;
+  spuriousAlerts_ = 0;
+  return true;
+}
+
+bool Ina226Driver::readRegister(uint8_t reg, uint16_t *value)
+{
+  bool ok = (pointer_ == reg) ? bus_->readSelectedRegister16(address_, value)
+                              : bus_->readRegister16(address_, reg, value);
+  pointer_ = ok ? reg : POINTER_UNKNOWN;
+  return ok;
+}
+
+bool Ina226Driver::writeRegister(uint8_t reg, uint16_t value)
+{
+  // A register write also moves the device pointer to that register
+  bool ok = bus_->writeRegister16(address_, reg, value);
+  pointer_ = ok ? reg : POINTER_UNKNOWN;
+  return ok;
+}
+
+bool Ina226Driver::writeConfig(uint16_t configValue)
+{
+  return bus_ != nullptr && writeRegister(INA226_REG_CONFIG, configValue);
+}
+
+bool Ina226Driver::enableConversionReadyAlert()
+{
+  if (bus_ == nullptr) {
+    return false;
+  }
+
+  // Reading Mask/Enable first drops any conversion that finished before the
+  // ISR was attached, so the first alert we count is a fresh one.
+  uint16_t maskEnable = 0;
+  (void)readRegister(INA226_REG_MASK_ENABLE, &maskEnable);
+  pendingAlerts_ = 0;
+  return writeRegister(INA226_REG_MASK_ENABLE, INA226_MASK_CNVR);
+}
+
+bool Ina226Driver::disableAlert()
+{
+  pendingAlerts_ = 0;
+  return bus_ != nullptr && writeRegister(INA226_REG_MASK_ENABLE, 0);
+}
+
+Ina226ServiceResult Ina226Driver::serviceConversionReady(ina226_reading_t *reading)
+{
+  uint32_t alerts = pendingAlerts_.exchange(0, std::memory_order_relaxed);
+  if (alerts == 0 || bus_ == nullptr) {
+    return Ina226ServiceResult::Idle;
+  }
+  if (alerts > 1) {
+    missedConversions_ += alerts - 1;
+  }
+
+  uint32_t bytesBefore = bus_->bytesMoved();
+  uint16_t maskEnable = 0;
+  if (!readRegister(INA226_REG_MASK_ENABLE, &maskEnable)) {
+    return Ina226ServiceResult::BusError;
+  }
+  if ((maskEnable & INA226_MASK_CVRF) == 0) {
+    spuriousAlerts_++;
+    return Ina226ServiceResult::Idle;
+  }
+
+  if (!read(reading)) {
+    return Ina226ServiceResult::BusError;
+  }
+
+  lastSampleBytes_ = bus_->bytesMoved() - bytesBefore;
+  conversions_++;
+  return Ina226ServiceResult::Sample;
+}
+
+bool Ina226Driver::read(ina226_reading_t *reading)
+{
+  if (bus_ == nullptr || reading == nullptr) {
+    return false;
+  }
+
+  // Start with whichever result register the pointer already selects (no
+  // pointer write), then switch to the other. The order alternates from one
+  // sample to the next, keeping every sample at one plain read plus one
+  // pointer-write/read pair.
+  uint32_t bytesBefore = bus_->bytesMoved();
+  bool busFirst = (pointer_ == INA226_REG_BUS_VOLTAGE);
+  uint16_t shuntRaw = 0;
+  uint16_t busRaw = 0;
+  bool ok = busFirst ? (readRegister(INA226_REG_BUS_VOLTAGE, &busRaw) && readRegister(INA226_REG_SHUNT_VOLTAGE, &shuntRaw))
+                     : (readRegister(INA226_REG_SHUNT_VOLTAGE, &shuntRaw) && readRegister(INA226_REG_BUS_VOLTAGE, &busRaw));
+  lastSampleBytes_ = bus_->bytesMoved() - bytesBefore;
+  if (!ok) {
+    return false;
+  }
+
+  int16_t shuntCounts = (int16_t)shuntRaw;
+  reading->shunt_voltage_v = (float)shuntCounts * INA226_SHUNT_LSB_V;
+  reading->bus_voltage_v = (float)busRaw * INA226_BUS_LSB_V;
+  reading->current_a = (float)shuntCounts * currentPerShuntLsb_;
+  return true;
+}
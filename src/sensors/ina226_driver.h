@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include "register_bus.h"
+#include "ina226_registers.h"
+
+typedef struct {
+  float bus_voltage_v;
+  float shunt_voltage_v;
+  float current_a;
+} ina226_reading_t;
+
+enum class Ina226ServiceResult : uint8_t {
+  Idle,      // no alert pending, or the alert was not a finished conversion
+  Sample,    // reading holds the new conversion
+  BusError   // the alert was real but the I2C reads failed
+};
+
+// Register-level INA226 access with conversion-ready (ALERT pin) support.
+//
+// The M5 unit still owns bring-up; this driver only needs the bus, the I2C
+// address and the shunt value. A sample is just the shunt and bus voltage
+// registers: current is the shunt voltage times a precomputed scale, so the
+// current/power registers (and the calibration they depend on) are never
+// read. The driver tracks the device register pointer so one of the two
+// reads needs no pointer write.
+//
+// In conversion-ready mode the ALERT ISR calls notifyAlertFromIsr() and the
+// sampling task calls serviceConversionReady(), which reads Mask/Enable
+// (clearing the flag) and then the result registers, giving exactly one
+// reading per finished conversion.
+class Ina226Driver {
+public:
+  bool begin(RegisterBus *bus, uint8_t address, float shuntOhms);
+  bool ready() const { return bus_ != nullptr; }
+  uint8_t address() const { return address_; }
+
+  bool writeConfig(uint16_t configValue);
+  bool enableConversionReadyAlert();
+  bool disableAlert();
+
+  // Safe to call from an ISR: only bumps an atomic counter.
+  void notifyAlertFromIsr()
+  {
+    pendingAlerts_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool alertPending() const
+  {
+    return pendingAlerts_.load(std::memory_order_relaxed) != 0;
+  }
+
+  // Yields Sample exactly once per completed conversion.
+  Ina226ServiceResult serviceConversionReady(ina226_reading_t *reading);
+
+  bool read(ina226_reading_t *reading);
+
+  // Call after anything else (the M5 unit, a probe) has addressed the same
+  // part: the device pointer may have moved, so the next read selects its
+  // registers explicitly.
+  void invalidatePointer() { pointer_ = POINTER_UNKNOWN; }
+
+  // Bus bytes (address bytes included) used by the most recent sample.
+  uint32_t lastSampleBytes() const { return lastSampleBytes_; }
+
+  uint32_t conversions() const { return conversions_; }
+  uint32_t missedConversions() const { return missedConversions_; }
+  uint32_t spuriousAlerts() const { return spuriousAlerts_; }
+
+private:
+  static constexpr uint8_t POINTER_UNKNOWN = 0xFF;
+
+  bool readRegister(uint8_t reg, uint16_t *value);
+  bool writeRegister(uint8_t reg, uint16_t value);
+
+  RegisterBus *bus_ = nullptr;
+  uint8_t address_ = 0;
+  uint8_t pointer_ = POINTER_UNKNOWN;
+  float currentPerShuntLsb_ = 0.0f;
+  uint32_t lastSampleBytes_ = 0;
+
+  std::atomic<uint32_t> pendingAlerts_{0};
+  uint32_t conversions_ = 0;
+  uint32_t missedConversions_ = 0;
+  uint32_t spuriousAlerts_ = 0;
+};
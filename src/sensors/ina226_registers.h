@@ -0,0 +1,67 @@
+#pragma once
+
+// INA226 register map and field helpers (see docs/Sensors/ina226.pdf).
+// Plain C so both the firmware and the UI can use the timing tables.
+
+#include <stdint.h>
+
+#define INA226_REG_CONFIG 0x00
+#define INA226_REG_SHUNT_VOLTAGE 0x01
+#define INA226_REG_BUS_VOLTAGE 0x02
+#define INA226_REG_POWER 0x03
+#define INA226_REG_CURRENT 0x04
+#define INA226_REG_CALIBRATION 0x05
+#define INA226_REG_MASK_ENABLE 0x06
+#define INA226_REG_ALERT_LIMIT 0x07
+#define INA226_REG_MANUFACTURER_ID 0xFE
+#define INA226_REG_DIE_ID 0xFF
+
+#define INA226_MANUFACTURER_ID_TI 0x5449
+
+#define INA226_CONFIG_RESET (1u << 15)
+#define INA226_CONFIG_FIXED_BIT (1u << 14)
+#define INA226_MODE_SHUNT_BUS_CONTINUOUS 0x7
+
+#define INA226_MASK_CNVR (1u << 10)
+#define INA226_MASK_CVRF (1u << 3)
+
+#define INA226_SHUNT_LSB_V 2.5e-6f
+#define INA226_BUS_LSB_V 1.25e-3f
+
+#define INA226_AVG_CODE_COUNT 8
+#define INA226_CT_CODE_COUNT 8
+
+static inline uint16_t ina226_avg_count(uint8_t avg_code)
+{
+    static const uint16_t counts[INA226_AVG_CODE_COUNT] = {1, 4, 16, 64, 128, 256, 512, 1024};
+    return counts[avg_code & 0x7];
+}
+
+static inline uint16_t ina226_conversion_time_us(uint8_t ct_code)
+{
+    static const uint16_t times_us[INA226_CT_CODE_COUNT] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+    return times_us[ct_code & 0x7];
+}
+
+static inline uint16_t ina226_config_value(uint8_t avg_code, uint8_t vbus_ct_code, uint8_t vshunt_ct_code)
+{
+    return (uint16_t)(INA226_CONFIG_FIXED_BIT |
+                      ((avg_code & 0x7u) << 9) |
+                      ((vbus_ct_code & 0x7u) << 6) |
+                      ((vshunt_ct_code & 0x7u) << 3) |
+                      INA226_MODE_SHUNT_BUS_CONTINUOUS);
+}
+
+// Time between conversion-ready events in shunt+bus continuous mode.
+static inline uint32_t ina226_conversion_period_us(uint8_t avg_code, uint8_t vbus_ct_code, uint8_t vshunt_ct_code)
+{
+    return (uint32_t)ina226_avg_count(avg_code) *
+           ((uint32_t)ina226_conversion_time_us(vbus_ct_code) + (uint32_t)ina226_conversion_time_us(vshunt_ct_code));
+}
+
+static inline uint32_t ina226_config_period_us(uint16_t config_value)
+{
+    return ina226_conversion_period_us((uint8_t)((config_value >> 9) & 0x7u),
+                                       (uint8_t)((config_value >> 6) & 0x7u),
+                                       (uint8_t)((config_value >> 3) & 0x7u));
+}
@@ -0,0 +1,165 @@
+#include "ina228_driver.h"
+
+static constexpr uint64_t ACCUMULATOR_MASK = (1ULL << INA228_ACCUMULATOR_BITS) - 1;
+
+static uint64_t bigEndian(const uint8_t *data, size_t length)
+{
+  uint64_t value = 0;
+  for (size_t i = 0; i < length; i++) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+static int64_t signed40(uint64_t raw)
+{
+  int64_t value = (int64_t)(raw & ACCUMULATOR_MASK);
+  return (value & (1LL << 39)) ? value - (1LL << 40) : value;
+}
+
+// 20-bit two's complement result in bits 23..4 of a 24-bit register
+static int32_t signed20(const uint8_t *data)
+{
+  int32_t value = (int32_t)(bigEndian(data, 3) >> 4);
+  return (value & 0x80000) ? value - 0x100000 : value;
+}
+
+void Ina228Accumulators::reset()
+{
+  primed_ = false;
+  lastEnergyRaw_ = 0;
+  lastChargeRaw_ = 0;
+  energyCounts_ = 0;
+  chargeCounts_ = 0;
+}
+
+uint32_t Ina228Accumulators::update(uint64_t energyRaw, uint64_t chargeRaw)
+{
+  energyRaw &= ACCUMULATOR_MASK;
+  chargeRaw &= ACCUMULATOR_MASK;
+  if (!primed_) {
+    // First read after a reset: the registers hold everything so far
+    primed_ = true;
+    lastEnergyRaw_ = energyRaw;
+    lastChargeRaw_ = chargeRaw;
+    energyCounts_ = (int64_t)energyRaw;
+    chargeCounts_ = signed40(chargeRaw);
+    return 0;
+  }
+
+  uint32_t wraps = 0;
+
+  // ENERGY only counts up, so going backwards means it wrapped
+  if (energyRaw < lastEnergyRaw_) {
+    wraps++;
+  }
+  energyCounts_ += (int64_t)((energyRaw - lastEnergyRaw_) & ACCUMULATOR_MASK);
+
+  // CHARGE is signed: take the change modulo 2^40 and sign-extend it
+  int64_t chargeDelta = signed40(chargeRaw - lastChargeRaw_);
+  int64_t chargeNow = signed40(chargeRaw);
+  int64_t chargeBefore = signed40(lastChargeRaw_);
+  if ((chargeDelta >= 0) ? (chargeNow < chargeBefore) : (chargeNow > chargeBefore)) {
+    wraps++;
+  }
+  chargeCounts_ += chargeDelta;
+
+  lastEnergyRaw_ = energyRaw;
+  lastChargeRaw_ = chargeRaw;
+  return wraps;
+}
+
+bool Ina228Driver::begin(RegisterBus *bus, uint8_t address, float shuntOhms, float maxCurrentA)
+{
+  bus_ = nullptr;
+  if (bus == nullptr || shuntOhms <= 0.0f || maxCurrentA <= 0.0f) {
+    return false;
+  }
+
+  uint16_t manufacturerId = 0;
+  uint16_t deviceId = 0;
+  if (!bus->readRegister16(address, INA228_REG_MANUFACTURER_ID, &manufacturerId) ||
+      manufacturerId != INA228_MANUFACTURER_ID_TI ||
+      !bus->readRegister16(address, INA228_REG_DEVICE_ID, &deviceId) || (deviceId >> 4) != INA228_DEVICE_ID) {
+    return false;
+  }
+
+  currentLsbA_ = maxCurrentA / (float)(1UL << 19);
+  float shuntCal = INA228_SHUNT_CAL_SCALE * currentLsbA_ * shuntOhms;
+  if (shuntCal < 1.0f || shuntCal > 32767.0f) {
+    return false;
+  }
+  if (!bus->writeRegister16(address, INA228_REG_CONFIG, 0) ||
+      !bus->writeRegister16(address, INA228_REG_SHUNT_CAL, (uint16_t)(shuntCal + 0.5f))) {
+    return false;
+  }
+
+  bus_ = bus;
+  address_ = address;
+  lastSampleBytes_ = 0;
+  overflows_ = 0;
+  accumulators_.reset();
+  return true;
+}
+
+bool Ina228Driver::writeAdcConfig(uint16_t adcConfigValue)
+{
+  return bus_ != nullptr && bus_->writeRegister16(address_, INA228_REG_ADC_CONFIG, adcConfigValue);
+}
+
+bool Ina228Driver::resetAccumulators()
+{
+  if (bus_ == nullptr || !bus_->writeRegister16(address_, INA228_REG_CONFIG, INA228_CONFIG_RSTACC)) {
+    return false;
+  }
+  accumulators_.reset();
+  overflows_ = 0;
+  return true;
+}
+
+bool Ina228Driver::readRegister(uint8_t reg, uint8_t *data, size_t length)
+{
+  return bus_ != nullptr && bus_->readRegisterBytes(address_, reg, data, length);
+}
+
+bool Ina228Driver::read(ina228_reading_t *reading)
+{
+  if (bus_ == nullptr || reading == nullptr) {
+    return false;
+  }
+
+  uint32_t bytesBefore = bus_->bytesMoved();
+  uint8_t vbus[3];
+  uint8_t current[3];
+  bool ok = readRegister(INA228_REG_VBUS, vbus, sizeof(vbus)) &&
+            readRegister(INA228_REG_CURRENT, current, sizeof(current));
+  lastSampleBytes_ = bus_->bytesMoved() - bytesBefore;
+  if (!ok) {
+    return false;
+  }
+
+  // VBUS is always positive; its sign bit is fixed at zero
+  reading->bus_voltage_v = (float)(bigEndian(vbus, 3) >> 4) * INA228_BUS_LSB_V;
+  reading->current_a = (float)signed20(current) * currentLsbA_;
+  return true;
+}
+
+bool Ina228Driver::readTotals(ina228_totals_t *totals)
+{
+  if (totals == nullptr) {
+    return false;
+  }
+
+  uint8_t energy[5];
+  uint8_t charge[5];
+  if (!readRegister(INA228_REG_ENERGY, energy, sizeof(energy)) ||
+      !readRegister(INA228_REG_CHARGE, charge, sizeof(charge))) {
+    return false;
+  }
+
+  overflows_ += accumulators_.update(bigEndian(energy, 5), bigEndian(charge, 5));
+  totals->energy_j = (double)accumulators_.energyCounts() * (double)(INA228_ENERGY_LSB_SCALE * currentLsbA_);
+  totals->charge_c = (double)accumulators_.chargeCounts() * (double)currentLsbA_;
+  totals->overflows = overflows_;
+  return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include "register_bus.h"
+#include "ina228_registers.h"
+
+typedef struct {
+  float bus_voltage_v;
+  float current_a;
+} ina228_reading_t;
+
+// Running totals from the on-chip accumulators since the last reset.
+typedef struct {
+  double energy_j;
+  double charge_c;
+  uint32_t overflows;  // accumulator wraps folded into the totals
+} ina228_totals_t;
+
+// Extends the INA228's 40-bit accumulators to 64 bits. The chip integrates
+// at its own conversion rate and the registers simply wrap; as long as they
+// are read more often than they can wrap twice (years at full scale here),
+// the change since the previous read, taken modulo 2^40, is exact.
+class Ina228Accumulators {
+public:
+  void reset();
+
+  // Raw register values; returns the number of wraps this update folded in.
+  uint32_t update(uint64_t energyRaw, uint64_t chargeRaw);
+
+  int64_t energyCounts() const { return energyCounts_; }
+  int64_t chargeCounts() const { return chargeCounts_; }
+
+private:
+  bool primed_ = false;
+  uint64_t lastEnergyRaw_ = 0;
+  uint64_t lastChargeRaw_ = 0;
+  int64_t energyCounts_ = 0;
+  int64_t chargeCounts_ = 0;
+};
+
+// Register-level INA228 access. begin() is the whole bring-up: it checks the
+// IDs and programs SHUNT_CAL for the given shunt and full-scale current, so
+// CURRENT, ENERGY and CHARGE come back in calibrated units.
+class Ina228Driver {
+public:
+  bool begin(RegisterBus *bus, uint8_t address, float shuntOhms, float maxCurrentA);
+  bool ready() const { return bus_ != nullptr; }
+  uint8_t address() const { return address_; }
+
+  bool writeAdcConfig(uint16_t adcConfigValue);
+  // Zeroes ENERGY and CHARGE on the chip and the extended totals with them.
+  bool resetAccumulators();
+
+  bool read(ina228_reading_t *reading);
+  bool readTotals(ina228_totals_t *totals);
+
+  uint32_t lastSampleBytes() const { return lastSampleBytes_; }
+
+private:
+  bool readRegister(uint8_t reg, uint8_t *data, size_t length);
+
+  RegisterBus *bus_ = nullptr;
+  uint8_t address_ = 0;
+  float currentLsbA_ = 0.0f;
+  uint32_t lastSampleBytes_ = 0;
+  uint32_t overflows_ = 0;
+  Ina228Accumulators accumulators_;
+};
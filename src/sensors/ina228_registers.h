@@ -0,0 +1,53 @@
+#pragma once
+
+// INA228 register map and field helpers (see docs/Sensors/ina228.pdf).
+
+#include <stdint.h>
+
+#define INA228_REG_CONFIG 0x00
+#define INA228_REG_ADC_CONFIG 0x01
+#define INA228_REG_SHUNT_CAL 0x02
+#define INA228_REG_VSHUNT 0x04      // 24-bit
+#define INA228_REG_VBUS 0x05        // 24-bit
+#define INA228_REG_DIETEMP 0x06
+#define INA228_REG_CURRENT 0x07     // 24-bit
+#define INA228_REG_POWER 0x08       // 24-bit
+#define INA228_REG_ENERGY 0x09      // 40-bit, unsigned
+#define INA228_REG_CHARGE 0x0A      // 40-bit, two's complement
+#define INA228_REG_DIAG_ALRT 0x0B
+#define INA228_REG_MANUFACTURER_ID 0x3E
+#define INA228_REG_DEVICE_ID 0x3F
+
+#define INA228_MANUFACTURER_ID_TI 0x5449
+#define INA228_DEVICE_ID 0x228      // DEVICE_ID bits 15..4; 3..0 are the revision
+
+#define INA228_CONFIG_RESET (1u << 15)
+#define INA228_CONFIG_RSTACC (1u << 14)
+
+#define INA228_DIAG_ENERGYOF (1u << 11)
+#define INA228_DIAG_CHARGEOF (1u << 10)
+
+// Continuous bus, shunt and temperature conversions
+#define INA228_MODE_CONTINUOUS_ALL 0xF
+
+// VBUS and CURRENT hold a 20-bit value in bits 23..4
+#define INA228_BUS_LSB_V 195.3125e-6f
+#define INA228_ACCUMULATOR_BITS 40
+
+// SHUNT_CAL = 13107.2e6 * CURRENT_LSB * R_SHUNT with ADCRANGE = 0
+#define INA228_SHUNT_CAL_SCALE 13107.2e6f
+// POWER LSB is 3.2 * CURRENT_LSB; ENERGY LSB is 16 times the POWER LSB
+#define INA228_POWER_LSB_SCALE 3.2f
+#define INA228_ENERGY_LSB_SCALE (16.0f * INA228_POWER_LSB_SCALE)
+
+// ADC_CONFIG takes the same 3-bit averaging and conversion-time codes as
+// the INA226 CONFIG register, in different fields (the INA228 times for
+// each code are shorter).
+static inline uint16_t ina228_adc_config_value(uint8_t avg_code, uint8_t vbus_ct_code, uint8_t vshunt_ct_code)
+{
+    return (uint16_t)((INA228_MODE_CONTINUOUS_ALL << 12) |
+                      ((vbus_ct_code & 0x7u) << 9) |
+                      ((vshunt_ct_code & 0x7u) << 6) |
+                      ((vshunt_ct_code & 0x7u) << 3) |  // die temperature tracks the shunt
+                      (avg_code & 0x7u));
+}
@@ -0,0 +1,52 @@
+#include "ina3221_driver.h"
+
+bool Ina3221Driver::begin(RegisterBus *bus, uint8_t address, float shuntOhms)
+{
+  bus_ = nullptr;
+  if (bus == nullptr || shuntOhms <= 0.0f) {
+    return false;
+  }
+
+  uint16_t manufacturerId = 0;
+  uint16_t dieId = 0;
+  if (!bus->readRegister16(address, INA3221_REG_MANUFACTURER_ID, &manufacturerId) ||
+      manufacturerId != INA3221_MANUFACTURER_ID_TI ||
+      !bus->readRegister16(address, INA3221_REG_DIE_ID, &dieId) || dieId != INA3221_DIE_ID) {
+    return false;
+  }
+
+  bus_ = bus;
+  address_ = address;
+  lastSampleBytes_ = 0;
+  currentPerShuntLsb_ = INA3221_SHUNT_LSB_V / shuntOhms;
+  return true;
+}
+
+bool Ina3221Driver::writeConfig(uint16_t configValue)
+{
+  return bus_ != nullptr && bus_->writeRegister16(address_, INA3221_REG_CONFIG, configValue);
+}
+
+bool Ina3221Driver::read(ina3221_reading_t *reading)
+{
+  if (bus_ == nullptr || reading == nullptr) {
+    return false;
+  }
+
+  uint32_t bytesBefore = bus_->bytesMoved();
+  bool ok = true;
+  for (uint8_t ch = 0; ch < INA3221_CHANNEL_COUNT && ok; ch++) {
+    uint16_t shuntRaw = 0;
+    uint16_t busRaw = 0;
+    ok = bus_->readRegister16(address_, INA3221_REG_SHUNT_VOLTAGE(ch), &shuntRaw) &&
+         bus_->readRegister16(address_, INA3221_REG_BUS_VOLTAGE(ch), &busRaw);
+
+    // Arithmetic shift keeps the sign of the 13-bit field
+    int16_t shuntCounts = (int16_t)((int16_t)shuntRaw >> 3);
+    int16_t busCounts = (int16_t)((int16_t)busRaw >> 3);
+    reading->current_a[ch] = (float)shuntCounts * currentPerShuntLsb_;
+    reading->bus_voltage_v[ch] = (float)busCounts * INA3221_BUS_LSB_V;
+  }
+  lastSampleBytes_ = bus_->bytesMoved() - bytesBefore;
+  return ok;
+}
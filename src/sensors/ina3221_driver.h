@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include "register_bus.h"
+#include "ina3221_registers.h"
+
+// One pass over all three channels.
+typedef struct {
+  float bus_voltage_v[INA3221_CHANNEL_COUNT];
+  float current_a[INA3221_CHANNEL_COUNT];
+} ina3221_reading_t;
+
+// Register-level INA3221 access. There is no UnitUnified component for this
+// part, so begin() is the whole bring-up: it checks the IDs and leaves the
+// device in its power-on configuration until writeConfig().
+//
+// read() walks the six result registers in channel order in one go, so the
+// three channels of a reading share one timestamp and one sample sequence.
+class Ina3221Driver {
+public:
+  bool begin(RegisterBus *bus, uint8_t address, float shuntOhms);
+  bool ready() const { return bus_ != nullptr; }
+  uint8_t address() const { return address_; }
+
+  bool writeConfig(uint16_t configValue);
+  bool read(ina3221_reading_t *reading);
+
+  // Bus bytes (address bytes included) used by the most recent read().
+  uint32_t lastSampleBytes() const { return lastSampleBytes_; }
+
+private:
+  RegisterBus *bus_ = nullptr;
+  uint8_t address_ = 0;
+  float currentPerShuntLsb_ = 0.0f;
+  uint32_t lastSampleBytes_ = 0;
+};
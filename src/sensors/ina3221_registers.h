@@ -0,0 +1,45 @@
+#pragma once
+
+// INA3221 register map and field helpers (see docs/Sensors/ina3221.pdf).
+// The averaging and conversion-time codes are the INA226 ones, so the
+// timing tables in ina226_registers.h apply unchanged.
+
+#include <stdint.h>
+
+#include "ina226_registers.h"
+
+#define INA3221_CHANNEL_COUNT 3
+
+#define INA3221_REG_CONFIG 0x00
+#define INA3221_REG_SHUNT_VOLTAGE(ch) (uint8_t)(0x01 + 2 * (ch))
+#define INA3221_REG_BUS_VOLTAGE(ch) (uint8_t)(0x02 + 2 * (ch))
+#define INA3221_REG_MASK_ENABLE 0x0F
+#define INA3221_REG_MANUFACTURER_ID 0xFE
+#define INA3221_REG_DIE_ID 0xFF
+
+#define INA3221_MANUFACTURER_ID_TI 0x5449
+#define INA3221_DIE_ID 0x3220
+
+#define INA3221_CONFIG_RESET (1u << 15)
+#define INA3221_CONFIG_ALL_CHANNELS (0x7u << 12)
+#define INA3221_MODE_SHUNT_BUS_CONTINUOUS 0x7
+
+// Both result registers hold a 13-bit signed value in bits 15..3
+#define INA3221_SHUNT_LSB_V 40e-6f
+#define INA3221_BUS_LSB_V 8e-3f
+
+static inline uint16_t ina3221_config_value(uint8_t avg_code, uint8_t vbus_ct_code, uint8_t vshunt_ct_code)
+{
+    return (uint16_t)(INA3221_CONFIG_ALL_CHANNELS |
+                      ((avg_code & 0x7u) << 9) |
+                      ((vbus_ct_code & 0x7u) << 6) |
+                      ((vshunt_ct_code & 0x7u) << 3) |
+                      INA3221_MODE_SHUNT_BUS_CONTINUOUS);
+}
+
+// The three channels convert one after another, so a full set of fresh
+// readings takes three INA226-style conversion periods.
+static inline uint32_t ina3221_config_period_us(uint16_t config_value)
+{
+    return INA3221_CHANNEL_COUNT * ina226_config_period_us(config_value);
+}
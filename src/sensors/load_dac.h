@@ -0,0 +1,36 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// The analog output that sets the electronic load. Callers work in the
+// part's native codes, so control loops quantize and de-duplicate at the
+// resolution that is actually fitted rather than at a fixed step.
+class LoadDac {
+public:
+  virtual ~LoadDac() = default;
+
+  virtual const char *name() const = 0;
+  virtual bool ready() const = 0;
+  virtual uint8_t bits() const = 0;
+  virtual float fullScaleV() const = 0;
+
+  // Set the load channel in a single bus transaction; any other channel
+  // the part has is parked at zero in the same transaction.
+  virtual bool writeLoadCode(uint16_t code) = 0;
+
+  uint16_t maxCode() const { return (uint16_t)((1u << bits()) - 1u); }
+  float lsbV() const { return fullScaleV() / (float)maxCode(); }
+
+  // Nearest code for volts, clamped to the output range.
+  uint16_t codeFor(float volts) const
+  {
+    if (!(volts > 0.0f)) {
+      return 0;
+    }
+    float code = volts / lsbV();
+    return (code >= (float)maxCode()) ? maxCode() : (uint16_t)lroundf(code);
+  }
+
+  float voltsFor(uint16_t code) const { return (float)code * lsbV(); }
+};
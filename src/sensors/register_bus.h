@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal register access used by the lean sensor drivers. The
+// firmware backs it with Wire; host tests can back it with a simulated
+// register file.
+//
+// Implementations count every byte they put on the wire (address bytes
+// included) so drivers can report the bus cost of a sample.
+class RegisterBus {
+public:
+  virtual ~RegisterBus() = default;
+
+  virtual bool writeRegister16(uint8_t address, uint8_t reg, uint16_t value) = 0;
+  virtual bool readRegister16(uint8_t address, uint8_t reg, uint16_t *value) = 0;
+
+  // Read the register the device pointer already selects, skipping the
+  // pointer write. Only valid for devices that keep their pointer between
+  // transactions (INA226 does).
+  virtual bool readSelectedRegister16(uint8_t address, uint16_t *value) = 0;
+
+  // Read a register wider than 16 bits (INA228 24- and 40-bit results),
+  // most significant byte first.
+  virtual bool readRegisterBytes(uint8_t address, uint8_t reg, uint8_t *data, size_t length) = 0;
+
+  // Write length bytes after the register/command byte in one transaction,
+  // in the order given (GP8413 data is little-endian).
+  virtual bool writeRegisterBytes(uint8_t address, uint8_t reg, const uint8_t *data, size_t length) = 0;
+
+  uint32_t bytesMoved() const { return bytesMoved_; }
+
+protected:
+  void countBytes(uint32_t count) { bytesMoved_ += count; }
+
+private:
+  uint32_t bytesMoved_ = 0;
+};
@@ -0,0 +1,79 @@
+#include "wire_register_bus.h"
+
+bool WireRegisterBus::writeRegister16(uint8_t address, uint8_t reg, uint16_t value)
+{
+  countBytes(4);
+  wire_.beginTransmission(address);
+  wire_.write(reg);
+  wire_.write((uint8_t)(value >> 8));
+  wire_.write((uint8_t)(value & 0xFF));
+  return wire_.endTransmission() == 0;
+}
+
+bool WireRegisterBus::readRegister16(uint8_t address, uint8_t reg, uint16_t *value)
+{
+  if (value == nullptr) {
+    return false;
+  }
+
+  countBytes(2);
+  wire_.beginTransmission(address);
+  wire_.write(reg);
+  if (wire_.endTransmission(false) != 0) {
+    return false;
+  }
+
+  return readSelectedRegister16(address, value);
+}
+
+bool WireRegisterBus::readSelectedRegister16(uint8_t address, uint16_t *value)
+{
+  if (value == nullptr) {
+    return false;
+  }
+
+  countBytes(3);
+  if (wire_.requestFrom(address, (size_t)2) != 2) {
+    return false;
+  }
+
+  uint16_t msb = (uint16_t)wire_.read();
+  uint16_t lsb = (uint16_t)wire_.read();
+  *value = (uint16_t)((msb << 8) | lsb);
+  return true;
+}
+
+bool WireRegisterBus::readRegisterBytes(uint8_t address, uint8_t reg, uint8_t *data, size_t length)
+{
+  if (data == nullptr || length == 0) {
+    return false;
+  }
+
+  countBytes(2 + 1 + (uint32_t)length);
+  wire_.beginTransmission(address);
+  wire_.write(reg);
+  if (wire_.endTransmission(false) != 0) {
+    return false;
+  }
+  if (wire_.requestFrom(address, length) != length) {
+    return false;
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    data[i] = (uint8_t)wire_.read();
+  }
+  return true;
+}
+
+bool WireRegisterBus::writeRegisterBytes(uint8_t address, uint8_t reg, const uint8_t *data, size_t length)
+{
+  if (data == nullptr || length == 0) {
+    return false;
+  }
+
+  countBytes(2 + (uint32_t)length);
+  wire_.beginTransmission(address);
+  wire_.write(reg);
+  wire_.write(data, length);
+  return wire_.endTransmission() == 0;
+}
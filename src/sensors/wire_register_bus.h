@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Wire.h>
+#include "register_bus.h"
+
+// RegisterBus over an Arduino TwoWire port. Registers are big-endian and
+// reads use a repeated start between the pointer write and the data.
+class WireRegisterBus : public RegisterBus {
+public:
+  explicit WireRegisterBus(TwoWire &wire) : wire_(wire) {}
+
+  bool writeRegister16(uint8_t address, uint8_t reg, uint16_t value) override;
+  bool readRegister16(uint8_t address, uint8_t reg, uint16_t *value) override;
+  bool readSelectedRegister16(uint8_t address, uint16_t *value) override;
+  bool readRegisterBytes(uint8_t address, uint8_t reg, uint8_t *data, size_t length) override;
+  bool writeRegisterBytes(uint8_t address, uint8_t reg, const uint8_t *data, size_t length) override;
+
+private:
+  TwoWire &wire_;
+};
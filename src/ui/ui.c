@@ -4,8 +4,14 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "../battery/battery_chemistry.h"
+#include "../sensors/ina226_registers.h"
+#include "ui_events.h"
+
 #define METRIC_COUNT 5
 #define HISTORY_MAX 900
+#define TRIGGER_LEVEL_MAX_MA 10000.0f
+#define TRIGGER_LEVEL_MAX_V 36.0f
 
 typedef enum {
     METRIC_VOLTAGE = 0,
@@ -17,13 +23,40 @@ typedef enum {
 
 static lv_obj_t *screen_monitor;
 static lv_obj_t *screen_config;
+static lv_obj_t *screen_stats;
 
 static lv_obj_t *value_voltage;
 static lv_obj_t *value_current;
 static lv_obj_t *value_power;
 static lv_obj_t *value_energy;
+static lv_obj_t *value_charge;
 static lv_obj_t *value_load_temp;
 static lv_obj_t *sensor_status_label;
+static lv_obj_t *capacity_label;
+
+enum {
+    STAT_COLUMN_MIN = 0,
+    STAT_COLUMN_MAX,
+    STAT_COLUMN_MEAN,
+    STAT_COLUMN_RMS,
+    STAT_COLUMN_STDDEV,
+    STAT_COLUMN_COUNT
+};
+
+enum {
+    STAT_SPAN_TEST = 0,
+    STAT_SPAN_WINDOW,
+    STAT_SPAN_COUNT
+};
+
+static lv_obj_t *stats_title_label;
+static lv_obj_t *stats_span_labels[STAT_SPAN_COUNT];
+static lv_obj_t *stats_name_labels[STAT_SPAN_COUNT][UI_STAT_COUNT];
+static lv_obj_t *stats_cells[STAT_SPAN_COUNT][UI_STAT_COUNT][STAT_COLUMN_COUNT];
+static ui_channel_stats_t channel_stats[UI_CHANNEL_COUNT];
+static lv_obj_t *channel_title_label;
+static lv_obj_t *channel_nav_row;
+static lv_obj_t *channel_nav_buttons[UI_CHANNEL_COUNT];
 
 static lv_obj_t *chart_obj;
 static lv_chart_series_t *chart_series[METRIC_COUNT];
@@ -37,34 +70,76 @@ static lv_obj_t *dropdown_sensor;
 static lv_obj_t *dropdown_units;
 static lv_obj_t *dropdown_battery_type;
 static lv_obj_t *dropdown_load_type;
+static lv_obj_t *value_load_setpoint;
+static char load_profile_summary[32] = "--";
 static lv_obj_t *switch_graph_voltage;
 static lv_obj_t *switch_graph_current;
 static lv_obj_t *switch_graph_power;
 static lv_obj_t *switch_graph_energy;
 static lv_obj_t *switch_graph_load_temp;
 static lv_obj_t *value_sample_interval;
+static lv_obj_t *value_temp_interval;
 static lv_obj_t *value_overtemp_cutoff;
 static lv_obj_t *value_battery_ampacity;
 static lv_obj_t *dropdown_series_cells;
 static lv_obj_t *value_series_cells;
 static lv_obj_t *value_pack_cutoff_preview;
-
-static bool reset_requested = false;
-static bool start_requested = false;
-static bool stop_requested = false;
+static lv_obj_t *dropdown_ina_preset;
+static lv_obj_t *value_effective_rate;
+static lv_obj_t *dropdown_trigger_source;
+static lv_obj_t *dropdown_trigger_mode;
+static lv_obj_t *value_trigger_level;
+
+// One bit per channel
+static uint8_t reset_requested = 0;
+static uint8_t start_requested = 0;
+static uint8_t stop_requested = 0;
 static bool config_update_pending = false;
 static lv_obj_t *start_button_label = NULL;
 static lv_obj_t *start_button_obj = NULL;
 static lv_obj_t *stop_button_obj = NULL;
 
-static uint16_t history_count = 0;
-static uint32_t history_sample_counter = 0;
-static uint16_t history_stride = 1;
-static float history_raw[METRIC_COUNT][HISTORY_MAX];
+static bool capture_requested = false;
+static bool trigger_requested = false;
+static lv_obj_t *trigger_button_label = NULL;
+static bool capture_view_active = false;
+static lv_obj_t *capture_status_label = NULL;
+static lv_obj_t *capture_live_button = NULL;
+
+typedef struct {
+    float raw[METRIC_COUNT][HISTORY_MAX];
+    float min[METRIC_COUNT];  // range of raw[] over count points
+    float max[METRIC_COUNT];
+    uint16_t count;
+    uint32_t sample_counter;
+    uint16_t stride;
+    ui_channel_data_t latest;
+    bool latest_valid;
+} channel_history_t;
+
+// Every channel keeps its own raw history. The chart coordinates exist once
+// and only ever hold the channel on screen, so an extra channel costs its
+// raw floats and nothing else, and only the shown channel is rescaled.
+static channel_history_t channel_history[UI_CHANNEL_COUNT];
 static lv_coord_t history_chart[METRIC_COUNT][HISTORY_MAX];
+static uint8_t displayed_channel = 0;
 
-static ui_channel_data_t latest_data;
-static bool latest_data_valid = false;
+// How each series in history_chart is scaled. An append that leaves a
+// metric's range alone writes one coordinate; only a metric whose range grew
+// is rebuilt. chart_points counts the coordinates that match, and 0 forces
+// a full rebuild.
+typedef struct {
+    float min;
+    float max;
+    float center;
+    float half_span;
+} chart_scale_t;
+
+static chart_scale_t chart_scale[METRIC_COUNT];
+static uint16_t chart_points = 0;
+
+// Burst captures only chart voltage and current
+static lv_coord_t capture_chart[METRIC_CURRENT + 1][HISTORY_MAX];
 
 static ui_config_t active_config = {
     .sensor_type = UI_SENSOR_INA226_1A,
@@ -76,7 +151,31 @@ static ui_config_t active_config = {
     .cutoff_voltage_v = 10.0f,
     .overtemp_cutoff_c = 60.0f,
     .rated_battery_ampacity_ah = 100.0f,
-    .num_series_cells = 4
+    .num_series_cells = 4,
+    .ina_preset = UI_INA_PRESET_BALANCED,
+    .ina_avg_code = 2,
+    .ina_vbus_ct_code = 4,
+    .ina_vshunt_ct_code = 4,
+    .trigger_source = UI_TRIGGER_SOURCE_CURRENT,
+    .trigger_mode = UI_TRIGGER_RISING_EDGE,
+    .trigger_level = 100.0f,
+    .temp_interval_ms = 1000,
+    .load_current_a = 1.0f,
+    .load_power_w = 5.0f,
+    .load_resistance_ohm = 10.0f
+};
+
+typedef struct {
+    uint8_t avg_code;
+    uint8_t vbus_ct_code;
+    uint8_t vshunt_ct_code;
+} ina_preset_timing_t;
+
+// INA226 averaging / conversion-time codes behind each preset
+static const ina_preset_timing_t ina_preset_timings[] = {
+    [UI_INA_PRESET_FAST_TRANSIENT] = {0, 0, 0},  // 1 avg, 140 us + 140 us
+    [UI_INA_PRESET_BALANCED] = {2, 4, 4},        // 16 avg, 1.1 ms + 1.1 ms
+    [UI_INA_PRESET_LOW_NOISE] = {3, 6, 6}        // 64 avg, 4.156 ms + 4.156 ms
 };
 
 static ui_config_t pending_config;
@@ -153,50 +252,132 @@ static void apply_values(const ui_channel_data_t *data)
     set_value_text(value_current, data->current_ma, 2, "mA");
     set_value_text(value_power, data->power_w, 3, "W");
     set_value_text(value_energy, data->energy_wh, 4, "Wh");
+    set_value_text(value_charge, data->charge_ah, 4, "Ah");
     set_temp_text(value_load_temp, data->load_temp_f);
 }
 
-static void clear_history(void)
+static void apply_displayed_values(void)
 {
-    history_count = 0;
-    history_sample_counter = 0;
-    history_stride = 1;
-    for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
-        memset(history_raw[metric], 0, sizeof(history_raw[metric]));
-        memset(history_chart[metric], 0, sizeof(history_chart[metric]));
+    const channel_history_t *history = &channel_history[displayed_channel];
+    if (history->latest_valid) {
+        apply_values(&history->latest);
+    } else {
+        ui_channel_data_t empty = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, NAN};
+        apply_values(&empty);
+    }
+}
+
+static void clear_history(uint8_t channel)
+{
+    channel_history_t *history = &channel_history[channel];
+    history->count = 0;
+    history->sample_counter = 0;
+    history->stride = 1;
+    memset(history->raw, 0, sizeof(history->raw));
+    if (channel == displayed_channel) {
+        memset(history_chart, 0, sizeof(history_chart));
+        refresh_chart();
+    }
+}
+
+static void clear_all_history(void)
+{
+    for (uint8_t channel = 0; channel < UI_CHANNEL_COUNT; channel++) {
+        clear_history(channel);
     }
-    refresh_chart();
 }
 
-static void compress_history(void)
+// Only the raw values are halved: refresh_chart() rebuilds the coordinates
+// of the shown channel from them.
+static void compress_history(channel_history_t *history)
 {
-    if (history_count < 2) {
+    if (history->count < 2) {
         return;
     }
 
+    // Averaging pulls the extremes in, so the range is taken afresh
     for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+        float *raw = history->raw[metric];
         uint16_t dst = 0;
-        for (uint16_t src = 0; src < history_count; src += 2) {
-            float r0 = history_raw[metric][src];
-            float r1 = (src + 1 < history_count) ? history_raw[metric][src + 1] : r0;
-            history_raw[metric][dst] = (r0 + r1) * 0.5f;
-
-            lv_coord_t v0 = history_chart[metric][src];
-            lv_coord_t v1 = (src + 1 < history_count) ? history_chart[metric][src + 1] : v0;
-            history_chart[metric][dst++] = (lv_coord_t)((v0 + v1) / 2);
+        for (uint16_t src = 0; src < history->count; src += 2) {
+            float r0 = raw[src];
+            float r1 = (src + 1 < history->count) ? raw[src + 1] : r0;
+            float v = (r0 + r1) * 0.5f;
+            if (dst == 0 || v < history->min[metric]) {
+                history->min[metric] = v;
+            }
+            if (dst == 0 || v > history->max[metric]) {
+                history->max[metric] = v;
+            }
+            raw[dst++] = v;
         }
     }
 
-    history_count = (uint16_t)((history_count + 1) / 2);
-    history_stride = (uint16_t)(history_stride * 2);
+    history->count = (uint16_t)((history->count + 1) / 2);
+    history->stride = (uint16_t)(history->stride * 2);
+}
+
+// Writes the point at history->count and widens the running range; the
+// caller bumps count once every metric is in.
+static void history_append(channel_history_t *history, uint8_t metric, float value)
+{
+    uint16_t idx = history->count;
+    history->raw[metric][idx] = value;
+    if (idx == 0 || value < history->min[metric]) {
+        history->min[metric] = value;
+    }
+    if (idx == 0 || value > history->max[metric]) {
+        history->max[metric] = value;
+    }
+}
+
+static void chart_span(float minv, float maxv, float *center, float *half_span)
+{
+    *center = (minv + maxv) * 0.5f;
+    *half_span = (maxv - minv) * 0.5f;
+    if (*half_span < 0.0001f) {
+        float abs_center = *center < 0.0f ? -*center : *center;
+        *half_span = (abs_center * 0.1f);
+        if (*half_span < 0.01f) {
+            *half_span = 0.01f;
+        }
+    }
+}
+
+static lv_coord_t chart_coord(float value, float center, float half_span)
+{
+    float normalized = (value - center) / half_span;
+    if (normalized > 1.2f) {
+        normalized = 1.2f;
+    } else if (normalized < -1.2f) {
+        normalized = -1.2f;
+    }
+    return (lv_coord_t)(normalized * 900.0f);
+}
+
+// Scale one metric to its history's range and rewrite its coordinates.
+static void rescale_chart_metric(const channel_history_t *history, uint8_t metric)
+{
+    chart_scale_t *scale = &chart_scale[metric];
+    scale->min = history->min[metric];
+    scale->max = history->max[metric];
+    chart_span(scale->min, scale->max, &scale->center, &scale->half_span);
+
+    const float *raw = history->raw[metric];
+    for (uint16_t i = 0; i < history->count; i++) {
+        history_chart[metric][i] = chart_coord(raw[i], scale->center, scale->half_span);
+    }
 }
 
 static void refresh_chart(void)
 {
-    if (chart_obj == NULL) {
+    if (chart_obj == NULL || capture_view_active) {
         return;
     }
 
+    const channel_history_t *history = &channel_history[displayed_channel];
+    uint16_t history_count = history->count;
+    chart_points = 0;
     if (history_count == 0) {
         lv_chart_set_point_count(chart_obj, 1);
         for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
@@ -211,44 +392,43 @@ static void refresh_chart(void)
     lv_chart_set_div_line_count(chart_obj, 9, 8);
 
     for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
-        float minv = history_raw[metric][0];
-        float maxv = history_raw[metric][0];
+        rescale_chart_metric(history, metric);
+    }
+    chart_points = history_count;
 
-        for (uint16_t i = 1; i < history_count; i++) {
-            float v = history_raw[metric][i];
-            if (v < minv) {
-                minv = v;
-            }
-            if (v > maxv) {
-                maxv = v;
-            }
-        }
+    lv_chart_set_range(chart_obj, LV_CHART_AXIS_PRIMARY_Y, -1000, 1000);
+    for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+        lv_chart_set_x_start_point(chart_obj, chart_series[metric], 0);
+    }
+    lv_chart_refresh(chart_obj);
+}
 
-        float center = (minv + maxv) * 0.5f;
-        float half_span = (maxv - minv) * 0.5f;
-        if (half_span < 0.0001f) {
-            float abs_center = center < 0.0f ? -center : center;
-            half_span = (abs_center * 0.1f);
-            if (half_span < 0.01f) {
-                half_span = 0.01f;
-            }
-        }
+// The shown channel gained one point at the end. Adding a point moves every
+// x position, so the chart still redraws in full; what this saves is the
+// range scan and the coordinates of every metric whose range held.
+static void append_chart_point(const channel_history_t *history)
+{
+    if (chart_obj == NULL || capture_view_active) {
+        return;
+    }
 
-        for (uint16_t i = 0; i < history_count; i++) {
-            float normalized = (history_raw[metric][i] - center) / half_span;
-            if (normalized > 1.2f) {
-                normalized = 1.2f;
-            } else if (normalized < -1.2f) {
-                normalized = -1.2f;
-            }
-            history_chart[metric][i] = (lv_coord_t)(normalized * 900.0f);
-        }
+    uint16_t idx = (uint16_t)(history->count - 1);
+    if (chart_points == 0 || chart_points != idx) {
+        refresh_chart();
+        return;
     }
 
-    lv_chart_set_range(chart_obj, LV_CHART_AXIS_PRIMARY_Y, -1000, 1000);
     for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
-        lv_chart_set_x_start_point(chart_obj, chart_series[metric], 0);
+        const chart_scale_t *scale = &chart_scale[metric];
+        if (history->min[metric] != scale->min || history->max[metric] != scale->max) {
+            rescale_chart_metric(history, metric);
+        } else {
+            history_chart[metric][idx] = chart_coord(history->raw[metric][idx], scale->center, scale->half_span);
+        }
     }
+    chart_points = history->count;
+
+    lv_chart_set_point_count(chart_obj, history->count);
     lv_chart_refresh(chart_obj);
 }
 
@@ -405,35 +585,41 @@ static void apply_chart_visibility(void)
         return;
     }
 
-    lv_chart_hide_series(chart_obj, chart_series[METRIC_VOLTAGE], (active_config.graph_trace_mask & UI_GRAPH_TRACE_VOLTAGE) == 0);
-    lv_chart_hide_series(chart_obj, chart_series[METRIC_CURRENT], (active_config.graph_trace_mask & UI_GRAPH_TRACE_CURRENT) == 0);
-    lv_chart_hide_series(chart_obj, chart_series[METRIC_POWER], (active_config.graph_trace_mask & UI_GRAPH_TRACE_POWER) == 0);
-    lv_chart_hide_series(chart_obj, chart_series[METRIC_ENERGY], (active_config.graph_trace_mask & UI_GRAPH_TRACE_ENERGY) == 0);
-    lv_chart_hide_series(chart_obj, chart_series[METRIC_LOAD_TEMP], (active_config.graph_trace_mask & UI_GRAPH_TRACE_LOAD_TEMP) == 0);
+    // A burst capture only carries voltage and current
+    uint8_t mask = active_config.graph_trace_mask;
+    if (capture_view_active) {
+        mask = UI_GRAPH_TRACE_VOLTAGE | UI_GRAPH_TRACE_CURRENT;
+    }
+
+    lv_chart_hide_series(chart_obj, chart_series[METRIC_VOLTAGE], (mask & UI_GRAPH_TRACE_VOLTAGE) == 0);
+    lv_chart_hide_series(chart_obj, chart_series[METRIC_CURRENT], (mask & UI_GRAPH_TRACE_CURRENT) == 0);
+    lv_chart_hide_series(chart_obj, chart_series[METRIC_POWER], (mask & UI_GRAPH_TRACE_POWER) == 0);
+    lv_chart_hide_series(chart_obj, chart_series[METRIC_ENERGY], (mask & UI_GRAPH_TRACE_ENERGY) == 0);
+    lv_chart_hide_series(chart_obj, chart_series[METRIC_LOAD_TEMP], (mask & UI_GRAPH_TRACE_LOAD_TEMP) == 0);
 
     if (scale_label_voltage != NULL) {
         lv_obj_set_style_text_opa(scale_label_voltage,
-                                  (active_config.graph_trace_mask & UI_GRAPH_TRACE_VOLTAGE) ? LV_OPA_COVER : LV_OPA_40,
+                                  (mask & UI_GRAPH_TRACE_VOLTAGE) ? LV_OPA_COVER : LV_OPA_40,
                                   LV_PART_MAIN);
     }
     if (scale_label_current != NULL) {
         lv_obj_set_style_text_opa(scale_label_current,
-                                  (active_config.graph_trace_mask & UI_GRAPH_TRACE_CURRENT) ? LV_OPA_COVER : LV_OPA_40,
+                                  (mask & UI_GRAPH_TRACE_CURRENT) ? LV_OPA_COVER : LV_OPA_40,
                                   LV_PART_MAIN);
     }
     if (scale_label_power != NULL) {
         lv_obj_set_style_text_opa(scale_label_power,
-                                  (active_config.graph_trace_mask & UI_GRAPH_TRACE_POWER) ? LV_OPA_COVER : LV_OPA_40,
+                                  (mask & UI_GRAPH_TRACE_POWER) ? LV_OPA_COVER : LV_OPA_40,
                                   LV_PART_MAIN);
     }
     if (scale_label_energy != NULL) {
         lv_obj_set_style_text_opa(scale_label_energy,
-                                  (active_config.graph_trace_mask & UI_GRAPH_TRACE_ENERGY) ? LV_OPA_COVER : LV_OPA_40,
+                                  (mask & UI_GRAPH_TRACE_ENERGY) ? LV_OPA_COVER : LV_OPA_40,
                                   LV_PART_MAIN);
     }
     if (scale_label_load_temp != NULL) {
         lv_obj_set_style_text_opa(scale_label_load_temp,
-                                  (active_config.graph_trace_mask & UI_GRAPH_TRACE_LOAD_TEMP) ? LV_OPA_COVER : LV_OPA_40,
+                                  (mask & UI_GRAPH_TRACE_LOAD_TEMP) ? LV_OPA_COVER : LV_OPA_40,
                                   LV_PART_MAIN);
     }
 
@@ -442,27 +628,21 @@ static void apply_chart_visibility(void)
 
 static float battery_cutoff_per_cell(const ui_battery_type_t type)
 {
-    switch (type) {
-        case UI_BATTERY_ALKALINE:
-        case UI_BATTERY_DRY_CELL:
-            return 0.9f;
-        case UI_BATTERY_LEAD_ACID:
-        case UI_BATTERY_SLA:
-            return 1.93f;
-        case UI_BATTERY_AGM:
-            return 1.75f;
-        case UI_BATTERY_NICD:
-        case UI_BATTERY_NIMH:
-            return 1.2f;
-        case UI_BATTERY_LITHIUM_PRIMARY:
-            return 2.0f;
-        case UI_BATTERY_LITHIUM_ION:
-        case UI_BATTERY_LIPO:
-            return 3.5f;
-        case UI_BATTERY_LIFEPO4:
-        default:
-            return 2.5f;
-    }
+    return battery_chemistry((uint8_t)type)->cutoff_v;
+}
+
+static void format_effective_rate(char *out, size_t out_size, const ui_config_t *config)
+{
+    char number_rate[24];
+    char number_conv[24];
+    uint32_t conv_period_us = ina226_conversion_period_us(config->ina_avg_code, config->ina_vbus_ct_code, config->ina_vshunt_ct_code);
+    float conv_rate_hz = 1000000.0f / (float)conv_period_us;
+    float sample_rate_hz = 1000.0f / (float)config->sample_interval_ms;
+    float effective_hz = conv_rate_hz < sample_rate_hz ? conv_rate_hz : sample_rate_hz;
+
+    format_fixed(number_rate, sizeof(number_rate), effective_hz, 1);
+    format_fixed(number_conv, sizeof(number_conv), (float)conv_period_us / 1000.0f, 1);
+    snprintf(out, out_size, "%s Hz (%s ms/conv)", number_rate, number_conv);
 }
 
 static void refresh_config_values(void)
@@ -484,6 +664,40 @@ static void refresh_config_values(void)
         snprintf(buffer, sizeof(buffer), "%u ms", (unsigned)pending_config.sample_interval_ms);
         lv_label_set_text(value_sample_interval, buffer);
     }
+    if (value_temp_interval != NULL) {
+        char number[24];
+        char buffer[32];
+        format_fixed(number, sizeof(number), (float)pending_config.temp_interval_ms / 1000.0f, 2);
+        snprintf(buffer, sizeof(buffer), "%s s", number);
+        lv_label_set_text(value_temp_interval, buffer);
+    }
+    if (dropdown_ina_preset != NULL) {
+        lv_dropdown_set_selected(dropdown_ina_preset, (uint16_t)pending_config.ina_preset);
+    }
+    if (value_effective_rate != NULL) {
+        // Two 23-character numbers plus the text around them
+        char buffer[64];
+        format_effective_rate(buffer, sizeof(buffer), &pending_config);
+        lv_label_set_text(value_effective_rate, buffer);
+    }
+    if (dropdown_trigger_source != NULL) {
+        lv_dropdown_set_selected(dropdown_trigger_source, (uint16_t)pending_config.trigger_source);
+    }
+    if (dropdown_trigger_mode != NULL) {
+        lv_dropdown_set_selected(dropdown_trigger_mode, (uint16_t)pending_config.trigger_mode);
+    }
+    if (value_trigger_level != NULL) {
+        char number[24];
+        char buffer[32];
+        if (pending_config.trigger_source == UI_TRIGGER_SOURCE_VOLTAGE) {
+            format_fixed(number, sizeof(number), pending_config.trigger_level, 1);
+            snprintf(buffer, sizeof(buffer), "%s V", number);
+        } else {
+            format_fixed(number, sizeof(number), pending_config.trigger_level, 0);
+            snprintf(buffer, sizeof(buffer), "%s mA", number);
+        }
+        lv_label_set_text(value_trigger_level, buffer);
+    }
 
     if (value_overtemp_cutoff != NULL) {
         char number[24];
@@ -499,6 +713,30 @@ static void refresh_config_values(void)
         lv_label_set_text(value_overtemp_cutoff, buffer);
     }
 
+    if (value_load_setpoint != NULL) {
+        char number[24];
+        char buffer[32];
+        switch (pending_config.load_type) {
+            case UI_LOAD_CONSTANT_CURRENT:
+                format_fixed(number, sizeof(number), pending_config.load_current_a, 1);
+                snprintf(buffer, sizeof(buffer), "%s A", number);
+                break;
+            case UI_LOAD_CONSTANT_POWER:
+                format_fixed(number, sizeof(number), pending_config.load_power_w, 1);
+                snprintf(buffer, sizeof(buffer), "%s W", number);
+                break;
+            case UI_LOAD_CONSTANT_IMPEDANCE:
+                format_fixed(number, sizeof(number), pending_config.load_resistance_ohm, 1);
+                snprintf(buffer, sizeof(buffer), "%s ohm", number);
+                break;
+            case UI_LOAD_PULSED:
+            default:
+                snprintf(buffer, sizeof(buffer), "%s", load_profile_summary);
+                break;
+        }
+        lv_label_set_text(value_load_setpoint, buffer);
+    }
+
     if (value_battery_ampacity != NULL) {
         char number[24];
         char buffer[32];
@@ -524,17 +762,184 @@ static void refresh_config_values(void)
     }
 }
 
+// Peak-preserving decimation: each bin contributes its minimum and maximum
+// in time order, so a short spike in a long capture still reaches the chart.
+static uint16_t decimate_capture(const float *samples, uint32_t count, float scale, lv_coord_t *out)
+{
+    float minv = samples[0] * scale;
+    float maxv = minv;
+    for (uint32_t i = 1; i < count; i++) {
+        float v = samples[i] * scale;
+        if (v < minv) {
+            minv = v;
+        }
+        if (v > maxv) {
+            maxv = v;
+        }
+    }
+
+    float center;
+    float half_span;
+    chart_span(minv, maxv, &center, &half_span);
+
+    if (count <= HISTORY_MAX) {
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = chart_coord(samples[i] * scale, center, half_span);
+        }
+        return (uint16_t)count;
+    }
+
+    const uint32_t bins = HISTORY_MAX / 2;
+    uint16_t points = 0;
+    for (uint32_t bin = 0; bin < bins; bin++) {
+        uint32_t start = (uint32_t)(((uint64_t)bin * count) / bins);
+        uint32_t end = (uint32_t)(((uint64_t)(bin + 1) * count) / bins);
+        uint32_t min_idx = start;
+        uint32_t max_idx = start;
+        for (uint32_t i = start + 1; i < end; i++) {
+            if (samples[i] < samples[min_idx]) {
+                min_idx = i;
+            }
+            if (samples[i] > samples[max_idx]) {
+                max_idx = i;
+            }
+        }
+
+        uint32_t first = (min_idx < max_idx) ? min_idx : max_idx;
+        uint32_t second = (min_idx < max_idx) ? max_idx : min_idx;
+        out[points++] = chart_coord(samples[first] * scale, center, half_span);
+        out[points++] = chart_coord(samples[second] * scale, center, half_span);
+    }
+    return points;
+}
+
+static void leave_capture_view(void)
+{
+    if (!capture_view_active) {
+        return;
+    }
+
+    capture_view_active = false;
+    lv_chart_set_ext_y_array(chart_obj, chart_series[METRIC_VOLTAGE], history_chart[METRIC_VOLTAGE]);
+    lv_chart_set_ext_y_array(chart_obj, chart_series[METRIC_CURRENT], history_chart[METRIC_CURRENT]);
+    lv_obj_add_flag(capture_live_button, LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text(capture_status_label, "Live");
+    apply_chart_visibility();
+    refresh_chart();
+}
+
+static void set_stat_cell(lv_obj_t *label, float value, uint8_t decimals)
+{
+    if (isnan(value)) {
+        lv_label_set_text(label, "--");
+        return;
+    }
+
+    char number[24];
+    format_fixed(number, sizeof(number), value, decimals);
+    lv_label_set_text(label, number);
+}
+
+// The stats screen follows the displayed channel, like the monitor screen.
+static void refresh_stats_view(void)
+{
+    if (stats_title_label == NULL) {
+        return;
+    }
+
+    const ui_channel_stats_t *stats = &channel_stats[displayed_channel];
+    bool metric = (active_config.units == UI_UNITS_METRIC);
+    static const char *const metric_names[UI_STAT_COUNT] = {"Voltage (V)", "Current (mA)", "Power (W)", NULL};
+    static const uint8_t metric_decimals[UI_STAT_COUNT] = {3, 2, 3, 1};
+
+    char text[40];
+    if (active_config.sensor_type == UI_SENSOR_INA3221) {
+        snprintf(text, sizeof(text), "Statistics - CH%u", (unsigned)(displayed_channel + 1));
+        lv_label_set_text(stats_title_label, text);
+    } else {
+        lv_label_set_text(stats_title_label, "Statistics");
+    }
+    if (stats->window_s > 0) {
+        snprintf(text, sizeof(text), "Last %u s", (unsigned)stats->window_s);
+        lv_label_set_text(stats_span_labels[STAT_SPAN_WINDOW], text);
+    }
+
+    for (uint8_t span = 0; span < STAT_SPAN_COUNT; span++) {
+        const ui_stat_t *values = (span == STAT_SPAN_TEST) ? stats->test : stats->window;
+        for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+            lv_label_set_text(stats_name_labels[span][m],
+                              metric_names[m] != NULL ? metric_names[m] : (metric ? "Load Temp (C)" : "Load Temp (F)"));
+
+            const ui_stat_t *stat = &values[m];
+            bool empty = (stat->count == 0);
+            set_stat_cell(stats_cells[span][m][STAT_COLUMN_MIN], empty ? NAN : stat->min, metric_decimals[m]);
+            set_stat_cell(stats_cells[span][m][STAT_COLUMN_MAX], empty ? NAN : stat->max, metric_decimals[m]);
+            set_stat_cell(stats_cells[span][m][STAT_COLUMN_MEAN], empty ? NAN : stat->mean, metric_decimals[m]);
+            set_stat_cell(stats_cells[span][m][STAT_COLUMN_RMS], empty ? NAN : stat->rms, metric_decimals[m]);
+            set_stat_cell(stats_cells[span][m][STAT_COLUMN_STDDEV], empty ? NAN : stat->stddev, metric_decimals[m]);
+        }
+    }
+}
+
+// Channel buttons and title follow the displayed channel; the buttons only
+// show while the INA3221 provides more than one channel.
+static void refresh_channel_nav(void)
+{
+    if (channel_title_label == NULL || channel_nav_row == NULL) {
+        return;
+    }
+
+    bool multi_channel = (active_config.sensor_type == UI_SENSOR_INA3221);
+    if (multi_channel) {
+        char title[40];
+        snprintf(title, sizeof(title), "Energy Test Data - CH%u", (unsigned)(displayed_channel + 1));
+        lv_label_set_text(channel_title_label, title);
+        lv_obj_clear_flag(channel_nav_row, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_label_set_text(channel_title_label, "Energy Test Data");
+        lv_obj_add_flag(channel_nav_row, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    for (uint8_t channel = 0; channel < UI_CHANNEL_COUNT; channel++) {
+        if (channel == displayed_channel) {
+            lv_obj_add_state(channel_nav_buttons[channel], LV_STATE_CHECKED);
+        } else {
+            lv_obj_clear_state(channel_nav_buttons[channel], LV_STATE_CHECKED);
+        }
+    }
+    refresh_stats_view();
+}
+
+static void on_capture_clicked(lv_event_t *e)
+{
+    (void)e;
+    capture_requested = true;
+}
+
+static void on_trigger_clicked(lv_event_t *e)
+{
+    (void)e;
+    trigger_requested = true;
+}
+
+static void on_capture_live_clicked(lv_event_t *e)
+{
+    (void)e;
+    leave_capture_view();
+}
+
 static void on_start_clicked(lv_event_t *e)
 {
     (void)e;
-    clear_history();
-    start_requested = true;
+    leave_capture_view();
+    clear_all_history();
+    start_requested |= (uint8_t)(1u << displayed_channel);
 }
 
 static void on_stop_clicked(lv_event_t *e)
 {
     (void)e;
-    stop_requested = true;
+    stop_requested |= (uint8_t)(1u << displayed_channel);
 }
 
 static void on_open_config_clicked(lv_event_t *e)
@@ -551,6 +956,13 @@ static void on_back_clicked(lv_event_t *e)
     lv_disp_load_scr(screen_monitor);
 }
 
+static void on_open_stats_clicked(lv_event_t *e)
+{
+    (void)e;
+    refresh_stats_view();
+    lv_disp_load_scr(screen_stats);
+}
+
 static void on_apply_clicked(lv_event_t *e)
 {
     (void)e;
@@ -560,9 +972,8 @@ static void on_apply_clicked(lv_event_t *e)
     active_config = pending_config;
     apply_chart_visibility();
     config_update_pending = true;
-    if (latest_data_valid) {
-        apply_values(&latest_data);
-    }
+    apply_displayed_values();
+    refresh_stats_view();
     lv_disp_load_scr(screen_monitor);
 }
 
@@ -652,6 +1063,39 @@ static void on_sample_plus(lv_event_t *e)
     refresh_config_values();
 }
 
+static void on_temp_interval_minus(lv_event_t *e)
+{
+    (void)e;
+    if (pending_config.temp_interval_ms > 250) {
+        pending_config.temp_interval_ms -= 250;
+    }
+    refresh_config_values();
+}
+
+static void on_temp_interval_plus(lv_event_t *e)
+{
+    (void)e;
+    if (pending_config.temp_interval_ms < 10000) {
+        pending_config.temp_interval_ms += 250;
+    }
+    refresh_config_values();
+}
+
+static void on_ina_preset_changed(lv_event_t *e)
+{
+    (void)e;
+    uint16_t selected = lv_dropdown_get_selected(dropdown_ina_preset);
+    if (selected > UI_INA_PRESET_LOW_NOISE) {
+        selected = UI_INA_PRESET_BALANCED;
+    }
+
+    pending_config.ina_preset = (ui_ina_preset_t)selected;
+    pending_config.ina_avg_code = ina_preset_timings[selected].avg_code;
+    pending_config.ina_vbus_ct_code = ina_preset_timings[selected].vbus_ct_code;
+    pending_config.ina_vshunt_ct_code = ina_preset_timings[selected].vshunt_ct_code;
+    refresh_config_values();
+}
+
 static void on_battery_type_changed(lv_event_t *e)
 {
     (void)e;
@@ -687,10 +1131,107 @@ static void on_ampacity_plus(lv_event_t *e)
     refresh_config_values();
 }
 
+static float clamp_setpoint(float value, float min, float max)
+{
+    if (value < min) {
+        return min;
+    }
+    if (value > max) {
+        return max;
+    }
+    return value;
+}
+
+// The -/+ buttons adjust whichever setpoint the selected load type uses.
+static void adjust_load_setpoint(int direction)
+{
+    float step;
+    switch (pending_config.load_type) {
+        case UI_LOAD_CONSTANT_CURRENT:
+            pending_config.load_current_a = clamp_setpoint(pending_config.load_current_a + 0.1f * (float)direction, 0.0f, 10.0f);
+            break;
+        case UI_LOAD_CONSTANT_POWER:
+            pending_config.load_power_w = clamp_setpoint(pending_config.load_power_w + 0.5f * (float)direction, 0.0f, 200.0f);
+            break;
+        case UI_LOAD_CONSTANT_IMPEDANCE:
+            // Finer steps where a tenth of an ohm still matters
+            step = (pending_config.load_resistance_ohm + 0.05f * (float)direction < 10.0f) ? 0.1f : 1.0f;
+            pending_config.load_resistance_ohm =
+                clamp_setpoint(pending_config.load_resistance_ohm + step * (float)direction, 0.1f, 1000.0f);
+            break;
+        case UI_LOAD_PULSED:
+        default:
+            break;
+    }
+    refresh_config_values();
+}
+
+static void on_load_setpoint_minus(lv_event_t *e)
+{
+    (void)e;
+    adjust_load_setpoint(-1);
+}
+
+static void on_load_setpoint_plus(lv_event_t *e)
+{
+    (void)e;
+    adjust_load_setpoint(1);
+}
+
+static void on_trigger_source_changed(lv_event_t *e)
+{
+    (void)e;
+    uint16_t selected = lv_dropdown_get_selected(dropdown_trigger_source);
+    ui_trigger_source_t source = (selected == UI_TRIGGER_SOURCE_VOLTAGE) ? UI_TRIGGER_SOURCE_VOLTAGE : UI_TRIGGER_SOURCE_CURRENT;
+    if (source != pending_config.trigger_source) {
+        // The level is in the new source's units now
+        pending_config.trigger_source = source;
+        pending_config.trigger_level = (source == UI_TRIGGER_SOURCE_VOLTAGE) ? 3.0f : 100.0f;
+    }
+    refresh_config_values();
+}
+
+static void on_trigger_mode_changed(lv_event_t *e)
+{
+    (void)e;
+    uint16_t selected = lv_dropdown_get_selected(dropdown_trigger_mode);
+    if (selected > UI_TRIGGER_BELOW_LEVEL) {
+        selected = UI_TRIGGER_RISING_EDGE;
+    }
+    pending_config.trigger_mode = (ui_trigger_mode_t)selected;
+}
+
+static void step_trigger_level(float direction)
+{
+    bool voltage = pending_config.trigger_source == UI_TRIGGER_SOURCE_VOLTAGE;
+    float max_level = voltage ? TRIGGER_LEVEL_MAX_V : TRIGGER_LEVEL_MAX_MA;
+    pending_config.trigger_level += direction * (voltage ? 0.1f : 10.0f);
+    if (pending_config.trigger_level < 0.0f) {
+        pending_config.trigger_level = 0.0f;
+    }
+    if (pending_config.trigger_level > max_level) {
+        pending_config.trigger_level = max_level;
+    }
+    refresh_config_values();
+}
+
+static void on_trigger_level_minus(lv_event_t *e)
+{
+    (void)e;
+    step_trigger_level(-1.0f);
+}
+
+static void on_trigger_level_plus(lv_event_t *e)
+{
+    (void)e;
+    step_trigger_level(1.0f);
+}
+
 static void on_load_type_changed(lv_event_t *e)
 {
     (void)e;
     pending_config.load_type = (ui_load_type_t)lv_dropdown_get_selected(dropdown_load_type);
+    refresh_config_values();
 }
 
 static void on_overtemp_minus(lv_event_t *e)
@@ -816,7 +1357,7 @@ static void build_monitor_screen(void)
 
     lv_obj_t *chart_row = lv_obj_create(chart_card);
     lv_obj_remove_style_all(chart_row);
-    lv_obj_set_size(chart_row, lv_pct(100), lv_pct(82));
+    lv_obj_set_size(chart_row, lv_pct(100), lv_pct(72));
     lv_obj_set_flex_flow(chart_row, LV_FLEX_FLOW_ROW);
     lv_obj_set_flex_align(chart_row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_set_style_pad_column(chart_row, 8, LV_PART_MAIN);
@@ -889,16 +1430,86 @@ static void build_monitor_screen(void)
     create_chart_index_item(index_row, "Energy", lv_palette_main(LV_PALETTE_BLUE));
     create_chart_index_item(index_row, "Load Temp", lv_palette_main(LV_PALETTE_CYAN));
 
+    lv_obj_t *capture_row = lv_obj_create(chart_card);
+    lv_obj_remove_style_all(capture_row);
+    lv_obj_set_width(capture_row, lv_pct(100));
+    lv_obj_set_height(capture_row, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(capture_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(capture_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(capture_row, 8, LV_PART_MAIN);
+
+    lv_obj_t *capture_button = lv_btn_create(capture_row);
+    lv_obj_set_size(capture_button, 140, 52);
+    lv_obj_add_style(capture_button, &style_nav_button, LV_PART_MAIN);
+    lv_obj_add_event_cb(capture_button, on_capture_clicked, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *capture_button_label = lv_label_create(capture_button);
+    lv_label_set_text(capture_button_label, "Burst");
+    lv_obj_add_style(capture_button_label, &style_button_text, LV_PART_MAIN);
+    lv_obj_center(capture_button_label);
+
+    lv_obj_t *trigger_button = lv_btn_create(capture_row);
+    lv_obj_set_size(trigger_button, 140, 52);
+    lv_obj_add_style(trigger_button, &style_nav_button, LV_PART_MAIN);
+    lv_obj_add_event_cb(trigger_button, on_trigger_clicked, LV_EVENT_CLICKED, NULL);
+
+    trigger_button_label = lv_label_create(trigger_button);
+    lv_label_set_text(trigger_button_label, "Trigger");
+    lv_obj_add_style(trigger_button_label, &style_button_text, LV_PART_MAIN);
+    lv_obj_center(trigger_button_label);
+
+    capture_status_label = lv_label_create(capture_row);
+    lv_label_set_text(capture_status_label, "Live");
+    lv_obj_set_flex_grow(capture_status_label, 1);
+    lv_obj_add_style(capture_status_label, &style_status_text, LV_PART_MAIN);
+
+    capture_live_button = lv_btn_create(capture_row);
+    lv_obj_set_size(capture_live_button, 120, 52);
+    lv_obj_add_style(capture_live_button, &style_nav_button, LV_PART_MAIN);
+    lv_obj_add_event_cb(capture_live_button, on_capture_live_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_flag(capture_live_button, LV_OBJ_FLAG_HIDDEN);
+
+    lv_obj_t *capture_live_label = lv_label_create(capture_live_button);
+    lv_label_set_text(capture_live_label, "Live");
+    lv_obj_add_style(capture_live_label, &style_button_text, LV_PART_MAIN);
+    lv_obj_center(capture_live_label);
+
     lv_obj_t *instant = lv_obj_create(screen_monitor);
     lv_obj_set_size(instant, lv_pct(100), lv_pct(30));
     lv_obj_add_style(instant, &style_section, LV_PART_MAIN);
     lv_obj_set_flex_flow(instant, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_style_pad_row(instant, 6, LV_PART_MAIN);
 
-    lv_obj_t *channel_title = lv_label_create(instant);
-    lv_label_set_text(channel_title, "Energy Test Data");
-    lv_obj_set_width(channel_title, lv_pct(100));
-    lv_obj_add_style(channel_title, &style_channel_title, LV_PART_MAIN);
+    lv_obj_t *title_row = lv_obj_create(instant);
+    lv_obj_remove_style_all(title_row);
+    lv_obj_set_size(title_row, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(title_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(title_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(title_row, 8, LV_PART_MAIN);
+
+    channel_title_label = lv_label_create(title_row);
+    lv_label_set_text(channel_title_label, "Energy Test Data");
+    lv_obj_set_flex_grow(channel_title_label, 1);
+    lv_obj_add_style(channel_title_label, &style_channel_title, LV_PART_MAIN);
+
+    channel_nav_row = lv_obj_create(title_row);
+    lv_obj_remove_style_all(channel_nav_row);
+    lv_obj_set_size(channel_nav_row, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(channel_nav_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_style_pad_column(channel_nav_row, 8, LV_PART_MAIN);
+
+    static const char *const channel_names[UI_CHANNEL_COUNT] = {"CH1", "CH2", "CH3"};
+    static const lv_event_cb_t channel_nav_cbs[UI_CHANNEL_COUNT] = {on_nav_to_ch1, on_nav_to_ch2, on_nav_to_ch3};
+    for (uint8_t channel = 0; channel < UI_CHANNEL_COUNT; channel++) {
+        channel_nav_buttons[channel] = create_small_button(channel_nav_row, channel_names[channel]);
+        lv_obj_set_width(channel_nav_buttons[channel], 84);
+        lv_obj_add_style(channel_nav_buttons[channel], &style_nav_button_active, LV_STATE_CHECKED);
+        lv_obj_add_event_cb(channel_nav_buttons[channel], channel_nav_cbs[channel], LV_EVENT_CLICKED, NULL);
+    }
+
+    lv_obj_t *stats_btn = create_small_button(title_row, "Stats");
+    lv_obj_set_width(stats_btn, 96);
+    lv_obj_add_event_cb(stats_btn, on_open_stats_clicked, LV_EVENT_CLICKED, NULL);
 
     lv_obj_t *columns = lv_obj_create(instant);
     lv_obj_remove_style_all(columns);
@@ -918,14 +1529,24 @@ static void build_monitor_screen(void)
     create_metric_row(metrics_col, "Current", lv_palette_main(LV_PALETTE_YELLOW), &value_current);
     create_metric_row(metrics_col, "Power", lv_palette_main(LV_PALETTE_GREEN), &value_power);
     create_metric_row(metrics_col, "Total Energy", lv_palette_main(LV_PALETTE_BLUE), &value_energy);
+    create_metric_row(metrics_col, "Total Charge", lv_palette_main(LV_PALETTE_INDIGO), &value_charge);
     create_metric_row(metrics_col, "Load Temp", lv_palette_main(LV_PALETTE_CYAN), &value_load_temp);
 
+    capacity_label = lv_label_create(metrics_col);
+    lv_label_set_text(capacity_label, "Capacity: --");
+    lv_obj_set_width(capacity_label, lv_pct(100));
+    lv_obj_add_style(capacity_label, &style_status_text, LV_PART_MAIN);
+    lv_obj_set_style_text_align(capacity_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    lv_obj_set_style_pad_top(capacity_label, 10, LV_PART_MAIN);
+
     sensor_status_label = lv_label_create(metrics_col);
     lv_label_set_text(sensor_status_label,
                       "INA226-1A: --\n"
                       "INA226-10A: --\n"
                       "Load Thermocouple: --\n"
-                      "DAC2: --");
+                      "DAC2: --\n"
+                      "INA3221: --\n"
+                      "INA228: --");
     lv_obj_set_width(sensor_status_label, lv_pct(100));
     lv_obj_add_style(sensor_status_label, &style_status_text, LV_PART_MAIN);
     lv_obj_set_style_text_align(sensor_status_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
@@ -968,7 +1589,8 @@ static void build_monitor_screen(void)
     lv_obj_add_style(config_label, &style_button_text, LV_PART_MAIN);
     lv_obj_center(config_label);
 
-    clear_history();
+    clear_all_history();
+    refresh_channel_nav();
 }
 
 static void build_config_screen(void)
@@ -994,7 +1616,7 @@ static void build_config_screen(void)
 
     lv_obj_t *row_sensor = create_config_row(list, "Current Sensor");
     dropdown_sensor = lv_dropdown_create(row_sensor);
-    lv_dropdown_set_options(dropdown_sensor, "INA226-1A\nINA226-10A");
+    lv_dropdown_set_options(dropdown_sensor, "INA226-1A\nINA226-10A\nAuto Range\nINA3221 (3 ch)\nINA228");
     lv_obj_set_width(dropdown_sensor, 260);
     lv_obj_add_event_cb(dropdown_sensor, on_sensor_changed, LV_EVENT_VALUE_CHANGED, NULL);
 
@@ -1027,6 +1649,21 @@ static void build_config_screen(void)
     lv_obj_set_width(dropdown_load_type, 260);
     lv_obj_add_event_cb(dropdown_load_type, on_load_type_changed, LV_EVENT_VALUE_CHANGED, NULL);
 
+    lv_obj_t *row_load_setpoint = create_config_row(list, "Load Setpoint");
+    lv_obj_t *load_setpoint_controls = lv_obj_create(row_load_setpoint);
+    lv_obj_remove_style_all(load_setpoint_controls);
+    lv_obj_set_width(load_setpoint_controls, 260);
+    lv_obj_set_flex_flow(load_setpoint_controls, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(load_setpoint_controls, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(load_setpoint_controls, 8, LV_PART_MAIN);
+    lv_obj_t *load_setpoint_minus = create_small_button(load_setpoint_controls, "-");
+    lv_obj_add_event_cb(load_setpoint_minus, on_load_setpoint_minus, LV_EVENT_CLICKED, NULL);
+    value_load_setpoint = lv_label_create(load_setpoint_controls);
+    lv_obj_set_width(value_load_setpoint, 136);
+    lv_obj_add_style(value_load_setpoint, &style_metric_value, LV_PART_MAIN);
+    lv_obj_t *load_setpoint_plus = create_small_button(load_setpoint_controls, "+");
+    lv_obj_add_event_cb(load_setpoint_plus, on_load_setpoint_plus, LV_EVENT_CLICKED, NULL);
+
     lv_obj_t *row_cells = create_config_row(list, "Series Cells");
     dropdown_series_cells = lv_dropdown_create(row_cells);
     lv_dropdown_set_options(dropdown_series_cells,
@@ -1053,6 +1690,62 @@ static void build_config_screen(void)
     lv_obj_t *sample_plus = create_small_button(sample_controls, "+");
     lv_obj_add_event_cb(sample_plus, on_sample_plus, LV_EVENT_CLICKED, NULL);
 
+    lv_obj_t *row_temp_interval = create_config_row(list, "Temp Interval");
+    lv_obj_t *temp_interval_controls = lv_obj_create(row_temp_interval);
+    lv_obj_remove_style_all(temp_interval_controls);
+    lv_obj_set_width(temp_interval_controls, 196);
+    lv_obj_set_flex_flow(temp_interval_controls, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(temp_interval_controls, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(temp_interval_controls, 8, LV_PART_MAIN);
+    lv_obj_t *temp_interval_minus = create_small_button(temp_interval_controls, "-");
+    lv_obj_add_event_cb(temp_interval_minus, on_temp_interval_minus, LV_EVENT_CLICKED, NULL);
+    value_temp_interval = lv_label_create(temp_interval_controls);
+    lv_obj_set_width(value_temp_interval, 72);
+    lv_obj_add_style(value_temp_interval, &style_metric_value, LV_PART_MAIN);
+    lv_obj_t *temp_interval_plus = create_small_button(temp_interval_controls, "+");
+    lv_obj_add_event_cb(temp_interval_plus, on_temp_interval_plus, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *row_ina_preset = create_config_row(list, "Sensor Preset");
+    dropdown_ina_preset = lv_dropdown_create(row_ina_preset);
+    lv_dropdown_set_options(dropdown_ina_preset, "Fast Transient\nBalanced\nLow Noise");
+    lv_obj_set_width(dropdown_ina_preset, 260);
+    lv_obj_add_event_cb(dropdown_ina_preset, on_ina_preset_changed, LV_EVENT_VALUE_CHANGED, NULL);
+
+    lv_obj_t *row_effective_rate = create_config_row(list, "Effective Rate");
+    lv_obj_set_flex_align(row_effective_rate, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(row_effective_rate, 10, LV_PART_MAIN);
+    value_effective_rate = lv_label_create(row_effective_rate);
+    lv_obj_set_width(value_effective_rate, 300);
+    lv_obj_add_style(value_effective_rate, &style_metric_value, LV_PART_MAIN);
+    lv_obj_set_style_text_align(value_effective_rate, LV_TEXT_ALIGN_LEFT, LV_PART_MAIN);
+
+    lv_obj_t *row_trigger_source = create_config_row(list, "Trigger Source");
+    dropdown_trigger_source = lv_dropdown_create(row_trigger_source);
+    lv_dropdown_set_options(dropdown_trigger_source, "Current\nVoltage");
+    lv_obj_set_width(dropdown_trigger_source, 260);
+    lv_obj_add_event_cb(dropdown_trigger_source, on_trigger_source_changed, LV_EVENT_VALUE_CHANGED, NULL);
+
+    lv_obj_t *row_trigger_mode = create_config_row(list, "Trigger Mode");
+    dropdown_trigger_mode = lv_dropdown_create(row_trigger_mode);
+    lv_dropdown_set_options(dropdown_trigger_mode, "Rising Edge\nFalling Edge\nAbove Level\nBelow Level");
+    lv_obj_set_width(dropdown_trigger_mode, 260);
+    lv_obj_add_event_cb(dropdown_trigger_mode, on_trigger_mode_changed, LV_EVENT_VALUE_CHANGED, NULL);
+
+    lv_obj_t *row_trigger_level = create_config_row(list, "Trigger Level");
+    lv_obj_t *trigger_level_controls = lv_obj_create(row_trigger_level);
+    lv_obj_remove_style_all(trigger_level_controls);
+    lv_obj_set_width(trigger_level_controls, 236);
+    lv_obj_set_flex_flow(trigger_level_controls, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(trigger_level_controls, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(trigger_level_controls, 8, LV_PART_MAIN);
+    lv_obj_t *trigger_level_minus = create_small_button(trigger_level_controls, "-");
+    lv_obj_add_event_cb(trigger_level_minus, on_trigger_level_minus, LV_EVENT_CLICKED, NULL);
+    value_trigger_level = lv_label_create(trigger_level_controls);
+    lv_obj_set_width(value_trigger_level, 112);
+    lv_obj_add_style(value_trigger_level, &style_metric_value, LV_PART_MAIN);
+    lv_obj_t *trigger_level_plus = create_small_button(trigger_level_controls, "+");
+    lv_obj_add_event_cb(trigger_level_plus, on_trigger_level_plus, LV_EVENT_CLICKED, NULL);
+
     lv_obj_t *row_overtemp = create_config_row(list, "Overtemp Cutoff");
     lv_obj_t *overtemp_controls = lv_obj_create(row_overtemp);
     lv_obj_remove_style_all(overtemp_controls);
@@ -1119,49 +1812,219 @@ static void build_config_screen(void)
     refresh_config_values();
 }
 
+static lv_obj_t *create_stats_row(lv_obj_t *parent, lv_obj_t **name_label, lv_obj_t **cells)
+{
+    lv_obj_t *row = lv_obj_create(parent);
+    lv_obj_remove_style_all(row);
+    lv_obj_set_width(row, lv_pct(100));
+    lv_obj_set_height(row, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    *name_label = lv_label_create(row);
+    lv_obj_set_width(*name_label, lv_pct(25));
+    lv_obj_add_style(*name_label, &style_metric_label, LV_PART_MAIN);
+
+    for (uint8_t column = 0; column < STAT_COLUMN_COUNT; column++) {
+        cells[column] = lv_label_create(row);
+        lv_label_set_text(cells[column], "--");
+        lv_obj_set_width(cells[column], lv_pct(15));
+        lv_obj_add_style(cells[column], &style_metric_label, LV_PART_MAIN);
+        lv_obj_set_style_text_align(cells[column], LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+    }
+    return row;
+}
+
+static void build_stats_screen(void)
+{
+    screen_stats = lv_obj_create(NULL);
+    lv_obj_remove_style_all(screen_stats);
+    lv_obj_set_size(screen_stats, LV_PCT(100), LV_PCT(100));
+    lv_obj_add_style(screen_stats, &style_screen, LV_PART_MAIN);
+    lv_obj_set_flex_flow(screen_stats, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(screen_stats, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_row(screen_stats, 8, LV_PART_MAIN);
+
+    stats_title_label = lv_label_create(screen_stats);
+    lv_label_set_text(stats_title_label, "Statistics");
+    lv_obj_set_width(stats_title_label, lv_pct(100));
+    lv_obj_add_style(stats_title_label, &style_header, LV_PART_MAIN);
+
+    static const char *const column_names[STAT_COLUMN_COUNT] = {"Min", "Max", "Mean", "RMS", "Std Dev"};
+    for (uint8_t span = 0; span < STAT_SPAN_COUNT; span++) {
+        lv_obj_t *section = lv_obj_create(screen_stats);
+        lv_obj_set_size(section, lv_pct(100), LV_SIZE_CONTENT);
+        lv_obj_add_style(section, &style_section, LV_PART_MAIN);
+        lv_obj_set_flex_flow(section, LV_FLEX_FLOW_COLUMN);
+        lv_obj_set_style_pad_row(section, 6, LV_PART_MAIN);
+
+        stats_span_labels[span] = lv_label_create(section);
+        lv_label_set_text(stats_span_labels[span], span == STAT_SPAN_TEST ? "Whole Test" : "Window");
+        lv_obj_add_style(stats_span_labels[span], &style_channel_title, LV_PART_MAIN);
+
+        lv_obj_t *heading_name;
+        lv_obj_t *heading_cells[STAT_COLUMN_COUNT];
+        create_stats_row(section, &heading_name, heading_cells);
+        lv_label_set_text(heading_name, "");
+        for (uint8_t column = 0; column < STAT_COLUMN_COUNT; column++) {
+            lv_label_set_text(heading_cells[column], column_names[column]);
+        }
+
+        for (uint8_t m = 0; m < UI_STAT_COUNT; m++) {
+            create_stats_row(section, &stats_name_labels[span][m], stats_cells[span][m]);
+        }
+    }
+
+    lv_obj_t *footer = lv_obj_create(screen_stats);
+    lv_obj_set_size(footer, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_add_style(footer, &style_section, LV_PART_MAIN);
+    lv_obj_set_flex_flow(footer, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(footer, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *back_btn = lv_btn_create(footer);
+    lv_obj_set_size(back_btn, 200, 64);
+    lv_obj_add_style(back_btn, &style_nav_button, LV_PART_MAIN);
+    lv_obj_add_event_cb(back_btn, on_back_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *back_label = lv_label_create(back_btn);
+    lv_label_set_text(back_label, "Back");
+    lv_obj_add_style(back_label, &style_button_text, LV_PART_MAIN);
+    lv_obj_center(back_label);
+
+    refresh_stats_view();
+}
+
 void ui_init(void)
 {
     init_styles();
     build_monitor_screen();
     build_config_screen();
+    build_stats_screen();
     lv_disp_load_scr(screen_monitor);
 }
 
 void ui_set_channel_data(uint8_t channel, const ui_channel_data_t *data)
 {
-    if (channel != 0 || data == NULL) {
+    if (channel >= UI_CHANNEL_COUNT || data == NULL) {
         return;
     }
 
-    latest_data = *data;
-    latest_data_valid = true;
-    apply_values(data);
+    channel_history_t *history = &channel_history[channel];
+    bool shown = (channel == displayed_channel);
+    history->latest = *data;
+    history->latest_valid = true;
+    if (shown) {
+        apply_values(data);
+    }
 
-    history_sample_counter++;
-    if ((history_sample_counter % history_stride) != 0) {
-        refresh_chart();
+    // A sample the stride skips leaves the chart as it was
+    history->sample_counter++;
+    if ((history->sample_counter % history->stride) != 0) {
         return;
     }
 
-    if (history_count >= HISTORY_MAX) {
-        compress_history();
+    bool compressed = false;
+    if (history->count >= HISTORY_MAX) {
+        compress_history(history);
+        compressed = true;
+    }
+
+    uint16_t idx = history->count;
+    float temp_f = data->load_temp_f;
+    if (isnan(temp_f)) {
+        temp_f = (idx > 0) ? history->raw[METRIC_LOAD_TEMP][idx - 1] : 0.0f;
     }
+    history_append(history, METRIC_VOLTAGE, data->voltage_v);
+    history_append(history, METRIC_CURRENT, data->current_ma);
+    history_append(history, METRIC_POWER, data->power_w);
+    history_append(history, METRIC_ENERGY, data->energy_wh);
+    history_append(history, METRIC_LOAD_TEMP, temp_f);
+    history->count++;
 
-    if (history_count < HISTORY_MAX) {
-        uint16_t idx = history_count;
-        history_raw[METRIC_VOLTAGE][idx] = data->voltage_v;
-        history_raw[METRIC_CURRENT][idx] = data->current_ma;
-        history_raw[METRIC_POWER][idx] = data->power_w;
-        history_raw[METRIC_ENERGY][idx] = data->energy_wh;
-        if (isnan(data->load_temp_f)) {
-            history_raw[METRIC_LOAD_TEMP][idx] = (idx > 0) ? history_raw[METRIC_LOAD_TEMP][idx - 1] : 0.0f;
+    if (shown) {
+        if (compressed) {
+            refresh_chart();
         } else {
-            history_raw[METRIC_LOAD_TEMP][idx] = data->load_temp_f;
+            append_chart_point(history);
         }
-        history_count++;
     }
+}
 
-    refresh_chart();
+bool ui_consume_capture_request(void)
+{
+    bool requested = capture_requested;
+    capture_requested = false;
+    return requested;
+}
+
+bool ui_consume_trigger_request(void)
+{
+    bool requested = trigger_requested;
+    trigger_requested = false;
+    return requested;
+}
+
+void ui_set_trigger_armed(bool armed)
+{
+    if (trigger_button_label != NULL) {
+        lv_label_set_text(trigger_button_label, armed ? "Cancel" : "Trigger");
+    }
+}
+
+void ui_set_load_profile_summary(const char *summary)
+{
+    if (summary == NULL) {
+        return;
+    }
+    snprintf(load_profile_summary, sizeof(load_profile_summary), "%s", summary);
+    refresh_config_values();
+}
+
+void ui_set_capture_status(const char *status_text)
+{
+    if (capture_status_label != NULL && status_text != NULL) {
+        lv_label_set_text(capture_status_label, status_text);
+    }
+}
+
+void ui_show_capture(const float *voltage_v, const float *current_a, uint32_t count, const ui_capture_summary_t *summary)
+{
+    if (chart_obj == NULL || voltage_v == NULL || current_a == NULL || count == 0 || summary == NULL) {
+        ui_set_capture_status("Capture empty");
+        return;
+    }
+
+    capture_view_active = true;
+    uint16_t points = decimate_capture(voltage_v, count, 1.0f, capture_chart[METRIC_VOLTAGE]);
+    (void)decimate_capture(current_a, count, 1000.0f, capture_chart[METRIC_CURRENT]);
+
+    lv_chart_set_point_count(chart_obj, points);
+    lv_chart_set_range(chart_obj, LV_CHART_AXIS_PRIMARY_Y, -1000, 1000);
+    lv_chart_set_ext_y_array(chart_obj, chart_series[METRIC_VOLTAGE], capture_chart[METRIC_VOLTAGE]);
+    lv_chart_set_ext_y_array(chart_obj, chart_series[METRIC_CURRENT], capture_chart[METRIC_CURRENT]);
+    lv_chart_set_x_start_point(chart_obj, chart_series[METRIC_VOLTAGE], 0);
+    lv_chart_set_x_start_point(chart_obj, chart_series[METRIC_CURRENT], 0);
+    apply_chart_visibility();
+
+    char v_min[16];
+    char v_max[16];
+    char i_min[16];
+    char i_max[16];
+    char trigger_text[32] = "";
+    char text[192];
+    format_fixed(v_min, sizeof(v_min), summary->voltage_min_v, 3);
+    format_fixed(v_max, sizeof(v_max), summary->voltage_max_v, 3);
+    format_fixed(i_min, sizeof(i_min), summary->current_min_ma, 1);
+    format_fixed(i_max, sizeof(i_max), summary->current_max_ma, 1);
+    if (summary->trigger_offset_ms >= 0.0f) {
+        char trigger_ms[16];
+        format_fixed(trigger_ms, sizeof(trigger_ms), summary->trigger_offset_ms, 1);
+        snprintf(trigger_text, sizeof(trigger_text), ", trig @ %s ms", trigger_ms);
+    }
+    snprintf(text, sizeof(text), "%lu pts / %lu ms%s\nV %s-%s  mA %s-%s",
+             (unsigned long)summary->sample_count, (unsigned long)(summary->duration_ms + 0.5f), trigger_text,
+             v_min, v_max, i_min, i_max);
+    ui_set_capture_status(text);
+    lv_obj_clear_flag(capture_live_button, LV_OBJ_FLAG_HIDDEN);
 }
 
 void ui_set_sensor_connected(bool connected)
@@ -1178,39 +2041,107 @@ void ui_set_sensor_status(const char *status_text)
     }
 }
 
-bool ui_consume_reset_request(uint8_t channel)
+void ui_set_capacity(const ui_capacity_t *capacity)
 {
-    if (channel != 0) {
-        return false;
+    if (capacity_label == NULL || capacity == NULL) {
+        return;
     }
 
-    bool requested = reset_requested;
-    reset_requested = false;
-    return requested;
+    char delivered[16];
+    char energy[16];
+    char percent[16];
+    char rated[16];
+    char text[160];
+    format_fixed(delivered, sizeof(delivered), capacity->delivered_ah, 3);
+    format_fixed(energy, sizeof(energy), capacity->delivered_wh, 3);
+    format_fixed(percent, sizeof(percent), isnan(capacity->rated_percent) ? 0.0f : capacity->rated_percent, 1);
+    format_fixed(rated, sizeof(rated), capacity->rated_ah, 1);
+
+    lv_color_t color = lv_color_hex(0xFFECEC);
+    const char *verdict = NULL;
+    switch (capacity->verdict) {
+        case UI_CAPACITY_RUNNING: {
+            char projected[16] = "--";
+            if (!isnan(capacity->projected_ah)) {
+                format_fixed(projected, sizeof(projected), capacity->projected_ah, 3);
+            }
+            char soc[16] = "--";
+            char runtime[24] = "--";
+            if (!isnan(capacity->soc_percent)) {
+                format_fixed(soc, sizeof(soc), capacity->soc_percent, 0);
+            }
+            if (!isnan(capacity->runtime_h)) {
+                uint32_t minutes = (uint32_t)(capacity->runtime_h * 60.0f + 0.5f);
+                snprintf(runtime, sizeof(runtime), "%luh %02lum", (unsigned long)(minutes / 60U), (unsigned long)(minutes % 60U));
+            }
+            snprintf(text, sizeof(text), "Capacity: %s Ah (%s%% of %s Ah)\nProjected: %s Ah\nSoC: %s%% | Runtime: %s",
+                     delivered, percent, rated, projected, soc, runtime);
+            break;
+        }
+        case UI_CAPACITY_PASS:
+            verdict = "PASS";
+            color = lv_palette_main(LV_PALETTE_GREEN);
+            break;
+        case UI_CAPACITY_FAIL:
+            verdict = "FAIL";
+            color = lv_palette_main(LV_PALETTE_RED);
+            break;
+        case UI_CAPACITY_INCOMPLETE:
+            verdict = "INCOMPLETE (stopped before cutoff)";
+            break;
+        case UI_CAPACITY_IDLE:
+        default:
+            snprintf(text, sizeof(text), "Capacity: --");
+            break;
+    }
+    if (verdict != NULL) {
+        snprintf(text, sizeof(text), "Capacity: %s Ah, %s Wh (%s%% of %s Ah)\n%s",
+                 delivered, energy, percent, rated, verdict);
+    }
+
+    lv_label_set_text(capacity_label, text);
+    lv_obj_set_style_text_color(capacity_label, color, LV_PART_MAIN);
 }
 
-bool ui_consume_start_request(uint8_t channel)
+void ui_set_channel_stats(uint8_t channel, const ui_channel_stats_t *stats)
 {
-    if (channel != 0) {
-        return false;
+    if (channel >= UI_CHANNEL_COUNT || stats == NULL) {
+        return;
     }
 
-    bool requested = start_requested;
-    start_requested = false;
-    return requested;
+    channel_stats[channel] = *stats;
+    if (channel == displayed_channel && lv_scr_act() == screen_stats) {
+        refresh_stats_view();
+    }
 }
 
-bool ui_consume_stop_request(uint8_t channel)
+static bool consume_channel_request(uint8_t *requests, uint8_t channel)
 {
-    if (channel != 0) {
+    if (channel >= UI_CHANNEL_COUNT) {
         return false;
     }
 
-    bool requested = stop_requested;
-    stop_requested = false;
+    uint8_t bit = (uint8_t)(1u << channel);
+    bool requested = (*requests & bit) != 0;
+    *requests &= (uint8_t)~bit;
     return requested;
 }
 
+bool ui_consume_reset_request(uint8_t channel)
+{
+    return consume_channel_request(&reset_requested, channel);
+}
+
+bool ui_consume_start_request(uint8_t channel)
+{
+    return consume_channel_request(&start_requested, channel);
+}
+
+bool ui_consume_stop_request(uint8_t channel)
+{
+    return consume_channel_request(&stop_requested, channel);
+}
+
 void ui_set_test_running(bool running)
 {
     if (start_button_label != NULL) {
@@ -1236,20 +2167,32 @@ void ui_set_test_running(bool running)
 
 void ui_request_reset(uint8_t channel)
 {
-    if (channel != 0) {
+    if (channel >= UI_CHANNEL_COUNT) {
         return;
     }
 
-    reset_requested = true;
-    clear_history();
+    reset_requested |= (uint8_t)(1u << channel);
+    channel_history[channel].latest_valid = false;
+    clear_history(channel);
+    if (channel == displayed_channel) {
+        apply_displayed_values();
+    }
 }
 
 void ui_load_channel_screen(uint8_t channel)
 {
-    (void)channel;
-    if (screen_monitor != NULL) {
-        lv_disp_load_scr(screen_monitor);
+    if (channel >= UI_CHANNEL_COUNT || screen_monitor == NULL) {
+        return;
     }
+
+    if (channel != displayed_channel) {
+        leave_capture_view();
+        displayed_channel = channel;
+        refresh_channel_nav();
+        apply_displayed_values();
+        refresh_chart();
+    }
+    lv_disp_load_scr(screen_monitor);
 }
 
 void ui_set_config(const ui_config_t *config)
@@ -1263,9 +2206,12 @@ void ui_set_config(const ui_config_t *config)
     refresh_config_values();
     apply_chart_visibility();
 
-    if (latest_data_valid) {
-        apply_values(&latest_data);
+    // Only the INA3221 has more than one channel to show
+    if (config->sensor_type != UI_SENSOR_INA3221 && displayed_channel != 0) {
+        ui_load_channel_screen(0);
     }
+    refresh_channel_nav();
+    apply_displayed_values();
 }
 
 bool ui_consume_config_update(ui_config_t *config)
@@ -19,17 +19,25 @@ extern "C" {
 #include "lvgl.h"
 #endif
 
+// Monitor channels: channel 0 is the INA226 (or INA3221 CH1); the INA3221
+// adds channels 1 and 2.
+#define UI_CHANNEL_COUNT 3
+
 typedef struct {
     float voltage_v;
     float current_ma;
     float power_w;
     float energy_wh;
+    float charge_ah;
     float load_temp_f;
 } ui_channel_data_t;
 
 typedef enum {
     UI_SENSOR_INA226_1A = 0,
-    UI_SENSOR_INA226_10A = 1
+    UI_SENSOR_INA226_10A = 1,
+    UI_SENSOR_AUTO_RANGE = 2,
+    UI_SENSOR_INA3221 = 3,
+    UI_SENSOR_INA228 = 4
 } ui_sensor_type_t;
 
 typedef enum {
@@ -58,6 +66,24 @@ typedef enum {
     UI_LOAD_PULSED = 3
 } ui_load_type_t;
 
+typedef enum {
+    UI_INA_PRESET_FAST_TRANSIENT = 0,
+    UI_INA_PRESET_BALANCED = 1,
+    UI_INA_PRESET_LOW_NOISE = 2
+} ui_ina_preset_t;
+
+typedef enum {
+    UI_TRIGGER_SOURCE_CURRENT = 0,
+    UI_TRIGGER_SOURCE_VOLTAGE = 1
+} ui_trigger_source_t;
+
+typedef enum {
+    UI_TRIGGER_RISING_EDGE = 0,
+    UI_TRIGGER_FALLING_EDGE = 1,
+    UI_TRIGGER_ABOVE_LEVEL = 2,
+    UI_TRIGGER_BELOW_LEVEL = 3
+} ui_trigger_mode_t;
+
 typedef enum {
     UI_GRAPH_TRACE_VOLTAGE = (1u << 0),
     UI_GRAPH_TRACE_CURRENT = (1u << 1),
@@ -78,12 +104,85 @@ typedef struct {
     float overtemp_cutoff_c;
     float rated_battery_ampacity_ah;
     uint8_t num_series_cells;
+    ui_ina_preset_t ina_preset;
+    uint8_t ina_avg_code;
+    uint8_t ina_vbus_ct_code;
+    uint8_t ina_vshunt_ct_code;
+    ui_trigger_source_t trigger_source;
+    ui_trigger_mode_t trigger_mode;
+    float trigger_level;  // mA for current, V for voltage
+    uint16_t temp_interval_ms;
+    float load_current_a;       // constant-current setpoint
+    float load_power_w;         // constant-power setpoint
+    float load_resistance_ohm;  // constant-impedance setpoint
 } ui_config_t;
 
+typedef struct {
+    uint32_t sample_count;
+    float duration_ms;
+    float mean_period_us;
+    float voltage_min_v;
+    float voltage_max_v;
+    float voltage_mean_v;
+    float current_min_ma;
+    float current_max_ma;
+    float current_mean_ma;
+    float peak_power_w;
+    float trigger_offset_ms;  // negative when the capture was not triggered
+} ui_capture_summary_t;
+
+typedef enum {
+    UI_CAPACITY_IDLE = 0,
+    UI_CAPACITY_RUNNING = 1,
+    UI_CAPACITY_PASS = 2,
+    UI_CAPACITY_FAIL = 3,
+    UI_CAPACITY_INCOMPLETE = 4  // stopped before cutoff
+} ui_capacity_verdict_t;
+
+typedef struct {
+    ui_capacity_verdict_t verdict;
+    float delivered_ah;
+    float delivered_wh;
+    float rated_ah;
+    float rated_percent;
+    float projected_ah;  // NAN while there is no estimate yet
+    float soc_percent;   // from the OCV curve; NAN without a reading
+    float runtime_h;     // to cutoff at the present draw; NAN when not discharging
+} ui_capacity_t;
+
+typedef enum {
+    UI_STAT_VOLTAGE = 0,
+    UI_STAT_CURRENT = 1,    // mA
+    UI_STAT_POWER = 2,
+    UI_STAT_LOAD_TEMP = 3,  // display units
+    UI_STAT_COUNT = 4
+} ui_stat_metric_t;
+
+typedef struct {
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float rms;  // NAN where it means nothing (temperature)
+    float stddev;
+} ui_stat_t;
+
+typedef struct {
+    ui_stat_t test[UI_STAT_COUNT];    // since the test started
+    ui_stat_t window[UI_STAT_COUNT];  // over the last window_s seconds
+    uint16_t window_s;
+} ui_channel_stats_t;
+
 void ui_init(void);
 void ui_set_channel_data(uint8_t channel, const ui_channel_data_t *data);
 void ui_set_sensor_connected(bool connected);
 void ui_set_sensor_status(const char *status_text);
+// Capacity test status for channel 0, the battery under test.
+void ui_set_capacity(const ui_capacity_t *capacity);
+void ui_set_channel_stats(uint8_t channel, const ui_channel_stats_t *stats);
+// Shown as the load setpoint while the pulsed load type is selected. Safe
+// to call before ui_init().
+void ui_set_load_profile_summary(const char *summary);
 bool ui_consume_start_request(uint8_t channel);
 bool ui_consume_stop_request(uint8_t channel);
 void ui_set_test_running(bool running);
@@ -92,6 +191,14 @@ void ui_request_reset(uint8_t channel);
 void ui_load_channel_screen(uint8_t channel);
 void ui_set_config(const ui_config_t *config);
 bool ui_consume_config_update(ui_config_t *config);
+bool ui_consume_capture_request(void);
+bool ui_consume_trigger_request(void);
+void ui_set_trigger_armed(bool armed);
+void ui_set_capture_status(const char *status_text);
+// Show a finished capture on the monitor chart until the user returns to the
+// live view. voltage_v and current_a hold count samples each; they are
+// decimated for display and need not outlive the call.
+void ui_show_capture(const float *voltage_v, const float *current_a, uint32_t count, const ui_capture_summary_t *summary);
 
 #ifdef __cplusplus
 }
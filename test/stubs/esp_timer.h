@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for esp_timer: a clock the test moves by hand.
+
+#include <stdint.h>
+
+inline int64_t hostTimeUs = 0;
+
+inline int64_t esp_timer_get_time(void)
+{
+  return hostTimeUs;
+}
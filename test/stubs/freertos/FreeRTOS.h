@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for the few FreeRTOS types the platform-free modules use.
+// Only the native test env puts test/stubs on the include path.
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
@@ -0,0 +1,53 @@
+#pragma once
+
+// Host stand-in for FreeRTOS queues: fixed-depth FIFOs of copied items.
+// Single-threaded, so the tick arguments are ignored and nothing blocks.
+
+#include <deque>
+#include <string.h>
+#include <vector>
+
+#include "FreeRTOS.h"
+
+struct HostQueue {
+  size_t depth;
+  size_t itemSize;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+typedef HostQueue *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t itemSize)
+{
+  return new HostQueue{depth, itemSize, {}};
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+  (void)ticks;
+  if (queue->items.size() >= queue->depth) {
+    return pdFALSE;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(item);
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  return pdTRUE;
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+  (void)ticks;
+  if (queue->items.empty()) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+  if (xQueuePeek(queue, item, ticks) != pdTRUE) {
+    return pdFALSE;
+  }
+  queue->items.pop_front();
+  return pdTRUE;
+}
@@ -0,0 +1,210 @@
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sensors/auto_range.h"
+#include "sensors/ina226_registers.h"
+
+// The firmware's two units: INA226-1A on 80 mohm, INA226-10A on 8 mohm
+static constexpr float FINE_SHUNT_OHMS = 0.08f;
+static constexpr float COARSE_SHUNT_OHMS = 0.008f;
+static constexpr float FINE_FULL_SCALE_A = 32767.0f * INA226_SHUNT_LSB_V / FINE_SHUNT_OHMS;
+static constexpr float UP_FRACTION = 0.9f;
+static constexpr float DOWN_FRACTION = 0.7f;
+static constexpr uint8_t DOWN_DWELL = 3;
+
+// Gain errors of opposite sign make every handoff show up as a step.
+static constexpr float FINE_GAIN = 1.002f;
+static constexpr float COARSE_GAIN = 0.998f;
+
+static AutoRange *autoRange;
+
+void setUp(void)
+{
+  autoRange = new AutoRange(FINE_FULL_SCALE_A, UP_FRACTION, DOWN_FRACTION, DOWN_DWELL);
+  autoRange->reset(CurrentRange::Coarse);
+}
+
+void tearDown(void)
+{
+  delete autoRange;
+}
+
+// What a unit reports for a true current: gain error, then the shunt
+// register's quantization and clipping.
+static range_reading_t unitReading(float currentA, float shuntOhms, float gain)
+{
+  float counts = roundf(currentA * gain * shuntOhms / INA226_SHUNT_LSB_V);
+  counts = fminf(fmaxf(counts, -32768.0f), 32767.0f);
+  range_reading_t reading = {12.0f, counts * INA226_SHUNT_LSB_V / shuntOhms, true};
+  return reading;
+}
+
+static range_reading_t fineReading(float currentA)
+{
+  return unitReading(currentA, FINE_SHUNT_OHMS, FINE_GAIN);
+}
+
+static range_reading_t coarseReading(float currentA)
+{
+  return unitReading(currentA, COARSE_SHUNT_OHMS, COARSE_GAIN);
+}
+
+static const range_reading_t NO_READING = {0.0f, 0.0f, false};
+
+typedef struct {
+  uint32_t switches;
+  float worstHandoffErrorA;  // reported step at a switch minus the true step
+  float worstErrorA;         // any sample, against the true current
+  double chargeErrorFraction;
+} ramp_result_t;
+
+// Ramp 0 -> peak -> 0 at 200 ms samples, starting on the fine unit, and
+// integrate what was reported.
+static ramp_result_t runRamp(float peakA, uint32_t samplesPerLeg)
+{
+  autoRange->reset(CurrentRange::Fine);
+  const double dtH = 0.2 / 3600.0;
+  ramp_result_t result = {0, 0.0f, 0.0f, 0.0};
+  double trueAh = 0.0;
+  double reportedAh = 0.0;
+  float previousTrue = 0.0f;
+  float previousReported = 0.0f;
+  uint32_t previousSwitches = autoRange->switches();
+
+  for (uint32_t n = 0; n <= 2 * samplesPerLeg; n++) {
+    uint32_t k = (n <= samplesPerLeg) ? n : 2 * samplesPerLeg - n;
+    float trueA = peakA * (float)k / (float)samplesPerLeg;
+    range_reading_t chosen;
+    TEST_ASSERT_TRUE(autoRange->select(fineReading(trueA), coarseReading(trueA), &chosen));
+
+    float error = fabsf(chosen.current_a - trueA);
+    result.worstErrorA = fmaxf(result.worstErrorA, error);
+    if (n > 0 && autoRange->switches() != previousSwitches) {
+      float handoff = fabsf((chosen.current_a - previousReported) - (trueA - previousTrue));
+      result.worstHandoffErrorA = fmaxf(result.worstHandoffErrorA, handoff);
+    }
+    if (n > 0) {
+      trueAh += 0.5 * (trueA + previousTrue) * dtH;
+      reportedAh += 0.5 * (chosen.current_a + previousReported) * dtH;
+    }
+    previousSwitches = autoRange->switches();
+    previousTrue = trueA;
+    previousReported = chosen.current_a;
+  }
+
+  result.switches = autoRange->switches();
+  result.chargeErrorFraction = fabs(reportedAh - trueAh) / trueAh;
+  return result;
+}
+
+static void test_ramp_hands_off_once_each_way_within_bound(void)
+{
+  ramp_result_t result = runRamp(3.0f, 3000);
+  char line[160];
+  snprintf(line, sizeof(line), "0-3-0 A ramp: handoff error %.2f mA, worst error %.2f mA, charge error %.3f%%",
+           result.worstHandoffErrorA * 1000.0f, result.worstErrorA * 1000.0f, result.chargeErrorFraction * 100.0);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32(2, result.switches);
+  // Gain mismatch at the 0.92 A switch-up point (0.4%) plus one coarse LSB
+  TEST_ASSERT_LESS_THAN(0.006f, result.worstHandoffErrorA);
+  TEST_ASSERT_LESS_THAN(0.002f * 3.0f + INA226_SHUNT_LSB_V / COARSE_SHUNT_OHMS, result.worstErrorA);
+  TEST_ASSERT_LESS_THAN(0.0025, result.chargeErrorFraction);
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Fine);
+}
+
+// A fast ramp crosses the band between the thresholds in a few samples,
+// but still switches once each way and never reports a clipped reading.
+static void test_fast_ramp_never_reports_clipped_fine_reading(void)
+{
+  ramp_result_t result = runRamp(5.0f, 20);
+  TEST_ASSERT_EQUAL_UINT32(2, result.switches);
+  TEST_ASSERT_LESS_THAN(0.002f * 5.0f + INA226_SHUNT_LSB_V / COARSE_SHUNT_OHMS, result.worstErrorA);
+}
+
+static void test_up_switch_at_threshold_and_down_switch_after_dwell(void)
+{
+  range_reading_t chosen;
+  // Start low: three coarse samples inside 70% of fine full scale
+  for (uint8_t i = 0; i < DOWN_DWELL; i++) {
+    TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Coarse);
+    TEST_ASSERT_TRUE(autoRange->select(fineReading(0.1f), coarseReading(0.1f), &chosen));
+  }
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Fine);
+
+  float upA = FINE_FULL_SCALE_A * UP_FRACTION;
+  TEST_ASSERT_TRUE(autoRange->select(fineReading(upA * 0.99f), coarseReading(upA * 0.99f), &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Fine);
+  TEST_ASSERT_TRUE(autoRange->select(fineReading(upA * 1.01f), coarseReading(upA * 1.01f), &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Coarse);
+
+  // Below the down threshold but not for long enough: stays coarse
+  float downA = FINE_FULL_SCALE_A * DOWN_FRACTION;
+  for (uint8_t i = 0; i < DOWN_DWELL - 1; i++) {
+    TEST_ASSERT_TRUE(autoRange->select(fineReading(downA * 0.9f), coarseReading(downA * 0.9f), &chosen));
+  }
+  TEST_ASSERT_TRUE(autoRange->select(fineReading(downA * 1.1f), coarseReading(downA * 1.1f), &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Coarse);
+}
+
+// A load sitting between the two thresholds never flaps, whatever noise
+// rides on it.
+static void test_load_in_hysteresis_band_does_not_flap(void)
+{
+  range_reading_t chosen;
+  float middleA = FINE_FULL_SCALE_A * 0.8f;
+  for (uint32_t n = 0; n < 5000; n++) {
+    float noise = 0.08f * FINE_FULL_SCALE_A * sinf((float)n * 0.37f);
+    TEST_ASSERT_TRUE(autoRange->select(fineReading(middleA + noise), coarseReading(middleA + noise), &chosen));
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, autoRange->switches());
+}
+
+static void test_fine_failure_moves_to_coarse(void)
+{
+  range_reading_t chosen;
+  autoRange->reset(CurrentRange::Fine);
+  TEST_ASSERT_TRUE(autoRange->select(NO_READING, coarseReading(0.2f), &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Coarse);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.2f, chosen.current_a);
+}
+
+static void test_coarse_failure_uses_fine_reading_inside_range(void)
+{
+  range_reading_t chosen;
+  TEST_ASSERT_TRUE(autoRange->select(fineReading(0.3f), NO_READING, &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Fine);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.3f, chosen.current_a);
+}
+
+// With the 10A unit unreadable, a fine reading at or past the switch-up
+// point may be clipped: the sample has no measurement, in either range.
+static void test_saturated_fine_reading_is_never_reported(void)
+{
+  range_reading_t chosen = {0.0f, 0.0f, false};
+  autoRange->reset(CurrentRange::Fine);
+  TEST_ASSERT_FALSE(autoRange->select(fineReading(3.0f), NO_READING, &chosen));
+  TEST_ASSERT_FALSE(chosen.valid);
+
+  autoRange->reset(CurrentRange::Coarse);
+  TEST_ASSERT_FALSE(autoRange->select(fineReading(3.0f), NO_READING, &chosen));
+  TEST_ASSERT_TRUE(autoRange->range() == CurrentRange::Coarse);
+  TEST_ASSERT_FALSE(autoRange->select(NO_READING, NO_READING, &chosen));
+  TEST_ASSERT_EQUAL_UINT32(0, autoRange->switches());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_ramp_hands_off_once_each_way_within_bound);
+  RUN_TEST(test_fast_ramp_never_reports_clipped_fine_reading);
+  RUN_TEST(test_up_switch_at_threshold_and_down_switch_after_dwell);
+  RUN_TEST(test_load_in_hysteresis_band_does_not_flap);
+  RUN_TEST(test_fine_failure_moves_to_coarse);
+  RUN_TEST(test_coarse_failure_uses_fine_reading_inside_range);
+  RUN_TEST(test_saturated_fine_reading_is_never_reported);
+  return UNITY_END();
+}
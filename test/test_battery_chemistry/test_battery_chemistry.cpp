@@ -0,0 +1,95 @@
+#include <unity.h>
+
+#include <math.h>
+
+#include "battery/battery_chemistry.h"
+#include "ui/ui.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The per-cell cutoffs the config screen used before the table existed
+static void test_cutoffs_match_the_previous_switch(void)
+{
+  const float expected[] = {0.9f, 0.9f, 1.93f, 1.93f, 1.75f, 1.2f, 1.2f, 2.0f, 3.5f, 3.5f, 2.5f};
+  for (uint8_t type = UI_BATTERY_ALKALINE; type <= UI_BATTERY_LIFEPO4; type++) {
+    const battery_chemistry_t *cell = battery_chemistry(type);
+    TEST_ASSERT_NOT_NULL(cell);
+    TEST_ASSERT_EQUAL_FLOAT(expected[type], cell->cutoff_v);
+    TEST_ASSERT_TRUE(cell->cutoff_v <= cell->nominal_v);
+    TEST_ASSERT_TRUE(cell->nominal_v < cell->full_charge_v);
+  }
+}
+
+static void test_unknown_type_falls_back_to_lifepo4(void)
+{
+  TEST_ASSERT_EQUAL_PTR(battery_chemistry(UI_BATTERY_LIFEPO4), battery_chemistry(UI_BATTERY_LIFEPO4 + 1));
+  TEST_ASSERT_EQUAL_PTR(battery_chemistry(UI_BATTERY_LIFEPO4), battery_chemistry(255));
+  TEST_ASSERT_EQUAL_FLOAT(battery_soc_from_cell_voltage(UI_BATTERY_LIFEPO4, 3.28f),
+                          battery_soc_from_cell_voltage(200, 3.28f));
+}
+
+// Table knots come back exactly, and points between them interpolate
+static void test_knots_and_interpolation(void)
+{
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.50f, battery_soc_from_cell_voltage(UI_BATTERY_LIFEPO4, 3.26f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.90f, battery_soc_from_cell_voltage(UI_BATTERY_LIFEPO4, 3.35f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.50f, battery_soc_from_cell_voltage(UI_BATTERY_LITHIUM_ION, 3.84f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.10f, battery_soc_from_cell_voltage(UI_BATTERY_NIMH, 1.22f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.50f, battery_soc_from_cell_voltage(UI_BATTERY_AGM, 2.04f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.75f, battery_soc_from_cell_voltage(UI_BATTERY_ALKALINE, 1.45f));
+
+  // Halfway between knots: LiFePO4 3.00 V (0.10) and 3.20 V (0.20)
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.15f, battery_soc_from_cell_voltage(UI_BATTERY_LIFEPO4, 3.10f));
+  // A quarter of the way: Li-ion 4.02 V (0.80) to 4.08 V (0.85)
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.8125f, battery_soc_from_cell_voltage(UI_BATTERY_LITHIUM_ION, 4.035f));
+  // The first and last segments, where the search has nothing to halve
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.025f, battery_soc_from_cell_voltage(UI_BATTERY_LITHIUM_ION, 3.44f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.95f, battery_soc_from_cell_voltage(UI_BATTERY_ALKALINE, 1.56f));
+}
+
+static void test_clamps_and_nan(void)
+{
+  for (uint8_t type = UI_BATTERY_ALKALINE; type <= UI_BATTERY_LIFEPO4; type++) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, battery_soc_from_cell_voltage(type, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, battery_soc_from_cell_voltage(type, -1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, battery_soc_from_cell_voltage(type, NAN));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, battery_soc_from_cell_voltage(type, 10.0f));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, battery_soc_from_cell_voltage(type, INFINITY));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, battery_soc_from_cell_voltage(type, battery_chemistry(type)->full_charge_v));
+  }
+}
+
+// Sweeping each chemistry from below its curve to above it in 1 mV steps:
+// SoC never falls, never leaves 0..1, and never jumps, which a search that
+// picked the wrong segment would show as a step.
+static void test_sweep_is_monotonic_and_continuous(void)
+{
+  for (uint8_t type = UI_BATTERY_ALKALINE; type <= UI_BATTERY_LIFEPO4; type++) {
+    float previous = 0.0f;
+    for (uint32_t mv = 500; mv <= 4500; mv++) {
+      float soc = battery_soc_from_cell_voltage(type, (float)mv / 1000.0f);
+      TEST_ASSERT_TRUE(soc >= 0.0f && soc <= 1.0f);
+      TEST_ASSERT_TRUE(soc >= previous);
+      // The steepest segment in the tables, LiFePO4 3.26 to 3.27 V, climbs
+      // 1% per mV
+      TEST_ASSERT_TRUE(soc - previous < 0.011f);
+      previous = soc;
+    }
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, previous);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_cutoffs_match_the_previous_switch);
+  RUN_TEST(test_unknown_type_falls_back_to_lifepo4);
+  RUN_TEST(test_knots_and_interpolation);
+  RUN_TEST(test_clamps_and_nan);
+  RUN_TEST(test_sweep_is_monotonic_and_continuous);
+  return UNITY_END();
+}
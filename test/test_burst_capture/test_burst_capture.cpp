@@ -0,0 +1,135 @@
+#include <unity.h>
+
+#include "acquisition/burst_capture.h"
+
+static constexpr uint32_t CAPACITY = 4096;
+
+static uint32_t offsetsUs[CAPACITY];
+static float voltageV[CAPACITY];
+static float currentA[CAPACITY];
+static BurstCapture capture;
+
+void setUp(void)
+{
+  capture.attach(offsetsUs, voltageV, currentA, CAPACITY);
+}
+
+void tearDown(void) {}
+
+// Synthetic pulsed load: 2 A for the first 100 us of every 1 ms, 5 mA
+// otherwise, on a 3.7 V cell with 50 mohm of source resistance.
+static float pulseCurrentA(uint64_t tUs)
+{
+  return (tUs % 1000) < 100 ? 2.0f : 0.005f;
+}
+
+static float pulseVoltageV(uint64_t tUs)
+{
+  return 3.7f - 0.05f * pulseCurrentA(tUs);
+}
+
+static void test_unattached_capture_never_arms(void)
+{
+  BurstCapture empty;
+  empty.attach(nullptr, voltageV, currentA, CAPACITY);
+  TEST_ASSERT_FALSE(empty.attached());
+  empty.arm(1000);
+  TEST_ASSERT_FALSE(empty.capturing());
+  TEST_ASSERT_FALSE(empty.add(0, 1.0f, 1.0f));
+}
+
+static void test_add_before_arm_is_refused(void)
+{
+  TEST_ASSERT_TRUE(capture.state() == BurstCapture::State::Idle);
+  TEST_ASSERT_FALSE(capture.add(10, 1.0f, 1.0f));
+  TEST_ASSERT_EQUAL_UINT32(0, capture.count());
+}
+
+// Offsets run from the first sample; a sample at exactly the window end is
+// kept and the first one past it closes the capture.
+static void test_window_closes_capture(void)
+{
+  const uint64_t startUs = 5000000;
+  capture.arm(1000);
+  uint64_t tUs = startUs;
+  while (capture.add(tUs, 1.0f, 0.5f)) {
+    tUs += 7;
+  }
+  TEST_ASSERT_TRUE(capture.state() == BurstCapture::State::Complete);
+  TEST_ASSERT_EQUAL_UINT32(1000 / 7 + 1, capture.count());
+  TEST_ASSERT_EQUAL_UINT32(0, capture.offsetsUs()[0]);
+  TEST_ASSERT_EQUAL_UINT32(7 * (capture.count() - 1), capture.offsetsUs()[capture.count() - 1]);
+  TEST_ASSERT_FALSE(capture.add(tUs + 7, 1.0f, 0.5f));
+}
+
+static void test_full_buffer_closes_capture(void)
+{
+  capture.attach(offsetsUs, voltageV, currentA, 64);
+  capture.arm(1000000);
+  uint32_t accepted = 0;
+  for (uint32_t i = 0; i < 100 && capture.add(i * 10ULL, 1.0f, 0.0f); i++) {
+    accepted++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(63, accepted);  // the 64th add fills it and reports the end
+  TEST_ASSERT_EQUAL_UINT32(64, capture.count());
+  TEST_ASSERT_TRUE(capture.state() == BurstCapture::State::Complete);
+}
+
+static void test_finish_keeps_partial_window(void)
+{
+  capture.arm(1000000);
+  for (uint32_t i = 0; i < 10; i++) {
+    TEST_ASSERT_TRUE(capture.add(100 + i * 100ULL, 2.0f + i, 0.1f * i));
+  }
+  capture.finish();
+  TEST_ASSERT_TRUE(capture.state() == BurstCapture::State::Complete);
+  TEST_ASSERT_EQUAL_UINT32(10, capture.summary().sample_count);
+  TEST_ASSERT_EQUAL_UINT32(900, capture.summary().duration_us);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 11.0f, capture.summary().voltage_max_v);
+}
+
+// One second of the pulsed waveform at a 140 us read cadence: the summary
+// must catch the 100 us pulses and the sag they cause.
+static void test_summary_of_synthetic_pulsed_waveform(void)
+{
+  const uint32_t windowUs = 500000;
+  const uint32_t periodUs = 140;
+  capture.arm(windowUs);
+  uint64_t tUs = 0;
+  uint32_t pulses = 0;
+  while (capture.add(tUs, pulseVoltageV(tUs), pulseCurrentA(tUs))) {
+    if (pulseCurrentA(tUs) > 1.0f) {
+      pulses++;
+    }
+    tUs += periodUs;
+  }
+
+  const capture_summary_t &summary = capture.summary();
+  TEST_ASSERT_EQUAL_UINT32(windowUs / periodUs + 1, summary.sample_count);
+  TEST_ASSERT_EQUAL_UINT32(periodUs * (summary.sample_count - 1), summary.duration_us);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)periodUs, summary.mean_period_us);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, summary.current_max_a);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.005f, summary.current_min_a);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 3.6f, summary.voltage_min_v);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 3.69975f, summary.voltage_max_v);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 3.6f * 2.0f, summary.peak_power_w);
+
+  float expectedMeanA = (pulses * 2.0f + (summary.sample_count - pulses) * 0.005f) / summary.sample_count;
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, expectedMeanA, summary.current_mean_a);
+  // The 140 us cadence lands in a 100 us pulse about 10% of the time
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.1f, (float)pulses / summary.sample_count);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_unattached_capture_never_arms);
+  RUN_TEST(test_add_before_arm_is_refused);
+  RUN_TEST(test_window_closes_capture);
+  RUN_TEST(test_full_buffer_closes_capture);
+  RUN_TEST(test_finish_keeps_partial_window);
+  RUN_TEST(test_summary_of_synthetic_pulsed_waveform);
+  return UNITY_END();
+}
@@ -0,0 +1,227 @@
+#include <unity.h>
+
+#include <vector>
+
+#include "esp_timer.h"
+#include "sensors/i2c_transaction_queue.h"
+
+static constexpr size_t DEPTH = 8;
+static constexpr uint32_t STARVATION_US = 100000;
+
+static I2cTransactionQueue *queue;
+static std::vector<uint32_t> ran;  // args[0] of each job, in run order
+static std::vector<int64_t> waitedUs;
+static uint32_t doneOk;
+static uint32_t doneFailed;
+
+void setUp(void)
+{
+  hostTimeUs = 1000000;
+  ran.clear();
+  waitedUs.clear();
+  doneOk = 0;
+  doneFailed = 0;
+  queue = new I2cTransactionQueue();
+  TEST_ASSERT_TRUE(queue->begin(DEPTH, STARVATION_US));
+}
+
+void tearDown(void)
+{
+  delete queue;
+}
+
+// A job occupies the bus for exactly its estimate; args[1] set means the
+// transfer fails.
+static bool runJob(const i2c_job_t *job)
+{
+  ran.push_back(job->args[0]);
+  waitedUs.push_back(hostTimeUs - job->submitted_us);
+  hostTimeUs += job->estimated_us;
+  return job->args[1] == 0;
+}
+
+static void onDone(const i2c_job_t *job, bool ok)
+{
+  (void)job;
+  if (ok) {
+    doneOk++;
+  } else {
+    doneFailed++;
+  }
+}
+
+static bool submit(I2cPriority priority, uint32_t id, uint32_t estimatedUs, bool fails = false)
+{
+  i2c_job_t job = {};
+  job.run = runJob;
+  job.done = onDone;
+  job.args[0] = id;
+  job.args[1] = fails ? 1 : 0;
+  job.estimated_us = estimatedUs;
+  return queue->submit(priority, job);
+}
+
+static void test_runs_best_priority_first_then_in_submission_order(void)
+{
+  TEST_ASSERT_TRUE(submit(I2cPriority::Background, 30, 100));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Maintenance, 20, 100));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Background, 31, 100));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 10, 100));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 11, 100));
+
+  TEST_ASSERT_EQUAL_UINT32(500, queue->runPending(UINT32_MAX));
+  const std::vector<uint32_t> expected = {10, 11, 20, 30, 31};
+  TEST_ASSERT_TRUE(ran == expected);
+  TEST_ASSERT_EQUAL_UINT32(5, queue->completed());
+  TEST_ASSERT_EQUAL_UINT32(5, doneOk);
+}
+
+// A job that arrives while lower ones are running goes next, ahead of what
+// was already waiting below it.
+static void test_control_job_submitted_mid_run_jumps_the_queue(void)
+{
+  i2c_job_t job = {};
+  job.run = [](const i2c_job_t *self) {
+    ran.push_back(self->args[0]);
+    return submit(I2cPriority::Control, 10, 50);
+  };
+  job.args[0] = 29;
+  TEST_ASSERT_TRUE(queue->submit(I2cPriority::Background, job));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Background, 30, 100));
+  queue->runPending(UINT32_MAX);
+  const std::vector<uint32_t> expected = {29, 10, 30};
+  TEST_ASSERT_TRUE(ran == expected);
+}
+
+static void test_jobs_only_start_when_they_fit_the_budget(void)
+{
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 10, 300));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 11, 300));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 12, 300));
+
+  TEST_ASSERT_EQUAL_UINT32(0, queue->runPending(299));
+  TEST_ASSERT_TRUE(ran.empty());
+  TEST_ASSERT_EQUAL_UINT32(600, queue->runPending(700));
+  TEST_ASSERT_EQUAL_UINT32(2, ran.size());
+  TEST_ASSERT_EQUAL_UINT32(300, queue->runPending(300));
+  TEST_ASSERT_EQUAL_UINT32(0, queue->starved());
+}
+
+// A long job at the head of the best priority blocks everything below it,
+// so a short background read cannot keep slipping in ahead of it.
+static void test_blocked_head_holds_back_lower_priorities(void)
+{
+  TEST_ASSERT_TRUE(submit(I2cPriority::Maintenance, 20, 2000));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Background, 30, 100));
+  TEST_ASSERT_EQUAL_UINT32(0, queue->runPending(1000));
+  TEST_ASSERT_TRUE(ran.empty());
+}
+
+static void test_lowest_priority_limits_which_queues_run(void)
+{
+  TEST_ASSERT_TRUE(submit(I2cPriority::Background, 30, 100));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 10, 100));
+  queue->runPending(UINT32_MAX, I2cPriority::Control);
+  const std::vector<uint32_t> controlOnly = {10};
+  TEST_ASSERT_TRUE(ran == controlOnly);
+}
+
+static void test_job_past_starvation_limit_runs_over_budget(void)
+{
+  TEST_ASSERT_TRUE(submit(I2cPriority::Maintenance, 20, 5000));
+  hostTimeUs += STARVATION_US;
+  TEST_ASSERT_EQUAL_UINT32(0, queue->runPending(1000));
+  hostTimeUs += 1;
+  TEST_ASSERT_EQUAL_UINT32(5000, queue->runPending(1000));
+  TEST_ASSERT_EQUAL_UINT32(1, queue->starved());
+  TEST_ASSERT_EQUAL_UINT32(1, queue->completed());
+}
+
+static void test_full_queue_rejects_and_failures_are_counted(void)
+{
+  for (uint32_t i = 0; i < DEPTH; i++) {
+    TEST_ASSERT_TRUE(submit(I2cPriority::Background, i, 10, (i % 2) == 1));
+  }
+  TEST_ASSERT_FALSE(submit(I2cPriority::Background, 99, 10));
+  TEST_ASSERT_TRUE(submit(I2cPriority::Control, 10, 10));
+  i2c_job_t noRun = {};
+  TEST_ASSERT_FALSE(queue->submit(I2cPriority::Control, noRun));
+
+  queue->runPending(UINT32_MAX);
+  TEST_ASSERT_EQUAL_UINT32(DEPTH + 1, queue->submitted());
+  TEST_ASSERT_EQUAL_UINT32(2, queue->rejected());
+  TEST_ASSERT_EQUAL_UINT32(DEPTH / 2 + 1, queue->completed());
+  TEST_ASSERT_EQUAL_UINT32(DEPTH / 2, queue->failed());
+  TEST_ASSERT_EQUAL_UINT32(DEPTH / 2, doneFailed);
+}
+
+// The bus owner's loop: a 1 ms sample read every 2 ms and a 10 ms service
+// wake, queued work run in the slack before the next sample is due. A
+// 1.5 ms background read never fits the 0.9 ms gap the samples leave, so
+// without the starvation limit it would wait forever; with it, it runs
+// within the limit plus one service wake, and Control writes submitted
+// every 20 ms are never held back by it for more than one job.
+static void test_starvation_model_under_sample_load(void)
+{
+  const int64_t samplePeriodUs = 2000;
+  const int64_t sampleReadUs = 1000;
+  const int64_t guardUs = 100;
+  const int64_t endUs = hostTimeUs + 2000000;
+  int64_t nextSampleUs = hostTimeUs;
+  int64_t nextControlUs = hostTimeUs;
+  int64_t nextBackgroundUs = hostTimeUs;
+  int64_t worstBackgroundWaitUs = 0;
+  int64_t worstControlWaitUs = 0;
+  uint32_t backgroundRuns = 0;
+
+  while (hostTimeUs < endUs) {
+    if (hostTimeUs >= nextControlUs) {
+      TEST_ASSERT_TRUE(submit(I2cPriority::Control, 10, 150));
+      nextControlUs += 20000;
+    }
+    if (hostTimeUs >= nextBackgroundUs) {
+      TEST_ASSERT_TRUE(submit(I2cPriority::Background, 30, 1500));
+      nextBackgroundUs += 250000;
+    }
+    if (hostTimeUs >= nextSampleUs) {
+      hostTimeUs += sampleReadUs;
+      nextSampleUs += samplePeriodUs;
+    }
+    int64_t budgetUs = nextSampleUs - hostTimeUs - guardUs;
+    ran.clear();
+    waitedUs.clear();
+    queue->runPending(budgetUs > 0 ? (uint32_t)budgetUs : 0);
+    for (size_t i = 0; i < ran.size(); i++) {
+      if (ran[i] == 30) {
+        backgroundRuns++;
+        worstBackgroundWaitUs = waitedUs[i] > worstBackgroundWaitUs ? waitedUs[i] : worstBackgroundWaitUs;
+      } else {
+        worstControlWaitUs = waitedUs[i] > worstControlWaitUs ? waitedUs[i] : worstControlWaitUs;
+      }
+    }
+    // Next wake: the sample timer, or the 10 ms service wake if sooner
+    int64_t wakeUs = hostTimeUs + 10000;
+    hostTimeUs = nextSampleUs < wakeUs ? (nextSampleUs > hostTimeUs ? nextSampleUs : hostTimeUs) : wakeUs;
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(8, backgroundRuns);
+  TEST_ASSERT_EQUAL_UINT32(8, queue->starved());
+  TEST_ASSERT_LESS_OR_EQUAL(STARVATION_US + samplePeriodUs, worstBackgroundWaitUs);
+  TEST_ASSERT_LESS_OR_EQUAL(samplePeriodUs + 1500, worstControlWaitUs);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_runs_best_priority_first_then_in_submission_order);
+  RUN_TEST(test_control_job_submitted_mid_run_jumps_the_queue);
+  RUN_TEST(test_jobs_only_start_when_they_fit_the_budget);
+  RUN_TEST(test_blocked_head_holds_back_lower_priorities);
+  RUN_TEST(test_lowest_priority_limits_which_queues_run);
+  RUN_TEST(test_job_past_starvation_limit_runs_over_budget);
+  RUN_TEST(test_full_queue_rejects_and_failures_are_counted);
+  RUN_TEST(test_starvation_model_under_sample_load);
+  return UNITY_END();
+}
@@ -0,0 +1,361 @@
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+#include "sensors/ina226_driver.h"
+#include "sensors/ina226_registers.h"
+
+static constexpr uint8_t INA226_ADDRESS = 0x41;
+static constexpr float SHUNT_OHMS = 0.01f;
+static constexpr uint32_t BENCH_SAMPLES = 200000;
+// 8 data bits plus ACK per byte at the external bus clock
+static constexpr double WIRE_US_PER_BYTE = 9.0 * 1e6 / 400000.0;
+
+// Register file of one INA226 in shunt+bus continuous mode. Each finished
+// conversion latches new results and CVRF; when CNVR is enabled it also
+// pulses ALERT, which here calls the driver's ISR hook. Reading
+// Mask/Enable clears CVRF, as on the part. Bytes are counted the way
+// WireRegisterBus counts them.
+class SimulatedIna226 : public RegisterBus {
+public:
+  Ina226Driver *alertTarget = nullptr;
+  uint32_t conversions = 0;
+  uint32_t resultReads = 0;
+
+  SimulatedIna226()
+  {
+    regs_[INA226_REG_MANUFACTURER_ID] = INA226_MANUFACTURER_ID_TI;
+    regs_[INA226_REG_CONFIG] = 0x4127;
+  }
+
+  // One conversion finishes with these results.
+  void convert(int16_t shuntCounts, uint16_t busCounts)
+  {
+    regs_[INA226_REG_SHUNT_VOLTAGE] = (uint16_t)shuntCounts;
+    regs_[INA226_REG_BUS_VOLTAGE] = busCounts;
+    regs_[INA226_REG_MASK_ENABLE] |= INA226_MASK_CVRF;
+    conversions++;
+    if ((regs_[INA226_REG_MASK_ENABLE] & INA226_MASK_CNVR) != 0 && alertTarget != nullptr) {
+      alertTarget->notifyAlertFromIsr();
+    }
+  }
+
+  uint16_t reg(uint8_t reg) const { return regs_[reg]; }
+
+  bool writeRegister16(uint8_t address, uint8_t reg, uint16_t value) override
+  {
+    countBytes(4);
+    if (address != INA226_ADDRESS) {
+      return false;
+    }
+    pointer_ = reg;
+    if (reg == INA226_REG_MASK_ENABLE) {
+      // Only the enable bits are writable; the flags are read-only
+      regs_[reg] = (uint16_t)((value & 0xFC03u) | (regs_[reg] & 0x001Fu));
+    } else {
+      regs_[reg] = value;
+    }
+    return true;
+  }
+
+  bool readRegister16(uint8_t address, uint8_t reg, uint16_t *value) override
+  {
+    countBytes(2);
+    if (address != INA226_ADDRESS) {
+      return false;
+    }
+    pointer_ = reg;
+    return readSelectedRegister16(address, value);
+  }
+
+  bool readSelectedRegister16(uint8_t address, uint16_t *value) override
+  {
+    countBytes(3);
+    if (address != INA226_ADDRESS || value == nullptr) {
+      return false;
+    }
+    *value = regs_[pointer_];
+    if (pointer_ == INA226_REG_MASK_ENABLE) {
+      regs_[INA226_REG_MASK_ENABLE] &= (uint16_t)~INA226_MASK_CVRF;
+    }
+    if (pointer_ == INA226_REG_SHUNT_VOLTAGE || pointer_ == INA226_REG_BUS_VOLTAGE) {
+      resultReads++;
+    }
+    return true;
+  }
+
+  bool readRegisterBytes(uint8_t, uint8_t, uint8_t *, size_t) override { return false; }
+  bool writeRegisterBytes(uint8_t, uint8_t, const uint8_t *, size_t) override { return false; }
+
+private:
+  uint16_t regs_[256] = {};
+  uint8_t pointer_ = 0;
+};
+
+static SimulatedIna226 *sim;
+static Ina226Driver *driver;
+
+void setUp(void)
+{
+  sim = new SimulatedIna226();
+  driver = new Ina226Driver();
+  sim->alertTarget = driver;
+  TEST_ASSERT_TRUE(driver->begin(sim, INA226_ADDRESS, SHUNT_OHMS));
+}
+
+void tearDown(void)
+{
+  delete driver;
+  delete sim;
+}
+
+// Conversion n carries n in both result registers, so a reading names the
+// conversion it came from.
+static void convertNumbered(uint32_t n)
+{
+  sim->convert((int16_t)(n & 0x3FFF), (uint16_t)(n & 0x7FFF));
+}
+
+static uint32_t conversionOf(const ina226_reading_t &reading)
+{
+  return (uint32_t)lroundf(reading.bus_voltage_v / INA226_BUS_LSB_V);
+}
+
+static void test_begin_rejects_wrong_manufacturer(void)
+{
+  Ina226Driver other;
+  TEST_ASSERT_FALSE(other.begin(sim, 0x40, SHUNT_OHMS));
+  TEST_ASSERT_FALSE(other.ready());
+}
+
+static void test_reading_scales_shunt_to_current(void)
+{
+  ina226_reading_t reading = {};
+  sim->convert(-4000, 9600);
+  TEST_ASSERT_TRUE(driver->read(&reading));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, -0.010f, reading.shunt_voltage_v);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 12.0f, reading.bus_voltage_v);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, -1.0f, reading.current_a);
+}
+
+static void test_enable_drops_conversion_finished_before_arming(void)
+{
+  convertNumbered(1);  // finished while CNVR was still off: no alert
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  TEST_ASSERT_EQUAL_HEX16(INA226_MASK_CNVR, sim->reg(INA226_REG_MASK_ENABLE));
+  TEST_ASSERT_FALSE(driver->alertPending());
+
+  ina226_reading_t reading = {};
+  TEST_ASSERT_TRUE(Ina226ServiceResult::Idle == driver->serviceConversionReady(&reading));
+  TEST_ASSERT_EQUAL_UINT32(0, driver->conversions());
+}
+
+// Alerts serviced at any latency shorter than the conversion period give
+// exactly one reading per conversion: none skipped, none repeated, and no
+// result register read while no conversion is pending.
+static void test_one_reading_per_conversion(void)
+{
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  ina226_reading_t reading = {};
+  uint32_t readsBefore = sim->resultReads;
+
+  for (uint32_t n = 1; n <= 500; n++) {
+    // Wakes with nothing finished yet cost no result reads
+    TEST_ASSERT_TRUE(Ina226ServiceResult::Idle == driver->serviceConversionReady(&reading));
+    convertNumbered(n);
+    TEST_ASSERT_TRUE(Ina226ServiceResult::Sample == driver->serviceConversionReady(&reading));
+    TEST_ASSERT_EQUAL_UINT32(n, conversionOf(reading));
+    TEST_ASSERT_TRUE(Ina226ServiceResult::Idle == driver->serviceConversionReady(&reading));
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(500, driver->conversions());
+  TEST_ASSERT_EQUAL_UINT32(0, driver->missedConversions());
+  TEST_ASSERT_EQUAL_UINT32(0, driver->spuriousAlerts());
+  TEST_ASSERT_EQUAL_UINT32(2 * 500, sim->resultReads - readsBefore);
+}
+
+// A task held off past the next conversion reads the newest one once and
+// counts the ones it never saw.
+static void test_late_service_reads_newest_and_counts_missed(void)
+{
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  ina226_reading_t reading = {};
+  convertNumbered(1);
+  convertNumbered(2);
+  convertNumbered(3);
+
+  TEST_ASSERT_TRUE(Ina226ServiceResult::Sample == driver->serviceConversionReady(&reading));
+  TEST_ASSERT_EQUAL_UINT32(3, conversionOf(reading));
+  TEST_ASSERT_EQUAL_UINT32(2, driver->missedConversions());
+  TEST_ASSERT_TRUE(Ina226ServiceResult::Idle == driver->serviceConversionReady(&reading));
+  TEST_ASSERT_EQUAL_UINT32(1, driver->conversions());
+}
+
+static void test_alert_without_conversion_is_spurious(void)
+{
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  ina226_reading_t reading = {};
+  uint32_t readsBefore = sim->resultReads;
+  driver->notifyAlertFromIsr();
+  TEST_ASSERT_TRUE(Ina226ServiceResult::Idle == driver->serviceConversionReady(&reading));
+  TEST_ASSERT_EQUAL_UINT32(1, driver->spuriousAlerts());
+  TEST_ASSERT_EQUAL_UINT32(readsBefore, sim->resultReads);
+}
+
+static void test_disabled_alert_stops_wakes(void)
+{
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  TEST_ASSERT_TRUE(driver->disableAlert());
+  convertNumbered(1);
+  TEST_ASSERT_FALSE(driver->alertPending());
+  TEST_ASSERT_EQUAL_HEX16(INA226_MASK_CVRF, sim->reg(INA226_REG_MASK_ENABLE));
+}
+
+// Conversion-ready sampling against the preset periods: the ALERT period,
+// not the task's wake rate, sets how many readings there are.
+static void test_conversion_ready_rate_follows_preset_period(void)
+{
+  const uint32_t periodUs = ina226_conversion_period_us(3, 6, 6);  // Low Noise
+  TEST_ASSERT_EQUAL_UINT32(531968, periodUs);
+
+  TEST_ASSERT_TRUE(driver->enableConversionReadyAlert());
+  ina226_reading_t reading = {};
+  uint32_t samples = 0;
+  uint64_t nextConversionUs = periodUs;
+  // The task wakes every 10 ms for queued bus work, as the firmware does
+  for (uint64_t nowUs = 0; nowUs <= 10ULL * 1000000ULL; nowUs += 10000) {
+    while (nextConversionUs <= nowUs) {
+      convertNumbered(samples + 1);
+      nextConversionUs += periodUs;
+    }
+    if (driver->serviceConversionReady(&reading) == Ina226ServiceResult::Sample) {
+      samples++;
+      TEST_ASSERT_EQUAL_UINT32(samples, conversionOf(reading));
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(sim->conversions, samples);
+  TEST_ASSERT_EQUAL_UINT32(10000000 / periodUs, samples);
+}
+
+// Only the first read after begin() pays two pointer writes; from then on
+// the read order alternates and every sample is one plain read plus one
+// pointer-write/read pair.
+static void test_polled_samples_take_eight_bus_bytes(void)
+{
+  ina226_reading_t reading = {};
+  sim->convert(400, 8000);
+  TEST_ASSERT_TRUE(driver->read(&reading));
+  TEST_ASSERT_EQUAL_UINT32(10, driver->lastSampleBytes());
+  for (uint32_t i = 0; i < 100; i++) {
+    sim->convert((int16_t)(400 + i), (uint16_t)(8000 + i));
+    uint32_t bytesBefore = sim->bytesMoved();
+    TEST_ASSERT_TRUE(driver->read(&reading));
+    TEST_ASSERT_EQUAL_UINT32(8, driver->lastSampleBytes());
+    TEST_ASSERT_EQUAL_UINT32(8, sim->bytesMoved() - bytesBefore);
+    TEST_ASSERT_EQUAL_UINT32(8000 + i, conversionOf(reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, (400 + i) * INA226_SHUNT_LSB_V / SHUNT_OHMS, reading.current_a);
+  }
+}
+
+// The register traffic of the UnitUnified path this driver replaced:
+// select and read the bus voltage and current registers every sample.
+static bool readLikeUnitUnified(RegisterBus *bus, ina226_reading_t *reading)
+{
+  uint16_t busRaw = 0;
+  uint16_t currentRaw = 0;
+  if (!bus->readRegister16(INA226_ADDRESS, INA226_REG_BUS_VOLTAGE, &busRaw) ||
+      !bus->readRegister16(INA226_ADDRESS, INA226_REG_CURRENT, &currentRaw)) {
+    return false;
+  }
+  reading->bus_voltage_v = (float)busRaw * INA226_BUS_LSB_V;
+  reading->current_a = (float)(int16_t)currentRaw * 0.001f;
+  return true;
+}
+
+// The M5 unit reading the same part leaves the device pointer on the
+// current register. Once told, the driver selects both result registers
+// again instead of trusting its cached pointer.
+static void test_foreign_pointer_move_is_reselected(void)
+{
+  ina226_reading_t reading = {};
+  sim->convert(400, 8000);
+  TEST_ASSERT_TRUE(driver->read(&reading));
+  TEST_ASSERT_TRUE(sim->writeRegister16(INA226_ADDRESS, INA226_REG_CURRENT, 0x1234));
+  TEST_ASSERT_TRUE(readLikeUnitUnified(sim, &reading));
+
+  sim->convert(500, 9000);
+  driver->invalidatePointer();
+  TEST_ASSERT_TRUE(driver->read(&reading));
+  TEST_ASSERT_EQUAL_UINT32(10, driver->lastSampleBytes());
+  TEST_ASSERT_EQUAL_UINT32(9000, conversionOf(reading));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 500 * INA226_SHUNT_LSB_V / SHUNT_OHMS, reading.current_a);
+
+  // Back to one pointer write per sample
+  sim->convert(501, 9001);
+  TEST_ASSERT_TRUE(driver->read(&reading));
+  TEST_ASSERT_EQUAL_UINT32(8, driver->lastSampleBytes());
+  TEST_ASSERT_EQUAL_UINT32(9001, conversionOf(reading));
+}
+
+// Host benchmark against the simulated register file. Bus bytes and wire
+// time at 400 kHz are what a sample costs on the device. UnitUnified's own
+// call overhead has no host equivalent, so only the driver's CPU time is
+// reported, as a regression figure.
+static void test_benchmark_driver_against_unit_unified_path(void)
+{
+  ina226_reading_t reading = {};
+  volatile float sink = 0.0f;
+  sim->convert(1234, 9600);
+
+  uint32_t bytesBefore = sim->bytesMoved();
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    TEST_ASSERT_TRUE(readLikeUnitUnified(sim, &reading));
+    sink = sink + reading.current_a;
+  }
+  uint32_t unitBytes = sim->bytesMoved() - bytesBefore;
+
+  bytesBefore = sim->bytesMoved();
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    TEST_ASSERT_TRUE(driver->read(&reading));
+    sink = sink + reading.current_a;
+  }
+  auto end = std::chrono::steady_clock::now();
+  uint32_t driverBytes = sim->bytesMoved() - bytesBefore;
+  (void)sink;
+
+  double driverNs = std::chrono::duration<double, std::nano>(end - start).count() / BENCH_SAMPLES;
+  double unitBytesPerSample = (double)unitBytes / BENCH_SAMPLES;
+  double driverBytesPerSample = (double)driverBytes / BENCH_SAMPLES;
+  char line[200];
+  snprintf(line, sizeof(line), "UnitUnified path: %.2f bytes, %.1f us wire per sample", unitBytesPerSample,
+           unitBytesPerSample * WIRE_US_PER_BYTE);
+  TEST_MESSAGE(line);
+  snprintf(line, sizeof(line), "Register driver:  %.2f bytes, %.1f us wire, %.1f ns host CPU per sample",
+           driverBytesPerSample, driverBytesPerSample * WIRE_US_PER_BYTE, driverNs);
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL_UINT32(10 * BENCH_SAMPLES, unitBytes);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(8 * BENCH_SAMPLES + 2, driverBytes);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_rejects_wrong_manufacturer);
+  RUN_TEST(test_reading_scales_shunt_to_current);
+  RUN_TEST(test_enable_drops_conversion_finished_before_arming);
+  RUN_TEST(test_one_reading_per_conversion);
+  RUN_TEST(test_late_service_reads_newest_and_counts_missed);
+  RUN_TEST(test_alert_without_conversion_is_spurious);
+  RUN_TEST(test_disabled_alert_stops_wakes);
+  RUN_TEST(test_conversion_ready_rate_follows_preset_period);
+  RUN_TEST(test_polled_samples_take_eight_bus_bytes);
+  RUN_TEST(test_foreign_pointer_move_is_reselected);
+  RUN_TEST(test_benchmark_driver_against_unit_unified_path);
+  return UNITY_END();
+}
@@ -0,0 +1,264 @@
+#include <unity.h>
+
+#include <map>
+
+#include "sensors/ina228_driver.h"
+#include "sensors/ina228_registers.h"
+
+static constexpr uint8_t INA228_ADDRESS = 0x44;
+// The firmware's part: 15 mohm shunt, 10 A full scale
+static constexpr float SHUNT_OHMS = 0.015f;
+static constexpr float MAX_CURRENT_A = 10.0f;
+static constexpr double CURRENT_LSB_A = 10.0 / 524288.0;
+// The driver scales in float, as the firmware does
+static const double ENERGY_LSB_J = (double)(INA228_ENERGY_LSB_SCALE * (float)CURRENT_LSB_A);
+static constexpr uint64_t WRAP = 1ULL << 40;
+
+// INA228 register map: 16-bit registers through readRegister16 and
+// writeRegister16, the 24- and 40-bit results through readRegisterBytes,
+// most significant byte first. Writing RSTACC to CONFIG clears ENERGY and
+// CHARGE, as on the part.
+class SimulatedIna228 : public RegisterBus {
+public:
+  SimulatedIna228()
+  {
+    regs_[INA228_REG_MANUFACTURER_ID] = INA228_MANUFACTURER_ID_TI;
+    regs_[INA228_REG_DEVICE_ID] = (INA228_DEVICE_ID << 4) | 0x1;
+  }
+
+  uint64_t reg(uint8_t reg) const
+  {
+    auto it = regs_.find(reg);
+    return it == regs_.end() ? 0 : it->second;
+  }
+
+  void set(uint8_t reg, uint64_t value) { regs_[reg] = value; }
+
+  // A 20-bit signed result in bits 23..4
+  void setResult20(uint8_t reg, int32_t counts) { regs_[reg] = ((uint64_t)(counts & 0xFFFFF)) << 4; }
+
+  void setAccumulators(uint64_t energy, int64_t charge)
+  {
+    regs_[INA228_REG_ENERGY] = energy & (WRAP - 1);
+    regs_[INA228_REG_CHARGE] = (uint64_t)charge & (WRAP - 1);
+  }
+
+  // The chip integrating: both registers move and wrap at 40 bits
+  void accumulate(uint64_t energyCounts, int64_t chargeCounts)
+  {
+    setAccumulators(regs_[INA228_REG_ENERGY] + energyCounts, (int64_t)(regs_[INA228_REG_CHARGE] + (uint64_t)chargeCounts));
+  }
+
+  bool writeRegister16(uint8_t address, uint8_t reg, uint16_t value) override
+  {
+    countBytes(4);
+    if (address != INA228_ADDRESS) {
+      return false;
+    }
+    if (reg == INA228_REG_CONFIG && (value & INA228_CONFIG_RSTACC) != 0) {
+      setAccumulators(0, 0);
+      value &= (uint16_t)~INA228_CONFIG_RSTACC;
+    }
+    regs_[reg] = value;
+    return true;
+  }
+
+  bool readRegister16(uint8_t address, uint8_t reg, uint16_t *value) override
+  {
+    countBytes(5);
+    if (address != INA228_ADDRESS) {
+      return false;
+    }
+    *value = (uint16_t)this->reg(reg);
+    return true;
+  }
+
+  bool readSelectedRegister16(uint8_t, uint16_t *) override { return false; }
+
+  bool readRegisterBytes(uint8_t address, uint8_t reg, uint8_t *data, size_t length) override
+  {
+    countBytes(3 + (uint32_t)length);
+    if (address != INA228_ADDRESS) {
+      return false;
+    }
+    uint64_t value = this->reg(reg);
+    for (size_t i = 0; i < length; i++) {
+      data[i] = (uint8_t)(value >> (8 * (length - 1 - i)));
+    }
+    return true;
+  }
+
+  bool writeRegisterBytes(uint8_t, uint8_t, const uint8_t *, size_t) override { return false; }
+
+private:
+  std::map<uint8_t, uint64_t> regs_;
+};
+
+static SimulatedIna228 *sim;
+static Ina228Driver *driver;
+
+void setUp(void)
+{
+  sim = new SimulatedIna228();
+  driver = new Ina228Driver();
+  TEST_ASSERT_TRUE(driver->begin(sim, INA228_ADDRESS, SHUNT_OHMS, MAX_CURRENT_A));
+}
+
+void tearDown(void)
+{
+  delete driver;
+  delete sim;
+}
+
+// SHUNT_CAL = 13107.2e6 * (10 A / 2^19) * 0.015 ohm = 3750
+static void test_begin_programs_shunt_cal(void)
+{
+  TEST_ASSERT_EQUAL_UINT32(3750, sim->reg(INA228_REG_SHUNT_CAL));
+  TEST_ASSERT_EQUAL_UINT32(0, sim->reg(INA228_REG_CONFIG));
+
+  SimulatedIna228 other;
+  Ina228Driver small;
+  TEST_ASSERT_TRUE(small.begin(&other, INA228_ADDRESS, 0.1f, 1.0f));
+  TEST_ASSERT_EQUAL_UINT32(2500, other.reg(INA228_REG_SHUNT_CAL));
+}
+
+static void test_begin_rejects_bad_ids_and_unreachable_calibration(void)
+{
+  SimulatedIna228 wrongDevice;
+  wrongDevice.set(INA228_REG_DEVICE_ID, 0x2370);  // an INA237
+  Ina228Driver other;
+  TEST_ASSERT_FALSE(other.begin(&wrongDevice, INA228_ADDRESS, SHUNT_OHMS, MAX_CURRENT_A));
+  TEST_ASSERT_FALSE(other.begin(sim, 0x40, SHUNT_OHMS, MAX_CURRENT_A));
+  // SHUNT_CAL is 15 bits: 1 ohm at 10 A would need 250000
+  TEST_ASSERT_FALSE(other.begin(sim, INA228_ADDRESS, 1.0f, MAX_CURRENT_A));
+  TEST_ASSERT_FALSE(other.ready());
+}
+
+static void test_current_is_signed_20_bit(void)
+{
+  ina228_reading_t reading = {};
+  sim->setResult20(INA228_REG_VBUS, 61440);  // 12 V
+  const int32_t counts[] = {0, 1, -1, 12345, -12345, 524287, -524288};
+  for (int32_t count : counts) {
+    sim->setResult20(INA228_REG_CURRENT, count);
+    TEST_ASSERT_TRUE(driver->read(&reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, (float)(count * CURRENT_LSB_A), reading.current_a);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 12.0f, reading.bus_voltage_v);
+  }
+  // Two 3-byte reads, each with its register pointer write
+  TEST_ASSERT_EQUAL_UINT32(12, driver->lastSampleBytes());
+}
+
+static void test_totals_scale_accumulator_counts(void)
+{
+  ina228_totals_t totals = {};
+  sim->setAccumulators(1000000, -250000);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1000000 * ENERGY_LSB_J, totals.energy_j);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-9, -250000 * CURRENT_LSB_A, totals.charge_c);
+  TEST_ASSERT_EQUAL_UINT32(0, totals.overflows);
+}
+
+// The chip counts on across the 40-bit wrap; the totals keep going up and
+// each register wrap is counted once.
+static void test_energy_and_charge_continue_across_40_bit_wrap(void)
+{
+  ina228_totals_t totals = {};
+  const uint64_t startEnergy = WRAP - 5000;
+  const int64_t startCharge = (int64_t)(1ULL << 39) - 3000;  // just under the positive limit
+  sim->setAccumulators(startEnergy, startCharge);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+
+  uint64_t trueEnergy = startEnergy;
+  int64_t trueCharge = startCharge;
+  for (uint32_t i = 0; i < 10; i++) {
+    sim->accumulate(1200, 700);
+    trueEnergy += 1200;
+    trueCharge += 700;
+    TEST_ASSERT_TRUE(driver->readTotals(&totals));
+    TEST_ASSERT_DOUBLE_WITHIN(trueEnergy * ENERGY_LSB_J * 1e-12, (double)trueEnergy * ENERGY_LSB_J, totals.energy_j);
+    TEST_ASSERT_DOUBLE_WITHIN(trueCharge * CURRENT_LSB_A * 1e-12, (double)trueCharge * CURRENT_LSB_A, totals.charge_c);
+  }
+  TEST_ASSERT_TRUE(trueEnergy > WRAP);
+  TEST_ASSERT_TRUE(trueCharge > (int64_t)(1ULL << 39));
+  TEST_ASSERT_EQUAL_UINT32(2, totals.overflows);
+}
+
+// Discharge moves CHARGE downwards through zero: that is a sign change,
+// not a wrap.
+static void test_charge_through_zero_is_not_a_wrap(void)
+{
+  ina228_totals_t totals = {};
+  sim->setAccumulators(0, 2000);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  sim->accumulate(0, -5000);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  TEST_ASSERT_DOUBLE_WITHIN(1e-12, -3000 * CURRENT_LSB_A, totals.charge_c);
+  TEST_ASSERT_EQUAL_UINT32(0, totals.overflows);
+
+  // And the negative limit the other way round
+  TEST_ASSERT_TRUE(driver->resetAccumulators());
+  sim->setAccumulators(0, -(int64_t)(1ULL << 39) + 100);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  sim->accumulate(0, -300);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  TEST_ASSERT_DOUBLE_WITHIN(1e-3, (double)(-(int64_t)(1ULL << 39) - 200) * CURRENT_LSB_A, totals.charge_c);
+  TEST_ASSERT_EQUAL_UINT32(1, totals.overflows);
+}
+
+static void test_reset_clears_chip_and_totals(void)
+{
+  ina228_totals_t totals = {};
+  sim->setAccumulators(WRAP - 10, 0);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  sim->accumulate(20, 0);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  TEST_ASSERT_EQUAL_UINT32(1, totals.overflows);
+
+  TEST_ASSERT_TRUE(driver->resetAccumulators());
+  TEST_ASSERT_EQUAL_UINT64(0, sim->reg(INA228_REG_ENERGY));
+  sim->accumulate(500, 40);
+  TEST_ASSERT_TRUE(driver->readTotals(&totals));
+  TEST_ASSERT_DOUBLE_WITHIN(1e-12, 500 * ENERGY_LSB_J, totals.energy_j);
+  TEST_ASSERT_DOUBLE_WITHIN(1e-12, 40 * CURRENT_LSB_A, totals.charge_c);
+  TEST_ASSERT_EQUAL_UINT32(0, totals.overflows);
+}
+
+// A year of a 10 A, 12 V load with the totals read once an hour: the
+// extended counts match what the chip added, through several wraps of both
+// registers.
+static void test_long_run_tracks_many_wraps(void)
+{
+  Ina228Accumulators accumulators;
+  accumulators.reset();
+  const uint32_t reads = 24 * 400;
+  const uint64_t perReadEnergy = (uint64_t)(120.0 * 3600.0 / ENERGY_LSB_J);
+  const int64_t perReadCharge = (int64_t)(10.0 * 3600.0 / CURRENT_LSB_A);
+  uint64_t energyRaw = WRAP - 7;
+  uint64_t chargeRaw = 0;
+  uint32_t wraps = accumulators.update(energyRaw, chargeRaw);
+  for (uint32_t i = 0; i < reads; i++) {
+    energyRaw = (energyRaw + perReadEnergy) & (WRAP - 1);
+    chargeRaw = (chargeRaw + (uint64_t)perReadCharge) & (WRAP - 1);
+    wraps += accumulators.update(energyRaw, chargeRaw);
+  }
+  TEST_ASSERT_EQUAL_INT64((int64_t)(WRAP - 7) + (int64_t)reads * (int64_t)perReadEnergy, accumulators.energyCounts());
+  TEST_ASSERT_EQUAL_INT64((int64_t)reads * perReadCharge, accumulators.chargeCounts());
+  TEST_ASSERT_GREATER_THAN_UINT32(10, wraps);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_programs_shunt_cal);
+  RUN_TEST(test_begin_rejects_bad_ids_and_unreachable_calibration);
+  RUN_TEST(test_current_is_signed_20_bit);
+  RUN_TEST(test_totals_scale_accumulator_counts);
+  RUN_TEST(test_energy_and_charge_continue_across_40_bit_wrap);
+  RUN_TEST(test_charge_through_zero_is_not_a_wrap);
+  RUN_TEST(test_reset_clears_chip_and_totals);
+  RUN_TEST(test_long_run_tracks_many_wraps);
+  return UNITY_END();
+}
@@ -0,0 +1,239 @@
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "control/load_profile.h"
+
+// The firmware's player settings and the default profile
+static constexpr float LEARN_GAIN_V_PER_A = 0.3f;
+static constexpr float OUTPUT_MAX_V = 10.0f;
+static constexpr uint32_t SETTLE_US = 1000;
+static constexpr const char *DEFAULT_PROFILE = "10ms 2A, 990ms 5mA";
+
+// INA226 conversion periods of the Fast Transient and Balanced presets
+static constexpr uint32_t FAST_TRANSIENT_US = 280;
+static constexpr uint32_t BALANCED_US = 35200;
+
+// Load stage: 1 A per volt above 1.6 V, fast enough to settle well inside
+// SETTLE_US. The calibration the firmware seeds from is a few percent off.
+static constexpr float STAGE_THRESHOLD_V = 1.6f;
+static float stageCurrentA(float outputV) { return fmaxf(outputV - STAGE_THRESHOLD_V, 0.0f); }
+static float calibrationV(float targetA) { return 1.55f + targetA / 1.05f; }
+static float idealV(float targetA) { return STAGE_THRESHOLD_V + targetA; }
+
+// The firmware's timing around the player, in 10 us ticks:
+// - the edge timer advances the player; the DAC takes the new level
+//   DAC_LATENCY_US later, when the bus owner gets to the write
+// - the sample timer reads every 50 ms, and with settle reads on, one more
+//   read is taken learnDelayUs() into every step that can hold it
+// - a read returns the sensor's last finished conversion, the mean current
+//   over its window, and is recorded against the step it was taken in
+// - the control task runs every 20 ms and learns each step's newest
+//   recorded reading, as loadControlTask does
+struct PulsedLoadModel {
+  static constexpr uint64_t TICK_US = 10;
+  static constexpr uint64_t SAMPLE_US = 50000;
+  static constexpr uint64_t CONTROL_US = 20000;
+  static constexpr uint64_t DAC_LATENCY_US = 200;
+  static constexpr float STAGE_TAU_US = 50.0f;
+
+  LoadProfilePlayer player{LEARN_GAIN_V_PER_A, OUTPUT_MAX_V, SETTLE_US};
+  load_profile_t profile = {};
+  bool settleReads = true;
+  uint32_t conversionUs = FAST_TRANSIENT_US;
+
+  uint32_t learned[LOAD_PROFILE_MAX_STEPS] = {};
+
+  void run(uint64_t durationUs, uint64_t startUs)
+  {
+    player.setConversionWindow(conversionUs);
+    player.start(profile, startUs, 1.0f);
+    for (uint8_t i = 0; i < profile.count; i++) {
+      player.seedOutput(i, calibrationV(profile.steps[i].current_a));
+    }
+
+    float dacV = player.outputV(0);
+    float pendingV = dacV;
+    uint64_t pendingAtUs = UINT64_MAX;
+    float currentA = 0.0f;
+    double conversionSum = 0.0;
+    uint32_t conversionTicks = 0;
+    float registerA = 0.0f;
+    uint64_t settleReadUs = nextSettleRead(startUs);
+
+    for (uint64_t t = startUs; t < startUs + durationUs; t += TICK_US) {
+      if (t >= player.nextEdgeUs()) {
+        player.advance();
+        pendingV = player.outputV(player.step());
+        pendingAtUs = t + DAC_LATENCY_US;
+        settleReadUs = nextSettleRead(t);
+      }
+      if (t >= pendingAtUs) {
+        dacV = pendingV;
+        pendingAtUs = UINT64_MAX;
+      }
+
+      currentA += (stageCurrentA(dacV) - currentA) * (1.0f - expf(-(float)TICK_US / STAGE_TAU_US));
+      conversionSum += currentA;
+      if (++conversionTicks * TICK_US >= conversionUs) {
+        registerA = (float)(conversionSum / conversionTicks);
+        conversionSum = 0.0;
+        conversionTicks = 0;
+      }
+
+      bool sampleRead = (t % SAMPLE_US) == 0;
+      bool settleRead = settleReads && t == settleReadUs;
+      if (sampleRead || settleRead) {
+        uint64_t stepStartUs;
+        uint8_t step;
+        if (player.activeStep(&step, &stepStartUs)) {
+          (void)player.record(step, (uint32_t)(t - stepStartUs), registerA);
+        }
+      }
+
+      if ((t % CONTROL_US) == 0) {
+        uint8_t activeStep = player.step();
+        for (uint8_t i = 0; i < player.stepCount(); i++) {
+          if (!player.learn(i)) {
+            continue;
+          }
+          learned[i]++;
+          if (i == activeStep) {
+            pendingV = player.outputV(i);
+            pendingAtUs = t + DAC_LATENCY_US;
+          }
+        }
+      }
+    }
+  }
+
+  // The settle read of the step that just began, on the model's tick grid
+  uint64_t nextSettleRead(uint64_t edgeUs) const
+  {
+    if (!player.learnable(player.step())) {
+      return UINT64_MAX;
+    }
+    uint64_t readUs = edgeUs + player.learnDelayUs();
+    return (readUs + TICK_US - 1) / TICK_US * TICK_US;
+  }
+};
+
+static PulsedLoadModel *model;
+
+void setUp(void)
+{
+  model = new PulsedLoadModel();
+  TEST_ASSERT_TRUE(parseLoadProfile(DEFAULT_PROFILE, 10.0f, &model->profile) == LoadProfileError::None);
+}
+
+void tearDown(void)
+{
+  delete model;
+}
+
+// Readings count only from learnDelayUs() into a step, and each step keeps
+// its newest one until it is learned from, once.
+static void test_learn_waits_for_settle_and_two_conversions(void)
+{
+  LoadProfilePlayer &player = model->player;
+  player.start(model->profile, 0, 1.0f);
+  TEST_ASSERT_EQUAL_UINT32(SETTLE_US, player.learnDelayUs());
+  player.setConversionWindow(FAST_TRANSIENT_US);
+  TEST_ASSERT_EQUAL_UINT32(SETTLE_US + 2 * FAST_TRANSIENT_US, player.learnDelayUs());
+  TEST_ASSERT_FALSE(player.record(0, SETTLE_US, 1.0f));
+  TEST_ASSERT_FALSE(player.record(0, player.learnDelayUs() - 1, 1.0f));
+  TEST_ASSERT_FALSE(player.learn(0));
+  TEST_ASSERT_TRUE(player.record(0, player.learnDelayUs(), 1.0f));
+  TEST_ASSERT_TRUE(player.learnable(0));
+  TEST_ASSERT_TRUE(player.learnable(1));
+
+  // 2 A wanted, 1 A measured: 0.3 V/A more than the 2 V seed
+  TEST_ASSERT_TRUE(player.record(1, 500000, 0.004f));
+  TEST_ASSERT_TRUE(player.record(0, player.learnDelayUs() + 10, 1.5f));
+  TEST_ASSERT_TRUE(player.learn(0));
+  TEST_ASSERT_FALSE(player.learn(0));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f + 0.3f * 0.5f, player.outputV(0));
+  TEST_ASSERT_TRUE(player.learn(1));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.005f + 0.3f * 0.001f, player.outputV(1));
+
+  // A restart drops what was recorded for the previous run
+  TEST_ASSERT_TRUE(player.record(0, player.learnDelayUs(), 1.0f));
+  player.start(model->profile, 0, 1.0f);
+  TEST_ASSERT_FALSE(player.learn(0));
+
+  // Balanced: 71.4 ms, longer than the 10 ms pulse
+  player.setConversionWindow(BALANCED_US);
+  TEST_ASSERT_FALSE(player.learnable(0));
+  TEST_ASSERT_TRUE(player.learnable(1));
+  TEST_ASSERT_FALSE(player.learnable(2));
+}
+
+// The default profile at the firmware's 50 ms sample floor. The sample
+// timer and the profile share one clock, so every sample lands in the long
+// step: without the settle read the 10 ms pulse is never learned.
+static void test_sample_floor_alone_never_learns_the_pulse(void)
+{
+  model->settleReads = false;
+  model->run(30000000, 3700);
+  TEST_ASSERT_EQUAL_UINT32(0, model->learned[0]);
+  TEST_ASSERT_TRUE(model->learned[1] > 100);
+  TEST_ASSERT_EQUAL_FLOAT(calibrationV(2.0f), model->player.outputV(0));
+}
+
+// With the settle read every loop of the profile learns the pulse once, and
+// the level converges on the stage's true 2 A setting. A reading taken
+// before a whole conversion fitted after the edge would bias it low.
+static void test_settle_reads_learn_the_pulse(void)
+{
+  model->run(30000000, 3700);
+  char line[120];
+  snprintf(line, sizeof(line), "pulse learned %u times in 30 loops: %.4f V (ideal %.4f V); base %.4f V (ideal %.4f V)",
+           (unsigned)model->learned[0], model->player.outputV(0), idealV(2.0f), model->player.outputV(1),
+           idealV(0.005f));
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(model->learned[0] >= 25);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * 2.0f, idealV(2.0f), model->player.outputV(0));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, idealV(0.005f), model->player.outputV(1));
+}
+
+// At the Balanced preset a conversion outlasts the pulse: the pulse keeps
+// its seeded level rather than learning from readings of the other step,
+// which would drive it toward full scale.
+static void test_pulse_shorter_than_a_conversion_keeps_its_seed(void)
+{
+  model->conversionUs = BALANCED_US;
+  model->run(30000000, 3700);
+  TEST_ASSERT_EQUAL_UINT32(0, model->learned[0]);
+  TEST_ASSERT_EQUAL_FLOAT(calibrationV(2.0f), model->player.outputV(0));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, idealV(0.005f), model->player.outputV(1));
+}
+
+static void test_parse_and_validate(void)
+{
+  load_profile_t profile = {};
+  size_t errorStep = 0;
+  TEST_ASSERT_TRUE(parseLoadProfile("500us 1A, 2s 250mA", 10.0f, &profile) == LoadProfileError::StepTooShort);
+  TEST_ASSERT_TRUE(parseLoadProfile("2ms 1A, 2s 250mA", 10.0f, &profile, &errorStep) == LoadProfileError::None);
+  TEST_ASSERT_EQUAL_UINT8(2, profile.count);
+  TEST_ASSERT_EQUAL_UINT32(2000, profile.steps[0].duration_us);
+  TEST_ASSERT_EQUAL_FLOAT(0.25f, profile.steps[1].current_a);
+  TEST_ASSERT_EQUAL_UINT64(2002000, loadProfilePeriodUs(profile));
+  TEST_ASSERT_TRUE(parseLoadProfile("10ms 2A, 10ms 12A", 10.0f, &profile, &errorStep) ==
+                   LoadProfileError::CurrentOutOfRange);
+  TEST_ASSERT_EQUAL_UINT32(1, errorStep);
+  TEST_ASSERT_EQUAL_UINT8(2, profile.count);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_learn_waits_for_settle_and_two_conversions);
+  RUN_TEST(test_sample_floor_alone_never_learns_the_pulse);
+  RUN_TEST(test_settle_reads_learn_the_pulse);
+  RUN_TEST(test_pulse_shorter_than_a_conversion_keeps_its_seed);
+  RUN_TEST(test_parse_and_validate);
+  return UNITY_END();
+}
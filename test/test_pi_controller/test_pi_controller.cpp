@@ -0,0 +1,259 @@
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "control/pi_controller.h"
+
+// The firmware's loop: 20 ms updates with these gains and limits on the
+// DAC2's 0-10 V output
+static constexpr float DT_S = 0.02f;
+static constexpr uint64_t DT_US = 20000;
+static constexpr float KP = 0.4f;
+static constexpr float KI = 15.0f;
+static constexpr float SLEW = 20.0f;
+static constexpr float OUT_MAX = 10.0f;
+static const pi_controller_config_t CONFIG = {KP, KI, 0.0f, OUT_MAX, SLEW};
+
+// The firmware's settle criteria
+static constexpr float BAND = 0.02f;
+static constexpr float BAND_MIN_A = 0.005f;
+static constexpr float HOLD_S = 0.2f;
+static constexpr float TIMEOUT_S = 5.0f;
+
+// Simulated MOSFET load stage, the plant the gains were tuned on: about
+// 1 A per volt above a 1.6 V threshold, a 4 ms first-order lag, and a pack
+// that drops out at maxA. Each reading is taken under the output written on
+// the previous update, as in the firmware where the DAC write follows the
+// read.
+struct MosfetLoad {
+  float gainAPerV = 1.0f;
+  float thresholdV = 1.6f;
+  float tauS = 0.004f;
+  float maxA = 6.6f;
+  float currentA = 0.0f;
+
+  float steadyA(float gateV) const { return fminf(fmaxf(gainAPerV * (gateV - thresholdV), 0.0f), maxA); }
+
+  float advance(float gateV, float dtS)
+  {
+    currentA += (steadyA(gateV) - currentA) * (1.0f - expf(-dtS / tauS));
+    return currentA;
+  }
+};
+
+// A calibration slightly off the plant, as a fitted one would be
+static float feedforwardV(float targetA)
+{
+  return targetA > 0.0f ? 1.55f + targetA / 1.05f : 0.0f;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_output_is_clamped_and_flagged(void)
+{
+  pi_controller_config_t config = CONFIG;
+  config.slewPerSecond = 0.0f;
+  PiController controller(config);
+  controller.reset(0.0f);
+  TEST_ASSERT_EQUAL_FLOAT(OUT_MAX, controller.step(1000.0f, 0.0f, DT_S));
+  TEST_ASSERT_TRUE(controller.saturated());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, controller.step(-1000.0f, 0.0f, DT_S));
+  TEST_ASSERT_TRUE(controller.saturated());
+
+  controller.reset(25.0f);
+  TEST_ASSERT_EQUAL_FLOAT(OUT_MAX, controller.output());
+}
+
+static void test_invalid_inputs_hold_the_output(void)
+{
+  PiController controller(CONFIG);
+  controller.reset(3.0f);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, controller.step(1.0f, NAN, DT_S));
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, controller.step(NAN, 1.0f, DT_S));
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, controller.step(1.0f, 0.0f, 0.0f));
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, controller.step(1.0f, 0.0f, -DT_S));
+}
+
+// Without feedforward, no update moves the output more than slew * dt
+static void test_slew_limits_every_update(void)
+{
+  PiController controller(CONFIG);
+  controller.reset(0.0f);
+  MosfetLoad load;
+  float previous = 0.0f;
+  float measured = 0.0f;
+  bool limited = false;
+  for (uint32_t i = 0; i < 200; i++) {
+    float setpoint = (i < 100) ? 8.0f : 0.5f;
+    float output = controller.step(setpoint, measured, DT_S);
+    TEST_ASSERT_TRUE(fabsf(output - previous) <= SLEW * DT_S + 1e-5f);
+    limited |= controller.saturated();
+    previous = output;
+    measured = load.advance(output, DT_S);
+  }
+  TEST_ASSERT_TRUE(limited);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, measured);
+}
+
+// Feedforward is outside the slew limit: a setpoint change lands on the
+// calibrated level in one update and only the correction is rate-limited.
+static void test_feedforward_lands_in_one_update(void)
+{
+  PiController controller(CONFIG);
+  controller.reset(0.0f);
+  float output = controller.step(5.0f, 0.0f, DT_S, feedforwardV(5.0f));
+  TEST_ASSERT_FLOAT_WITHIN(SLEW * DT_S + 1e-5f, feedforwardV(5.0f), output);
+
+  MosfetLoad load;
+  float measured = load.advance(output, DT_S);
+  for (uint32_t i = 0; i < 50; i++) {
+    measured = load.advance(controller.step(5.0f, measured, DT_S, feedforwardV(5.0f)), DT_S);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 5.0f, measured);
+}
+
+// The pack cannot deliver the target, so the output sits at full scale for
+// ten seconds. When the target drops back into reach the output leaves the
+// limit on the next update instead of unwinding a stored integral.
+static void test_no_windup_against_an_unreachable_target(void)
+{
+  PiController controller(CONFIG);
+  controller.reset(0.0f);
+  MosfetLoad load;
+  load.maxA = 3.0f;
+  float measured = 0.0f;
+  for (uint32_t i = 0; i < 500; i++) {
+    measured = load.advance(controller.step(6.0f, measured, DT_S), DT_S);
+  }
+  // Unconditional integration would now hold 15 * 3 A * 10 s = 450 V,
+  // fifteen seconds of unwinding at the -2 A error below
+  TEST_ASSERT_EQUAL_FLOAT(OUT_MAX, controller.output());
+  TEST_ASSERT_TRUE(controller.saturated());
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, measured);
+
+  float output = controller.step(1.0f, measured, DT_S);
+  TEST_ASSERT_TRUE(output < OUT_MAX);
+  uint32_t updates = 1;
+  measured = load.advance(output, DT_S);
+  while (fabsf(measured - 1.0f) > 0.05f && updates < 500) {
+    measured = load.advance(controller.step(1.0f, measured, DT_S), DT_S);
+    updates++;
+  }
+  // Slewing 10 V down to 2.6 V alone takes 19 updates; a second in all is
+  // ample, where a wound-up integral would take fifteen
+  TEST_ASSERT_TRUE(updates <= 50);
+}
+
+static void test_monitor_measures_a_synthetic_trace(void)
+{
+  StepResponseMonitor monitor(BAND, BAND_MIN_A, HOLD_S, TIMEOUT_S);
+  monitor.begin(0.0f, 2.0f, 0);
+  TEST_ASSERT_TRUE(monitor.active());
+  // Rise to 2.2 A (10% over), ring back into the 40 mA band at 300 ms
+  const float trace[] = {0.5f, 1.5f, 2.2f, 2.1f, 1.95f, 2.05f, 1.99f};
+  uint64_t tUs = 0;
+  for (float value : trace) {
+    tUs += 50000;
+    TEST_ASSERT_FALSE(monitor.update(value, tUs));
+  }
+  // 2.05 at 300 ms is outside; 1.99 at 350 ms starts the stint that holds
+  bool done = false;
+  while (!done) {
+    tUs += 50000;
+    done = monitor.update(2.0f, tUs);
+  }
+  TEST_ASSERT_FALSE(monitor.active());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.1f, monitor.overshootFraction());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.35f, monitor.settlingS());
+  TEST_ASSERT_EQUAL_UINT64(550000, tUs);
+}
+
+// Downward steps measure overshoot below the target; the band never shrinks
+// below bandMin; a trace that never settles times out with NAN.
+static void test_monitor_down_step_band_floor_and_timeout(void)
+{
+  StepResponseMonitor monitor(BAND, BAND_MIN_A, HOLD_S, TIMEOUT_S);
+  monitor.begin(2.0f, 0.1f, 1000000);
+  monitor.update(0.05f, 1100000);
+  // 2% of 1.9 A is 38 mA; 0.14 A is outside, 0.104 A is inside
+  monitor.update(0.14f, 1200000);
+  monitor.update(0.104f, 1300000);
+  TEST_ASSERT_TRUE(monitor.update(0.1f, 1500000));
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.05f / 1.9f, monitor.overshootFraction());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, monitor.settlingS());
+
+  // A 100 mA step has a 2 mA band by fraction; the 5 mA floor applies
+  monitor.begin(0.0f, 0.1f, 0);
+  monitor.update(0.104f, 0);
+  TEST_ASSERT_TRUE(monitor.update(0.104f, 200000));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, monitor.settlingS());
+
+  monitor.begin(0.0f, 1.0f, 0);
+  bool done = false;
+  uint64_t tUs = 0;
+  while (!done) {
+    tUs += DT_US;
+    done = monitor.update((tUs / DT_US) % 2 ? 0.9f : 1.1f, tUs);
+  }
+  TEST_ASSERT_TRUE(isnan(monitor.settlingS()));
+  TEST_ASSERT_EQUAL_UINT64(5000000, tUs);
+
+  monitor.begin(1.0f, 1.0f, 0);
+  TEST_ASSERT_FALSE(monitor.active());
+}
+
+// The closed loop with the firmware's gains on the simulated stage, no
+// calibration: steps across the range settle inside the firmware's 5 s
+// timeout without overshoot; a step past the pack's dropout is reported
+// unsettled, and the step after it settles normally.
+static void test_closed_loop_step_response(void)
+{
+  PiController controller(CONFIG);
+  controller.reset(0.0f);
+  MosfetLoad load;
+  StepResponseMonitor monitor(BAND, BAND_MIN_A, HOLD_S, TIMEOUT_S);
+  const float targets[] = {1.0f, 3.0f, 0.5f, 8.0f, 2.0f};
+  float measured = 0.0f;
+  uint64_t tUs = 0;
+  for (float target : targets) {
+    monitor.begin(measured, target, tUs);
+    bool done = false;
+    while (!done) {
+      float output = controller.step(target, measured, DT_S);
+      tUs += DT_US;
+      measured = load.advance(output, DT_S);
+      done = monitor.update(measured, tUs);
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "step to %.1f A: settled in %.0f ms, overshoot %.1f%%", target,
+             monitor.settlingS() * 1000.0f, monitor.overshootFraction() * 100.0f);
+    TEST_MESSAGE(line);
+    if (target > load.maxA) {
+      TEST_ASSERT_TRUE(isnan(monitor.settlingS()));
+      TEST_ASSERT_EQUAL_FLOAT(OUT_MAX, controller.output());
+      continue;
+    }
+    TEST_ASSERT_FALSE(isnan(monitor.settlingS()));
+    TEST_ASSERT_TRUE(monitor.settlingS() < 1.0f);
+    TEST_ASSERT_TRUE(monitor.overshootFraction() < 0.01f);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_output_is_clamped_and_flagged);
+  RUN_TEST(test_invalid_inputs_hold_the_output);
+  RUN_TEST(test_slew_limits_every_update);
+  RUN_TEST(test_feedforward_lands_in_one_update);
+  RUN_TEST(test_no_windup_against_an_unreachable_target);
+  RUN_TEST(test_monitor_measures_a_synthetic_trace);
+  RUN_TEST(test_monitor_down_step_band_floor_and_timeout);
+  RUN_TEST(test_closed_loop_step_response);
+  return UNITY_END();
+}
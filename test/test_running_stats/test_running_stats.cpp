@@ -0,0 +1,189 @@
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "acquisition/running_stats.h"
+
+// The firmware's window: 60 one-second buckets
+typedef WindowedStats<60, 1000000> window_stats_t;
+
+struct two_pass_t {
+  double min;
+  double max;
+  double mean;
+  double stddev;
+  double rms;
+};
+
+static two_pass_t twoPass(const std::vector<float> &values, size_t first = 0)
+{
+  two_pass_t out = {INFINITY, -INFINITY, 0.0, 0.0, 0.0};
+  double sum = 0.0;
+  double sumSquares = 0.0;
+  for (size_t i = first; i < values.size(); i++) {
+    out.min = fmin(out.min, values[i]);
+    out.max = fmax(out.max, values[i]);
+    sum += values[i];
+    sumSquares += (double)values[i] * values[i];
+  }
+  double n = (double)(values.size() - first);
+  out.mean = sum / n;
+  double m2 = 0.0;
+  for (size_t i = first; i < values.size(); i++) {
+    double d = values[i] - out.mean;
+    m2 += d * d;
+  }
+  out.stddev = sqrt(m2 / n);
+  out.rms = sqrt(sumSquares / n);
+  return out;
+}
+
+static void assertMatches(const two_pass_t &ref, const RunningStats &stats, double relTol)
+{
+  TEST_ASSERT_EQUAL_FLOAT((float)ref.min, stats.min());
+  TEST_ASSERT_EQUAL_FLOAT((float)ref.max, stats.max());
+  TEST_ASSERT_DOUBLE_WITHIN(fabs(ref.mean) * relTol, ref.mean, stats.mean());
+  TEST_ASSERT_DOUBLE_WITHIN(ref.stddev * relTol, ref.stddev, stats.stddev());
+  TEST_ASSERT_DOUBLE_WITHIN(ref.rms * relTol, ref.rms, stats.rms());
+}
+
+// Pack-voltage-like signal: a large offset with small noise and a sag,
+// which is where a naive sum-of-squares variance cancels badly.
+static float sampleAt(uint32_t i)
+{
+  uint32_t noise = i * 2654435761u;
+  return 12.4f - 0.2f * (float)(i % 5000) / 5000.0f + 0.001f * (float)((noise >> 16) % 1000) / 1000.0f;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_empty_stats_are_nan(void)
+{
+  RunningStats stats;
+  TEST_ASSERT_EQUAL_UINT32(0, stats.count());
+  TEST_ASSERT_TRUE(isnan(stats.min()));
+  TEST_ASSERT_TRUE(isnan(stats.mean()));
+  TEST_ASSERT_TRUE(isnan(stats.rms()));
+  window_stats_t window;
+  TEST_ASSERT_EQUAL_UINT32(0, window.summary(0).count());
+}
+
+static void test_whole_test_matches_two_pass(void)
+{
+  std::vector<float> values;
+  RunningStats stats;
+  for (uint32_t i = 0; i < 2000000; i++) {
+    values.push_back(sampleAt(i));
+    stats.add(values.back());
+  }
+  TEST_ASSERT_EQUAL_UINT32(values.size(), stats.count());
+  assertMatches(twoPass(values), stats, 1e-9);
+}
+
+// Merging halves gives the same result as adding everything to one block
+static void test_merge_matches_single_pass(void)
+{
+  std::vector<float> values;
+  RunningStats whole;
+  RunningStats first;
+  RunningStats second;
+  for (uint32_t i = 0; i < 100000; i++) {
+    float value = sampleAt(i) * (i < 30000 ? 1.0f : -0.5f);
+    values.push_back(value);
+    whole.add(value);
+    (i < 30000 ? first : second).add(value);
+  }
+  first.merge(second);
+  TEST_ASSERT_EQUAL_UINT32(whole.count(), first.count());
+  assertMatches(twoPass(values), first, 1e-9);
+  TEST_ASSERT_DOUBLE_WITHIN(whole.stddev() * 1e-9, whole.stddev(), first.stddev());
+}
+
+// 10 ms samples for five minutes: the window reports exactly the last 60
+// whole buckets, matching a two-pass result over those samples.
+static void test_window_covers_the_last_minute(void)
+{
+  std::vector<float> values;
+  window_stats_t window;
+  uint64_t tUs = 0;
+  for (uint32_t i = 0; i < 30000; i++) {
+    tUs = (uint64_t)i * 10000;
+    values.push_back(sampleAt(i) + (i == 1000 ? 5.0f : 0.0f));  // an old spike
+    window.add(tUs, values.back());
+  }
+  RunningStats summary = window.summary(tUs);
+  // Buckets 240..299 of the 300 one-second buckets
+  size_t first = 24000;
+  TEST_ASSERT_EQUAL_UINT32(values.size() - first, summary.count());
+  assertMatches(twoPass(values, first), summary, 1e-9);
+  TEST_ASSERT_TRUE(summary.max() < 13.0f);
+}
+
+// Buckets age out a second at a time; after a gap, the ones the clock
+// skipped are empty while those still inside the window keep their values.
+static void test_window_ages_out_across_gaps(void)
+{
+  window_stats_t window;
+  for (uint32_t s = 0; s < 60; s++) {
+    window.add((uint64_t)s * 1000000, 1.0f);
+  }
+  TEST_ASSERT_EQUAL_UINT32(60, window.summary(59500000).count());
+  TEST_ASSERT_EQUAL_UINT32(30, window.summary(89500000).count());
+  TEST_ASSERT_EQUAL_UINT32(0, window.summary(120000000).count());
+
+  // Buckets 41..59 are still inside a window ending at 100 s
+  window.add(100000000, 2.0f);
+  RunningStats summary = window.summary(100000000);
+  TEST_ASSERT_EQUAL_UINT32(20, summary.count());
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, summary.max());
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, summary.min());
+}
+
+// The per-sample cost in the acquisition path: four metrics, each into
+// the whole-test block and the window, as main.cpp does.
+static void test_benchmark_cost_per_sample(void)
+{
+  static constexpr uint32_t BENCH_SAMPLES = 5000000;
+  RunningStats testStats[4];
+  window_stats_t windowStats[4];
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    uint64_t tUs = (uint64_t)i * 1000;
+    float v = sampleAt(i);
+    const float values[4] = {v, v * 0.1f, v * v * 0.1f, 25.0f + v * 0.01f};
+    for (uint8_t m = 0; m < 4; m++) {
+      testStats[m].add(values[m]);
+      windowStats[m].add(tUs, values[m]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() / BENCH_SAMPLES;
+
+  char line[120];
+  snprintf(line, sizeof(line), "4 metrics, whole test + 60 s window: %.1f ns host CPU per sample", ns);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES, testStats[3].count());
+  TEST_ASSERT_EQUAL_UINT32(60000, windowStats[3].summary((uint64_t)(BENCH_SAMPLES - 1) * 1000).count());
+  // Negligible next to the ~180 us of I2C that produced the sample, even
+  // allowing for soft-float doubles on target
+  TEST_ASSERT_TRUE(ns < 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_stats_are_nan);
+  RUN_TEST(test_whole_test_matches_two_pass);
+  RUN_TEST(test_merge_matches_single_pass);
+  RUN_TEST(test_window_covers_the_last_minute);
+  RUN_TEST(test_window_ages_out_across_gaps);
+  RUN_TEST(test_benchmark_cost_per_sample);
+  return UNITY_END();
+}
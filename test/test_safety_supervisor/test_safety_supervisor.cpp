@@ -0,0 +1,196 @@
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "control/safety_supervisor.h"
+
+// The firmware's budget from the tripping reading to the DAC at zero
+static constexpr uint32_t BUDGET_US = 2000;
+static constexpr float CUTOFF_V = 10.0f;
+static constexpr float OVERTEMP_C = 80.0f;
+
+static SafetySupervisor *safety;
+
+void setUp(void)
+{
+  safety = new SafetySupervisor(BUDGET_US);
+  safety->arm(CUTOFF_V, OVERTEMP_C);
+}
+
+void tearDown(void)
+{
+  delete safety;
+}
+
+// Small deterministic generator for the timing sweep
+static uint32_t rngState = 12345;
+static uint32_t nextRandom(void)
+{
+  rngState = rngState * 1664525u + 1013904223u;
+  return rngState >> 8;
+}
+static uint32_t randomBetween(uint32_t lo, uint32_t hi) { return lo + nextRandom() % (hi - lo + 1); }
+
+static void test_cutoff_trips_at_and_below_the_limit(void)
+{
+  TEST_ASSERT_FALSE(safety->checkVoltage(10.001f, 100));
+  TEST_ASSERT_FALSE(safety->checkVoltage(NAN, 200));
+  TEST_ASSERT_TRUE(safety->checkVoltage(CUTOFF_V, 300));
+  TEST_ASSERT_TRUE(safety->latched());
+  TEST_ASSERT_TRUE(safety->shutdownPending());
+  const safety_trip_t &trip = safety->trip();
+  TEST_ASSERT_TRUE(trip.trip == SafetyTrip::Undervoltage);
+  TEST_ASSERT_EQUAL_FLOAT(CUTOFF_V, trip.value);
+  TEST_ASSERT_EQUAL_FLOAT(CUTOFF_V, trip.threshold);
+  TEST_ASSERT_EQUAL_UINT64(300, trip.trip_us);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, safety->latencyUs());
+}
+
+static void test_overtemp_trips_at_and_above_the_limit(void)
+{
+  TEST_ASSERT_FALSE(safety->checkTemperature(79.9f, 100));
+  TEST_ASSERT_FALSE(safety->checkTemperature(NAN, 200));
+  TEST_ASSERT_TRUE(safety->checkTemperature(OVERTEMP_C, 300));
+  TEST_ASSERT_TRUE(safety->trip().trip == SafetyTrip::Overtemperature);
+  TEST_ASSERT_EQUAL_FLOAT(OVERTEMP_C, safety->trip().value);
+  // The first trip is the one recorded
+  TEST_ASSERT_FALSE(safety->checkVoltage(1.0f, 400));
+  TEST_ASSERT_TRUE(safety->trip().trip == SafetyTrip::Overtemperature);
+}
+
+// There is no release threshold: the trip latches, so a reading that
+// dithers around the limit trips once and recovery does not clear it. Only
+// arming again, at the next test start, does.
+static void test_latch_holds_through_noise_and_recovery(void)
+{
+  uint32_t trips = 0;
+  uint64_t firstTripUs = 0;
+  for (uint32_t i = 0; i < 1000; i++) {
+    // 10.05 V falling 0.1 mV a reading, with +-30 mV of noise
+    float noise = 0.03f * ((float)(nextRandom() % 2001) / 1000.0f - 1.0f);
+    float volts = 10.05f - 0.0001f * (float)i + noise;
+    uint64_t tUs = (uint64_t)i * 1000;
+    if (safety->checkVoltage(volts, tUs)) {
+      trips++;
+      firstTripUs = tUs;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, trips);
+  TEST_ASSERT_EQUAL_UINT64(firstTripUs, safety->trip().trip_us);
+  TEST_ASSERT_TRUE(safety->trip().value <= CUTOFF_V);
+
+  TEST_ASSERT_FALSE(safety->checkVoltage(12.0f, 2000000));
+  TEST_ASSERT_TRUE(safety->latched());
+
+  // Limit changes follow config without clearing the latch
+  safety->setLimits(5.0f, OVERTEMP_C);
+  TEST_ASSERT_TRUE(safety->latched());
+  TEST_ASSERT_EQUAL_FLOAT(CUTOFF_V, safety->trip().threshold);
+
+  safety->arm(5.0f, OVERTEMP_C);
+  TEST_ASSERT_FALSE(safety->latched());
+  TEST_ASSERT_FALSE(safety->checkVoltage(9.0f, 3000000));
+  TEST_ASSERT_TRUE(safety->checkVoltage(4.9f, 3001000));
+}
+
+static void test_disarmed_supervisor_never_trips(void)
+{
+  safety->disarm();
+  TEST_ASSERT_FALSE(safety->checkVoltage(0.0f, 100));
+  TEST_ASSERT_FALSE(safety->checkTemperature(200.0f, 100));
+  TEST_ASSERT_FALSE(safety->latched());
+  safety->shutdownComplete(200);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, safety->latencyUs());
+}
+
+// A failed zero write leaves the shutdown pending; the retry on a later
+// pass completes it and the latency shows it ran over budget.
+static void test_shutdown_latency_and_retry(void)
+{
+  TEST_ASSERT_TRUE(safety->checkVoltage(9.0f, 1000000));
+  safety->shutdownComplete(1000450);
+  TEST_ASSERT_FALSE(safety->shutdownPending());
+  TEST_ASSERT_EQUAL_UINT32(450, safety->latencyUs());
+  TEST_ASSERT_TRUE(safety->withinBudget());
+  // Recorded once
+  safety->shutdownComplete(1009000);
+  TEST_ASSERT_EQUAL_UINT32(450, safety->latencyUs());
+
+  safety->arm(CUTOFF_V, OVERTEMP_C);
+  TEST_ASSERT_TRUE(safety->checkTemperature(95.0f, 2000000));
+  TEST_ASSERT_TRUE(safety->shutdownPending());
+  TEST_ASSERT_FALSE(safety->withinBudget());
+  safety->shutdownComplete(2005000);  // after one more acquisition pass
+  TEST_ASSERT_EQUAL_UINT32(5000, safety->latencyUs());
+  TEST_ASSERT_FALSE(safety->withinBudget());
+
+  // Completion stamped no later than the trip still reads as done
+  safety->arm(CUTOFF_V, OVERTEMP_C);
+  TEST_ASSERT_TRUE(safety->checkVoltage(9.0f, 3000000));
+  safety->shutdownComplete(2999999);
+  TEST_ASSERT_FALSE(safety->shutdownPending());
+  TEST_ASSERT_EQUAL_UINT32(1, safety->latencyUs());
+}
+
+// The acquisition task's path on random crossings: a pack falling through
+// the cutoff at a random moment, sampled every 1-200 ms with up to 2 ms of
+// wake jitter. Each read is stamped when it starts and takes 100-300 us;
+// the tripping read is followed at once by the zero write, 100-600 us with
+// bus arbitration. Every trip must land on the first reading at or below
+// the cutoff, within the 2 ms budget, and reach zero no later than one
+// sample period plus jitter, read and write after the crossing.
+static void test_crossing_to_zero_timing(void)
+{
+  const uint32_t periodsUs[] = {1000, 5000, 20000, 50000, 100000, 200000};
+  uint32_t worstLatencyUs = 0;
+  uint64_t worstCrossingUs = 0;
+  uint32_t trials = 0;
+  for (uint32_t periodUs : periodsUs) {
+    for (uint32_t n = 0; n < 5000; n++) {
+      safety->arm(CUTOFF_V, OVERTEMP_C);
+      // 10.5 V falling at 1 V/s, crossing 0.5 s in plus a random phase
+      const uint64_t crossingUs = 500000 + randomBetween(0, periodUs);
+      uint64_t sampleUs = 0;
+      bool tripped = false;
+      while (!tripped) {
+        uint64_t startUs = sampleUs + randomBetween(0, 2000);
+        uint64_t readDoneUs = startUs + randomBetween(100, 300);
+        float volts = 10.5f - (float)((double)readDoneUs / 1e6);
+        bool below = readDoneUs >= crossingUs;
+        tripped = safety->checkVoltage(below ? fminf(volts, CUTOFF_V) : fmaxf(volts, 10.0001f), startUs);
+        TEST_ASSERT_EQUAL(below, tripped);
+        if (tripped) {
+          uint64_t zeroUs = readDoneUs + randomBetween(100, 600);
+          safety->shutdownComplete(zeroUs);
+          TEST_ASSERT_TRUE(safety->withinBudget());
+          uint64_t crossingToZeroUs = zeroUs - crossingUs;
+          TEST_ASSERT_TRUE(crossingToZeroUs <= (uint64_t)periodUs + 2000 + 300 + 600);
+          worstLatencyUs = safety->latencyUs() > worstLatencyUs ? safety->latencyUs() : worstLatencyUs;
+          worstCrossingUs = crossingToZeroUs > worstCrossingUs ? crossingToZeroUs : worstCrossingUs;
+        }
+        sampleUs += periodUs;
+      }
+      trials++;
+    }
+  }
+  char line[120];
+  snprintf(line, sizeof(line), "%u crossings: reading to zero at most %u us, crossing to zero at most %.1f ms",
+           (unsigned)trials, (unsigned)worstLatencyUs, worstCrossingUs / 1000.0);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(worstLatencyUs <= BUDGET_US);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_cutoff_trips_at_and_below_the_limit);
+  RUN_TEST(test_overtemp_trips_at_and_above_the_limit);
+  RUN_TEST(test_latch_holds_through_noise_and_recovery);
+  RUN_TEST(test_disarmed_supervisor_never_trips);
+  RUN_TEST(test_shutdown_latency_and_retry);
+  RUN_TEST(test_crossing_to_zero_timing);
+  return UNITY_END();
+}
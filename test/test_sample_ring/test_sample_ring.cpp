@@ -0,0 +1,152 @@
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "acquisition/acq_sample.h"
+#include "acquisition/sample_ring.h"
+
+// Small enough that the threaded run laps the ring many thousands of times.
+static constexpr size_t RING_CAPACITY = 16;
+static constexpr uint32_t THREADED_SAMPLES = 2000000;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Every field is derived from the sequence, so a slot read while it was
+// still being written shows up as a mismatch.
+static acq_sample_t sampleFor(uint32_t sequence)
+{
+  acq_sample_t sample = {};
+  sample.sequence = sequence;
+  sample.timestamp_us = (uint64_t)sequence * 1000ULL + 7;
+  sample.voltage_v = (float)(sequence & 0xFFFF);
+  sample.current_a = -(float)(sequence & 0xFFFF);
+  sample.flags = (uint8_t)(sequence * 31u);
+  sample.channel = (uint8_t)(sequence % 3);
+  sample.profile_step = (uint8_t)(sequence >> 3);
+  return sample;
+}
+
+static bool matches(const acq_sample_t &sample, uint32_t sequence)
+{
+  acq_sample_t expected = sampleFor(sequence);
+  return sample.sequence == expected.sequence && sample.timestamp_us == expected.timestamp_us &&
+         sample.voltage_v == expected.voltage_v && sample.current_a == expected.current_a &&
+         sample.flags == expected.flags && sample.channel == expected.channel &&
+         sample.profile_step == expected.profile_step;
+}
+
+static void test_empty_ring_pops_nothing(void)
+{
+  SampleRing<acq_sample_t, RING_CAPACITY> ring;
+  acq_sample_t sample;
+  TEST_ASSERT_TRUE(ring.empty());
+  TEST_ASSERT_FALSE(ring.pop(&sample));
+  TEST_ASSERT_TRUE(ring.push(sampleFor(1)));
+  TEST_ASSERT_FALSE(ring.pop(nullptr));
+  TEST_ASSERT_EQUAL_UINT32(1, ring.size());
+}
+
+static void test_full_ring_drops_newest_and_keeps_oldest(void)
+{
+  SampleRing<acq_sample_t, RING_CAPACITY> ring;
+  for (uint32_t i = 0; i < RING_CAPACITY; i++) {
+    TEST_ASSERT_TRUE(ring.push(sampleFor(i)));
+  }
+  TEST_ASSERT_FALSE(ring.push(sampleFor(RING_CAPACITY)));
+  TEST_ASSERT_FALSE(ring.push(sampleFor(RING_CAPACITY + 1)));
+  TEST_ASSERT_EQUAL_UINT32(2, ring.dropped());
+  TEST_ASSERT_EQUAL_UINT32(RING_CAPACITY, ring.size());
+
+  acq_sample_t sample;
+  for (uint32_t i = 0; i < RING_CAPACITY; i++) {
+    TEST_ASSERT_TRUE(ring.pop(&sample));
+    TEST_ASSERT_TRUE(matches(sample, i));
+  }
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+// Uneven push and pop batches walk the head and tail through every slot
+// offset across many laps.
+static void test_wraparound_keeps_order(void)
+{
+  SampleRing<acq_sample_t, RING_CAPACITY> ring;
+  uint32_t pushed = 0;
+  uint32_t popped = 0;
+  acq_sample_t sample;
+  for (uint32_t round = 0; round < 1000; round++) {
+    uint32_t pushes = 1 + (round * 7) % RING_CAPACITY;
+    for (uint32_t i = 0; i < pushes && ring.size() < RING_CAPACITY; i++) {
+      TEST_ASSERT_TRUE(ring.push(sampleFor(pushed++)));
+    }
+    uint32_t pops = 1 + (round * 5) % RING_CAPACITY;
+    for (uint32_t i = 0; i < pops && ring.pop(&sample); i++) {
+      TEST_ASSERT_TRUE(matches(sample, popped++));
+    }
+  }
+  while (ring.pop(&sample)) {
+    TEST_ASSERT_TRUE(matches(sample, popped++));
+  }
+  TEST_ASSERT_EQUAL_UINT32(pushed, popped);
+  TEST_ASSERT_GREATER_THAN_UINT32(RING_CAPACITY * 100, pushed);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+}
+
+// The producer retries a refused push, as a caller that must not lose data
+// would; the consumer checks that every sample arrives once, in order and
+// intact.
+static void test_threaded_producer_consumer_loses_and_reorders_nothing(void)
+{
+  static SampleRing<acq_sample_t, RING_CAPACITY> ring;
+  std::atomic<uint32_t> refused{0};
+  std::atomic<uint32_t> received{0};
+  std::atomic<uint32_t> mismatches{0};
+
+  std::thread consumer([&]() {
+    acq_sample_t sample;
+    uint32_t expected = 0;
+    while (expected < THREADED_SAMPLES) {
+      if (!ring.pop(&sample)) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (!matches(sample, expected)) {
+        mismatches.fetch_add(1);
+      }
+      expected++;
+    }
+    received = expected;
+  });
+
+  std::thread producer([&]() {
+    for (uint32_t sequence = 0; sequence < THREADED_SAMPLES; sequence++) {
+      acq_sample_t sample = sampleFor(sequence);
+      while (!ring.push(sample)) {
+        refused.fetch_add(1);
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  acq_sample_t extra;
+  TEST_ASSERT_EQUAL_UINT32(THREADED_SAMPLES, received.load());
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches.load());
+  TEST_ASSERT_FALSE(ring.pop(&extra));
+  TEST_ASSERT_EQUAL_UINT32(refused.load(), ring.dropped());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_ring_pops_nothing);
+  RUN_TEST(test_full_ring_drops_newest_and_keeps_oldest);
+  RUN_TEST(test_wraparound_keeps_order);
+  RUN_TEST(test_threaded_producer_consumer_loses_and_reorders_nothing);
+  return UNITY_END();
+}
@@ -0,0 +1,164 @@
+#include <unity.h>
+
+#include "acquisition/trigger_capture.h"
+
+static constexpr uint32_t CAPACITY = 256;
+static constexpr uint32_t PERIOD_US = 150;
+
+static uint32_t offsetsUs[CAPACITY];
+static float voltageV[CAPACITY];
+static float currentA[CAPACITY];
+static TriggerCapture capture;
+
+void setUp(void)
+{
+  capture.attach(offsetsUs, voltageV, currentA, CAPACITY);
+}
+
+void tearDown(void) {}
+
+static trigger_config_t config(TriggerSource source, TriggerMode mode, float level, uint32_t pre, uint32_t post)
+{
+  trigger_config_t cfg = {source, mode, level, pre, post};
+  return cfg;
+}
+
+// Feeds sample n with current from the callback, and the index itself as
+// the voltage so every frame slot names the sample it holds. Returns the
+// number of samples fed when the frame completed, or 0 if it never did.
+template <typename CurrentFn>
+static uint32_t feed(uint32_t limit, CurrentFn currentAt)
+{
+  for (uint32_t n = 0; n < limit; n++) {
+    if (!capture.add(1000000ULL + (uint64_t)n * PERIOD_US, (float)n, currentAt(n))) {
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+static void test_arm_rejects_frames_that_do_not_fit(void)
+{
+  TEST_ASSERT_FALSE(capture.arm(config(TriggerSource::Current, TriggerMode::Above, 1.0f, 200, 57)));
+  TEST_ASSERT_FALSE(capture.arm(config(TriggerSource::Current, TriggerMode::Above, 1.0f, 10, 0)));
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::Above, 1.0f, 200, 56)));
+}
+
+// A rising edge after a long quiet stretch: the frame holds exactly the pre
+// samples before the edge, the edge at triggerIndex(), and the post samples
+// from it on, oldest first with offsets from the frame start.
+static void test_rising_edge_frame_is_rotated_around_trigger(void)
+{
+  const uint32_t edge = 1000;
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::RisingEdge, 1.0f, 64, 128)));
+  uint32_t fed = feed(5000, [&](uint32_t n) { return n >= edge ? 2.0f : 0.005f; });
+
+  TEST_ASSERT_EQUAL_UINT32(edge + 128, fed);
+  TEST_ASSERT_TRUE(capture.state() == TriggerCapture::State::Complete);
+  TEST_ASSERT_TRUE(capture.triggered());
+  TEST_ASSERT_EQUAL_UINT32(192, capture.count());
+  TEST_ASSERT_EQUAL_UINT32(64, capture.triggerIndex());
+  for (uint32_t i = 0; i < capture.count(); i++) {
+    TEST_ASSERT_EQUAL_FLOAT((float)(edge - 64 + i), capture.voltageV()[i]);
+    TEST_ASSERT_EQUAL_UINT32(i * PERIOD_US, capture.offsetsUs()[i]);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, capture.currentA()[capture.triggerIndex()]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.005f, capture.currentA()[capture.triggerIndex() - 1]);
+  TEST_ASSERT_EQUAL_UINT32(192, capture.summary().sample_count);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, capture.summary().current_max_a);
+}
+
+// The trigger waits until the pre-trigger history is full, so a condition
+// already true when armed fires only once pre samples are held.
+static void test_level_trigger_waits_for_full_history(void)
+{
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::Above, 1.0f, 32, 16)));
+  uint32_t fed = feed(1000, [](uint32_t) { return 3.0f; });
+  TEST_ASSERT_EQUAL_UINT32(32 + 16, fed);
+  TEST_ASSERT_EQUAL_FLOAT(32.0f, capture.voltageV()[capture.triggerIndex()]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, capture.voltageV()[0]);
+}
+
+// An edge needs a sample below the level first: a load that is already on
+// when armed does not fire a rising edge.
+static void test_rising_edge_ignores_level_already_high(void)
+{
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::RisingEdge, 1.0f, 0, 8)));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(500, [](uint32_t) { return 2.0f; }));
+  TEST_ASSERT_TRUE(capture.armed());
+  TEST_ASSERT_FALSE(capture.triggered());
+}
+
+static void test_falling_edge_on_voltage_sag(void)
+{
+  // feed() puts the index in voltage, so this one swaps the roles
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Voltage, TriggerMode::FallingEdge, 3.5f, 4, 4)));
+  uint32_t fired = 0;
+  for (uint32_t n = 0; n < 100 && fired == 0; n++) {
+    float volts = (n < 40) ? 3.7f : 3.2f;
+    if (!capture.add((uint64_t)n * PERIOD_US, volts, (float)n)) {
+      fired = n + 1;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(40 + 4, fired);
+  TEST_ASSERT_EQUAL_FLOAT(40.0f, capture.currentA()[capture.triggerIndex()]);
+  TEST_ASSERT_EQUAL_FLOAT(3.7f, capture.voltageV()[capture.triggerIndex() - 1]);
+  TEST_ASSERT_EQUAL_FLOAT(3.2f, capture.voltageV()[capture.triggerIndex()]);
+}
+
+static void test_below_level_trigger(void)
+{
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::Below, 0.010f, 8, 8)));
+  uint32_t fed = feed(1000, [](uint32_t n) { return n >= 300 ? 0.001f : 0.5f; });
+  TEST_ASSERT_EQUAL_UINT32(300 + 8, fed);
+  TEST_ASSERT_EQUAL_FLOAT(300.0f, capture.voltageV()[capture.triggerIndex()]);
+}
+
+// Radio-style bursts: 0.6 ms at 250 mA every 20 ms, read every 150 us.
+// The first burst after arming (with history filled) is the one captured.
+static void test_short_burst_is_caught_with_pre_trigger_history(void)
+{
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::RisingEdge, 0.1f, 100, 150)));
+  auto burst = [](uint32_t n) {
+    uint64_t tUs = (uint64_t)n * PERIOD_US;
+    return (tUs % 20000) < 600 ? 0.25f : 0.002f;
+  };
+  uint32_t fed = feed(10000, burst);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, fed);
+
+  uint32_t triggerSample = (uint32_t)capture.voltageV()[capture.triggerIndex()];
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(100, triggerSample);
+  TEST_ASSERT_TRUE(burst(triggerSample) > 0.1f);
+  TEST_ASSERT_TRUE(burst(triggerSample - 1) < 0.1f);
+  // 100 reads of history is 15 ms, shorter than the 20 ms burst period, so
+  // everything before the trigger is idle current
+  for (uint32_t i = 0; i < capture.triggerIndex(); i++) {
+    TEST_ASSERT_TRUE(capture.currentA()[i] < 0.1f);
+  }
+}
+
+static void test_cancel_stops_armed_capture(void)
+{
+  TEST_ASSERT_TRUE(capture.arm(config(TriggerSource::Current, TriggerMode::Above, 5.0f, 8, 8)));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(100, [](uint32_t) { return 0.0f; }));
+  capture.cancel();
+  TEST_ASSERT_TRUE(capture.state() == TriggerCapture::State::Idle);
+  TEST_ASSERT_EQUAL_UINT32(0, capture.count());
+  TEST_ASSERT_FALSE(capture.add(0, 0.0f, 9.0f));
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_arm_rejects_frames_that_do_not_fit);
+  RUN_TEST(test_rising_edge_frame_is_rotated_around_trigger);
+  RUN_TEST(test_level_trigger_waits_for_full_history);
+  RUN_TEST(test_rising_edge_ignores_level_already_high);
+  RUN_TEST(test_falling_edge_on_voltage_sag);
+  RUN_TEST(test_below_level_trigger);
+  RUN_TEST(test_short_burst_is_caught_with_pre_trigger_history);
+  RUN_TEST(test_cancel_stops_armed_capture);
+  return UNITY_END();
+}
@@ -0,0 +1,253 @@
+#include <time.h>
+#include <unity.h>
+
+// The chart helpers are file-local, so the screens are compiled into this
+// suite directly; the native env leaves src/ui out of the shared build.
+#include "ui/ui.c"
+#include "ui/ui_events.c"
+
+#define CAPTURE_SAMPLES 16384u
+#define DISPLAY_WIDTH 720
+#define DISPLAY_HEIGHT 1280
+
+static lv_disp_draw_buf_t draw_buf;
+static lv_color_t draw_pixels[DISPLAY_WIDTH * 10];
+static lv_disp_drv_t disp_drv;
+static float capture_samples[CAPTURE_SAMPLES];
+static lv_coord_t capture_out[HISTORY_MAX];
+static lv_coord_t rebuilt_chart[METRIC_COUNT][HISTORY_MAX];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Nothing is drawn: the display exists so the screens can be built.
+static void discard_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *pixels)
+{
+    (void)area;
+    (void)pixels;
+    lv_disp_flush_ready(drv);
+}
+
+static void start_headless_ui(void)
+{
+    lv_init();
+    lv_disp_draw_buf_init(&draw_buf, draw_pixels, NULL, DISPLAY_WIDTH * 10);
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = DISPLAY_WIDTH;
+    disp_drv.ver_res = DISPLAY_HEIGHT;
+    disp_drv.flush_cb = discard_flush;
+    disp_drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&disp_drv);
+    ui_init();
+}
+
+static lv_coord_t coord_min(const lv_coord_t *coords, uint16_t count, uint16_t *index)
+{
+    lv_coord_t minv = coords[0];
+    *index = 0;
+    for (uint16_t i = 1; i < count; i++) {
+        if (coords[i] < minv) {
+            minv = coords[i];
+            *index = i;
+        }
+    }
+    return minv;
+}
+
+static lv_coord_t coord_max(const lv_coord_t *coords, uint16_t count, uint16_t *index)
+{
+    lv_coord_t maxv = coords[0];
+    *index = 0;
+    for (uint16_t i = 1; i < count; i++) {
+        if (coords[i] > maxv) {
+            maxv = coords[i];
+            *index = i;
+        }
+    }
+    return maxv;
+}
+
+static void test_short_capture_is_charted_point_for_point(void)
+{
+    for (uint32_t i = 0; i < 100; i++) {
+        capture_samples[i] = (float)i;
+    }
+    TEST_ASSERT_EQUAL_UINT16(100, decimate_capture(capture_samples, 100, 1.0f, capture_out));
+    TEST_ASSERT_EQUAL_INT(-900, capture_out[0]);
+    TEST_ASSERT_EQUAL_INT(900, capture_out[99]);
+    for (uint32_t i = 1; i < 100; i++) {
+        TEST_ASSERT_TRUE(capture_out[i] >= capture_out[i - 1]);
+    }
+}
+
+// A one-sample spike and a one-sample dip in a full-size capture both
+// survive decimation, at the chart position of their own bin.
+static void test_decimation_keeps_single_sample_peaks_in_time_order(void)
+{
+    const uint32_t spike = 12345;
+    const uint32_t dip = 2000;
+    const uint32_t bins = HISTORY_MAX / 2;
+    for (uint32_t i = 0; i < CAPTURE_SAMPLES; i++) {
+        capture_samples[i] = 0.100f + 0.001f * (float)(i % 7);
+    }
+    capture_samples[spike] = 2.0f;
+    capture_samples[dip] = 0.0f;
+
+    uint16_t points = decimate_capture(capture_samples, CAPTURE_SAMPLES, 1000.0f, capture_out);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_MAX, points);
+
+    uint16_t max_index;
+    uint16_t min_index;
+    TEST_ASSERT_EQUAL_INT(900, coord_max(capture_out, points, &max_index));
+    TEST_ASSERT_EQUAL_INT(-900, coord_min(capture_out, points, &min_index));
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(spike * bins / CAPTURE_SAMPLES), max_index / 2);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(dip * bins / CAPTURE_SAMPLES), min_index / 2);
+    TEST_ASSERT_TRUE(min_index < max_index);
+}
+
+static uint32_t bin_start(uint32_t bin)
+{
+    return (uint32_t)(((uint64_t)bin * CAPTURE_SAMPLES) / (HISTORY_MAX / 2));
+}
+
+// Within a bin the minimum and maximum keep the order they happened in.
+static void test_decimation_orders_each_bin_by_time(void)
+{
+    for (uint32_t i = 0; i < CAPTURE_SAMPLES; i++) {
+        capture_samples[i] = 1.0f;
+    }
+    // Bin 10 falls then rises; bin 20 rises then falls
+    capture_samples[bin_start(10) + 5] = -10.0f;
+    capture_samples[bin_start(10) + 15] = 10.0f;
+    capture_samples[bin_start(20) + 5] = 10.0f;
+    capture_samples[bin_start(20) + 15] = -10.0f;
+
+    (void)decimate_capture(capture_samples, CAPTURE_SAMPLES, 1.0f, capture_out);
+    TEST_ASSERT_EQUAL_INT(-900, capture_out[20]);
+    TEST_ASSERT_EQUAL_INT(900, capture_out[21]);
+    TEST_ASSERT_EQUAL_INT(900, capture_out[40]);
+    TEST_ASSERT_EQUAL_INT(-900, capture_out[41]);
+}
+
+// A discharge with a ripple on the current, a spike every 700 samples that
+// widens the current and power ranges, and a temperature probe that misses
+// one reading in seven.
+static ui_channel_data_t chart_sample(uint32_t i)
+{
+    float current_ma = 1500.0f + 200.0f * sinf((float)i * 0.05f);
+    if (i % 700 == 350) {
+        current_ma += 400.0f + (float)i;
+    }
+    float voltage_v = 13.2f - 0.0004f * (float)i;
+    ui_channel_data_t data = {
+        voltage_v,
+        current_ma,
+        voltage_v * current_ma / 1000.0f,
+        0.001f * (float)i,
+        0.0001f * (float)i,
+        (i % 7 == 3) ? NAN : 75.0f + 0.01f * (float)i
+    };
+    return data;
+}
+
+// The coordinates a full rebuild would give, worked out from the raw
+// history without touching the chart's own state.
+static void rebuild_expected(const channel_history_t *history)
+{
+    for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+        float center;
+        float half_span;
+        chart_span(history->min[metric], history->max[metric], &center, &half_span);
+        for (uint16_t i = 0; i < history->count; i++) {
+            rebuilt_chart[metric][i] = chart_coord(history->raw[metric][i], center, half_span);
+        }
+    }
+}
+
+static void assert_chart_matches_rebuild(const channel_history_t *history)
+{
+    rebuild_expected(history);
+    for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+        TEST_ASSERT_EQUAL_INT16_ARRAY(rebuilt_chart[metric], history_chart[metric], history->count);
+    }
+}
+
+// Every incremental append, through range growth, NAN temperatures and
+// compressions, leaves the chart as a full rebuild would have drawn it.
+static void test_incremental_append_matches_full_rebuild(void)
+{
+    const channel_history_t *history = &channel_history[0];
+    clear_history(0);
+    for (uint32_t i = 0; i < 5000; i++) {
+        ui_channel_data_t data = chart_sample(i);
+        ui_set_channel_data(0, &data);
+        assert_chart_matches_rebuild(history);
+    }
+    TEST_ASSERT_TRUE(history->stride > 1);
+
+    rebuild_expected(history);
+    refresh_chart();
+    for (uint8_t metric = 0; metric < METRIC_COUNT; metric++) {
+        TEST_ASSERT_EQUAL_INT16_ARRAY(rebuilt_chart[metric], history_chart[metric], history->count);
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Time the append that brings the history to 900 points, with the range
+// left as it was. Clearing chart_points first sends the append through
+// refresh_chart(), which is what every sample cost before the chart was
+// rescaled incrementally.
+static uint64_t time_900th_append(bool full_rebuild, uint32_t reps)
+{
+    uint64_t total_ns = 0;
+    for (uint32_t rep = 0; rep < reps; rep++) {
+        clear_history(0);
+        for (uint32_t i = 0; i < HISTORY_MAX - 1; i++) {
+            ui_channel_data_t data = chart_sample(i % 700);
+            ui_set_channel_data(0, &data);
+        }
+        ui_channel_data_t data = chart_sample(10);
+        if (full_rebuild) {
+            chart_points = 0;
+        }
+        uint64_t start_ns = now_ns();
+        ui_set_channel_data(0, &data);
+        total_ns += now_ns() - start_ns;
+        TEST_ASSERT_EQUAL_UINT16(HISTORY_MAX, channel_history[0].count);
+    }
+    return total_ns / reps;
+}
+
+static void test_append_benchmark_at_900_points(void)
+{
+    const uint32_t reps = 200;
+    uint64_t before_ns = time_900th_append(true, reps);
+    uint64_t after_ns = time_900th_append(false, reps);
+    assert_chart_matches_rebuild(&channel_history[0]);
+
+    char line[120];
+    snprintf(line, sizeof(line), "append at %u points: full refresh_chart() %.2f us, incremental %.2f us",
+             (unsigned)HISTORY_MAX, before_ns / 1000.0, after_ns / 1000.0);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(after_ns < before_ns);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    start_headless_ui();
+    UNITY_BEGIN();
+    RUN_TEST(test_short_capture_is_charted_point_for_point);
+    RUN_TEST(test_decimation_keeps_single_sample_peaks_in_time_order);
+    RUN_TEST(test_decimation_orders_each_bin_by_time);
+    RUN_TEST(test_incremental_append_matches_full_rebuild);
+    RUN_TEST(test_append_benchmark_at_900_points);
+    return UNITY_END();
+}